@@ -0,0 +1,40 @@
+// Measure requests/sec for requests that carry a realistic number of
+// headers. Header handling dominates for small requests like these.
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  headers: [0, 20],
+  c: [50]
+});
+
+var names = [
+  'Accept', 'Accept-Encoding', 'Accept-Language', 'Cache-Control',
+  'Connection', 'Cookie', 'DNT', 'Host', 'If-Modified-Since',
+  'If-None-Match', 'Origin', 'Pragma', 'Referer', 'User-Agent',
+  'X-Forwarded-For', 'X-Forwarded-Proto', 'X-Request-Id', 'X-Real-IP',
+  'X-Requested-With', 'X-Trace-Id'
+];
+
+function main(conf) {
+  var http = require('http');
+  var args = ['-d', '10s', '-t', 8, '-c', conf.c];
+
+  // wrk adds its own Host header.
+  for (var i = 0; i < conf.headers; i += 1) {
+    if (names[i] !== 'Host')
+      args.push('-H', names[i] + ': value-' + i);
+  }
+
+  var server = http.createServer(function(req, res) {
+    res.writeHead(200, { 'Content-Length': '2' });
+    res.end('ok');
+  });
+
+  server.listen(PORT, function() {
+    bench.http('/', args, function() {
+      server.close();
+    });
+  });
+}
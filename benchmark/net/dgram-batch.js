@@ -0,0 +1,64 @@
+// compare UDP send throughput of socket.send() and socket.sendBatch()
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+// `num` is the number of datagrams that is sent per round.
+var bench = common.createBenchmark(main, {
+  len: [1, 64, 512],
+  num: [100],
+  type: ['send', 'sendBatch'],
+  dur: [5]
+});
+
+var dur;
+var len;
+var num;
+var type;
+var chunk;
+var batch;
+
+function main(conf) {
+  dur = +conf.dur;
+  len = +conf.len;
+  num = +conf.num;
+  type = conf.type;
+  chunk = new Buffer(len);
+  batch = [];
+  for (var i = 0; i < num; i++)
+    batch.push({ buf: chunk, port: PORT, address: '127.0.0.1' });
+  server();
+}
+
+var dgram = require('dgram');
+
+function server() {
+  var sent = 0;
+  var socket = dgram.createSocket('udp4');
+
+  function onsend() {
+    if (sent++ % num == 0)
+      for (var i = 0; i < num; i++)
+        socket.send(chunk, 0, chunk.length, PORT, '127.0.0.1', onsend);
+  }
+
+  function onbatch(err) {
+    sent += num;
+    socket.sendBatch(batch, onbatch);
+  }
+
+  socket.on('listening', function() {
+    bench.start();
+    if (type === 'send')
+      onsend();
+    else
+      socket.sendBatch(batch, onbatch);
+
+    setTimeout(function() {
+      // Datagrams per second.
+      bench.end(sent);
+    }, dur * 1000);
+  });
+
+  socket.bind(PORT);
+}
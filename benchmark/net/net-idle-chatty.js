@@ -0,0 +1,100 @@
+// Lots of mostly idle connections that each send a short message now and
+// then. Depending on `type`, reports reads per second, resident memory per
+// connection in bytes or the number of read slabs malloc()'ed per 1,000,000
+// reads. `retained` is like `rss` but the server holds on to the last chunk
+// it received on every connection, the way a protocol parser waiting for the
+// rest of a message would.
+//
+// Each connection uses two file descriptors (client and server side), raise
+// the open file limit with `ulimit -n` before running with many connections.
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  conns: [50000],
+  type: ['reads', 'rss', 'retained', 'allocs'],
+  dur: [5]
+});
+
+var net = require('net');
+var stream_wrap = process.binding('stream_wrap');
+
+// Every client sends a message once per `period` milliseconds.
+var period = 1000;
+var ticks = 100;
+
+function main(conf) {
+  var conns = +conf.conns;
+  var type = conf.type;
+  var dur = +conf.dur;
+  var clients = [];
+  var reads = 0;
+  var rss = process.memoryUsage().rss;
+
+  var server = net.createServer(function(socket) {
+    socket.on('data', function(chunk) {
+      reads++;
+      if (type === 'retained')
+        socket.lastChunk = chunk;
+    });
+  });
+
+  server.listen(PORT, function() {
+    connect();
+  });
+
+  function connect() {
+    var connected = 0;
+    for (var i = 0; i < conns; i++) {
+      var client = net.connect(PORT, function() {
+        if (++connected === conns)
+          run();
+      });
+      client.on('error', function(err) {
+        console.error(err.message);
+        process.exit(1);
+      });
+      clients.push(client);
+    }
+  }
+
+  function run() {
+    var stats = stream_wrap.getReadSlabStats();
+    var index = 0;
+    var batch = Math.ceil(conns / ticks);
+
+    // Spread the writes out so that all connections are a little bit busy
+    // rather than a few of them very busy.
+    var timer = setInterval(function() {
+      for (var i = 0; i < batch; i++) {
+        clients[index].write('ping\n');
+        index = (index + 1) % conns;
+      }
+    }, period / ticks);
+
+    reads = 0;
+    bench.start();
+
+    setTimeout(function() {
+      clearInterval(timer);
+      switch (type) {
+        case 'reads':
+          bench.end(reads);
+          break;
+        case 'rss':
+        case 'retained':
+          bench.report((process.memoryUsage().rss - rss) / conns);
+          break;
+        case 'allocs':
+          var now = stream_wrap.getReadSlabStats();
+          var slabs = now.slabs - stats.slabs;
+          var buffers = now.buffers - stats.buffers;
+          bench.report(1e6 * slabs / buffers);
+          break;
+        default:
+          throw new Error('invalid type: ' + type);
+      }
+    }, dur * 1000);
+  }
+}
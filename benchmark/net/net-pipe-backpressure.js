@@ -0,0 +1,100 @@
+// Many sockets piped into slow consumers. Every consumer applies
+// backpressure after each chunk, so every socket goes through a
+// pause/resume cycle (uv_read_stop/uv_read_start) per chunk. Depending on
+// `type`, reports the throughput in Mbits per second or the number of
+// epoll_ctl calls per 1,000 chunks, which is what the pause/resume cycles
+// cost in system calls. The latter is always zero on platforms other than
+// Linux.
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  conns: [1, 100, 500],
+  len: [16384],
+  type: ['mbits', 'epoll_ctl'],
+  dur: [5]
+});
+
+var net = require('net');
+var Writable = require('stream').Writable;
+var util = require('util');
+var uv = process.binding('uv');
+
+var received = 0;
+var chunks = 0;
+
+// Accepts one chunk, then signals backpressure until the next tick.
+function SlowWriter() {
+  Writable.call(this, { highWaterMark: 1 });
+}
+util.inherits(SlowWriter, Writable);
+
+SlowWriter.prototype._write = function(chunk, encoding, cb) {
+  received += chunk.length;
+  chunks++;
+  setImmediate(cb);
+};
+
+function main(conf) {
+  var conns = +conf.conns;
+  var len = +conf.len;
+  var type = conf.type;
+  var dur = +conf.dur;
+  var chunk = new Buffer(len);
+  var clients = [];
+  var connected = 0;
+
+  chunk.fill('x');
+
+  var server = net.createServer(function(socket) {
+    socket.pipe(new SlowWriter());
+  });
+
+  server.listen(PORT, function() {
+    for (var i = 0; i < conns; i++) {
+      var client = net.connect(PORT, onconnect);
+      client.on('error', function() {});
+      clients.push(client);
+    }
+  });
+
+  function onconnect() {
+    var client = this;
+
+    (function write() {
+      while (client.write(chunk));
+      client.once('drain', write);
+    })();
+
+    if (++connected === conns) {
+      var updates = watcherUpdates();
+      received = 0;
+      chunks = 0;
+      bench.start();
+      setTimeout(function() {
+        done(watcherUpdates() - updates);
+      }, dur * 1000);
+    }
+  }
+
+  function done(updates) {
+    switch (type) {
+      case 'mbits':
+        bench.end((received * 8) / (1024 * 1024));
+        break;
+      case 'epoll_ctl':
+        bench.report(1000 * updates / chunks);
+        break;
+      default:
+        throw new Error('invalid type: ' + type);
+    }
+  }
+}
+
+// The last element of the loop metrics, see src/uv.cc.
+function watcherUpdates() {
+  var metrics = [];
+  uv.getLoopMetrics(metrics);
+  return metrics[metrics.length - 1];
+}
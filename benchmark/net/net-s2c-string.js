@@ -0,0 +1,98 @@
+// test the speed of writing large strings to a socket
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+// 'heap' strings live on the V8 heap and have to be copied before they can be
+// written, 'external' strings come from Buffer#toString() and don't.
+var bench = common.createBenchmark(main, {
+  len: [1024 * 1024],
+  type: ['asc', 'bin', 'ucs', 'utf'],
+  src: ['heap', 'external'],
+  writev: [0, 1],
+  dur: [5]
+});
+
+var dur;
+var chunk;
+var encoding;
+var writev;
+
+function main(conf) {
+  dur = +conf.dur;
+  writev = +conf.writev;
+
+  var len = +conf.len;
+  var buf = new Buffer(len);
+  buf.fill('x');
+
+  switch (conf.type) {
+    case 'asc':
+      encoding = 'ascii';
+      break;
+    case 'bin':
+      encoding = 'binary';
+      break;
+    case 'ucs':
+      encoding = 'ucs2';
+      break;
+    case 'utf':
+      encoding = 'utf8';
+      break;
+    default:
+      throw new Error('invalid type: ' + conf.type);
+  }
+
+  // Buffer#toString() returns an external string when the result is large,
+  // appending to it forces a copy on the V8 heap.
+  chunk = buf.toString(encoding);
+  if (conf.src === 'heap')
+    chunk = (chunk + '.').slice(0, -1);
+  else if (conf.src !== 'external')
+    throw new Error('invalid src: ' + conf.src);
+
+  server();
+}
+
+var net = require('net');
+
+function server() {
+  var received = 0;
+
+  var server = net.createServer(function(socket) {
+    function flow() {
+      var res;
+      if (writev) {
+        socket.cork();
+        socket.write(chunk, encoding);
+        res = socket.write(chunk, encoding);
+        socket.uncork();
+      } else {
+        res = socket.write(chunk, encoding);
+      }
+      if (res)
+        setImmediate(flow);
+      else
+        socket.once('drain', flow);
+    }
+    socket.on('error', function() {});
+    flow();
+  });
+
+  server.listen(PORT, function() {
+    var socket = net.connect(PORT);
+    socket.on('connect', function() {
+      bench.start();
+
+      socket.on('data', function(data) {
+        received += data.length;
+      });
+
+      setTimeout(function() {
+        var gbits = (received * 8) / (1024 * 1024 * 1024);
+        bench.end(gbits);
+        process.exit(0);
+      }, dur * 1000);
+    });
+  });
+}
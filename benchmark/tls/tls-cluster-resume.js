@@ -0,0 +1,80 @@
+// Clients connect to a cluster of TLS servers and reconnect with the session
+// they got. Reports the percentage of reconnections that resumed the session.
+// Tickets are disabled, the session has to come from a session cache.
+
+var fs = require('fs');
+var path = require('path');
+var cluster = require('cluster');
+var constants = require('constants');
+var tls = require('tls');
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+cluster.schedulingPolicy = cluster.SCHED_RR;
+
+if (cluster.isMaster) {
+  var bench = common.createBenchmark(main, {
+    workers: [1, 4],
+    cache: [0, 1],
+    n: [200]
+  });
+} else {
+  server();
+}
+
+function main(conf) {
+  var workers = +conf.workers;
+  var n = +conf.n;
+  var listening = 0;
+
+  cluster.setupMaster({ tlsSessionCacheSize: +conf.cache ? 4096 : 0 });
+  for (var i = 0; i < workers; i++)
+    cluster.fork().on('listening', function() {
+      if (++listening === workers)
+        next();
+    });
+
+  var resumed = 0;
+  var done = 0;
+
+  function next() {
+    if (done === n) {
+      bench.report(resumed * 100 / n);
+      return;
+    }
+    connect(null, function(session) {
+      connect(session, function(session, reused) {
+        if (reused)
+          resumed++;
+        done++;
+        next();
+      });
+    });
+  }
+}
+
+function connect(session, cb) {
+  var socket = tls.connect({ port: PORT,
+                             session: session,
+                             rejectUnauthorized: false },
+                           function() {
+    var reused = socket.isSessionReused();
+    var session = socket.getSession();
+    socket.end();
+    socket.on('close', function() {
+      cb(session, reused);
+    });
+  });
+}
+
+function server() {
+  var cert_dir = path.resolve(__dirname, '../../test/fixtures');
+  var options = { key: fs.readFileSync(cert_dir + '/test_key.pem'),
+                  cert: fs.readFileSync(cert_dir + '/test_cert.pem'),
+                  secureOptions: constants.SSL_OP_NO_TICKET };
+
+  tls.createServer(options, function(socket) {
+    socket.end();
+  }).listen(PORT);
+}
@@ -0,0 +1,89 @@
+// Latency of established TLS connections while the server is busy with new
+// handshakes. A cluster worker keeps `c` handshakes in flight, the server
+// measures the round trip time of small pings on a few idle connections and
+// reports the 99th percentile in microseconds.
+
+var fs = require('fs');
+var path = require('path');
+var cluster = require('cluster');
+var tls = require('tls');
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+var cert_dir = path.resolve(__dirname, '../../test/fixtures');
+
+if (cluster.isMaster) {
+  var bench = common.createBenchmark(main, {
+    offload: [0, 1],
+    c: [50],
+    dur: [5]
+  });
+} else {
+  handshakes(+process.env.CONCURRENCY);
+}
+
+function main(conf) {
+  // RSA key exchange with a 2048 bit key, the private key operation is the
+  // bulk of the server's handshake.
+  var options = { key: fs.readFileSync(cert_dir + '/agent.key'),
+                  cert: fs.readFileSync(cert_dir + '/agent.crt'),
+                  ciphers: 'AES128-GCM-SHA256',
+                  offloadHandshake: !!+conf.offload };
+
+  var server = tls.createServer(options, function(socket) {
+    socket.on('error', function() {});
+    socket.pipe(socket);
+  });
+
+  var samples = [];
+  var running = true;
+  var worker;
+
+  server.listen(PORT, function() {
+    for (var i = 0; i < 10; i++)
+      ping();
+    worker = cluster.fork({ CONCURRENCY: conf.c });
+    setTimeout(done, +conf.dur * 1000);
+  });
+
+  function ping() {
+    var socket = tls.connect({ port: PORT, rejectUnauthorized: false },
+                             function() {
+      var start;
+      socket.on('data', function() {
+        var elapsed = process.hrtime(start);
+        samples.push(elapsed[0] * 1e6 + elapsed[1] / 1e3);
+        if (running)
+          setTimeout(send, 10);
+      });
+      send();
+
+      function send() {
+        start = process.hrtime();
+        socket.write('ping');
+      }
+    });
+  }
+
+  function done() {
+    running = false;
+    worker.kill();
+    samples.sort(function(a, b) { return a - b; });
+    bench.report(samples[Math.floor(samples.length * 0.99)]);
+  }
+}
+
+function handshakes(concurrency) {
+  for (var i = 0; i < concurrency; i++)
+    connect();
+
+  function connect() {
+    var socket = tls.connect({ port: PORT, rejectUnauthorized: false },
+                             function() {
+      socket.destroy();
+      connect();
+    });
+    socket.on('error', function() {});
+  }
+}
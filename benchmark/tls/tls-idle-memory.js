@@ -0,0 +1,78 @@
+// Many TLS connections that exchange a message and then go idle. Reports the
+// growth in resident memory per connection in bytes, client and server side
+// together.
+//
+// Each connection uses two file descriptors (client and server side), raise
+// the open file limit with `ulimit -n` before running with many connections.
+
+var fs = require('fs');
+var path = require('path');
+var tls = require('tls');
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  conns: [2000],
+  size: [16, 16384]
+});
+
+function main(conf) {
+  var conns = +conf.conns;
+  var message = new Buffer(+conf.size);
+  message.fill('x');
+
+  var cert_dir = path.resolve(__dirname, '../../test/fixtures');
+  var options = { key: fs.readFileSync(cert_dir + '/test_key.pem'),
+                  cert: fs.readFileSync(cert_dir + '/test_cert.pem'),
+                  ciphers: 'AES128-GCM-SHA256' };
+
+  var clients = [];
+  var received = 0;
+  var connected = 0;
+  var rss;
+
+  var server = tls.createServer(options, function(socket) {
+    var bytes = 0;
+    socket.on('data', function(data) {
+      bytes += data.length;
+      if (bytes === message.length)
+        socket.write(message);
+    });
+  });
+
+  server.listen(PORT, function() {
+    rss = process.memoryUsage().rss;
+    connect();
+  });
+
+  // Connect in batches, a few thousand handshakes at once is mostly a test
+  // of the listen backlog.
+  function connect() {
+    for (var i = 0; i < 100 && clients.length < conns; i++) {
+      var client = tls.connect({ port: PORT, rejectUnauthorized: false },
+                               onconnect);
+      client.on('error', function(err) {
+        console.error(err.message);
+        process.exit(1);
+      });
+      clients.push(client);
+    }
+  }
+
+  function onconnect() {
+    var bytes = 0;
+    this.on('data', function(data) {
+      bytes += data.length;
+      if (bytes === message.length && ++received === conns)
+        setTimeout(done, 1000);  // Let everything settle.
+    });
+    this.write(message);
+    if (++connected === clients.length)
+      connect();
+  }
+
+  function done() {
+    bench.report((process.memoryUsage().rss - rss) / conns);
+  }
+}
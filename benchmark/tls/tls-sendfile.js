@@ -0,0 +1,81 @@
+// Server to client throughput of a TLS connection that sends a file, with
+// socket.sendFile() or by writing buffers, in userspace or with kernelTLS.
+// kernelTLS falls back to userspace when the kernel can't take over, the
+// benchmark prints which one it got.
+
+var fs = require('fs');
+var os = require('os');
+var path = require('path');
+var tls = require('tls');
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  kernel: [0, 1],
+  src: ['write', 'sendfile'],
+  dur: [5]
+});
+
+var kFileSize = 16 * 1024 * 1024;
+
+function main(conf) {
+  var dur = +conf.dur;
+  var kernel = !!+conf.kernel;
+  var sendfile = conf.src === 'sendfile';
+
+  var data = new Buffer(kFileSize);
+  data.fill('x');
+  var filename = path.join(os.tmpdir(), 'tls-sendfile-' + process.pid);
+  fs.writeFileSync(filename, data);
+  var fd = fs.openSync(filename, 'r');
+  fs.unlinkSync(filename);
+
+  var cert_dir = path.resolve(__dirname, '../../test/fixtures');
+  var options = { key: fs.readFileSync(cert_dir + '/test_key.pem'),
+                  cert: fs.readFileSync(cert_dir + '/test_cert.pem'),
+                  ciphers: 'AES128-GCM-SHA256',
+                  kernelTLS: kernel };
+
+  var server = tls.createServer(options, function(socket) {
+    function flow() {
+      // sendFile() queues an empty chunk, its return value says nothing
+      // about the backlog. Send the next copy once this one is out.
+      if (sendfile)
+        socket.sendFile(fd, 0, kFileSize, flow);
+      else if (socket.write(data))
+        setImmediate(flow);
+      else
+        socket.once('drain', flow);
+    }
+    socket.on('error', function() {});
+    // The request is the first thing after the handshake, by now the
+    // kernel had its chance to take over.
+    socket.once('data', function() {
+      console.error('kernelTLS: %s', socket.isKernelTLS());
+      flow();
+    });
+  });
+
+  server.listen(PORT, function() {
+    var received = 0;
+    var opt = { port: PORT, rejectUnauthorized: false, kernelTLS: kernel };
+    var conn = tls.connect(opt, function() {
+      // Give the kernel a quiet moment to take over before the flood.
+      setTimeout(function() {
+        conn.write('go');
+        bench.start();
+      }, 100);
+    });
+
+    conn.on('data', function(chunk) {
+      received += chunk.length;
+    });
+
+    setTimeout(function() {
+      var mbits = (received * 8) / (1024 * 1024);
+      bench.end(mbits);
+      process.exit(0);
+    }, 100 + dur * 1000);
+  });
+}
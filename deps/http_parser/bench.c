@@ -0,0 +1,108 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Measures how fast the parser goes through requests with a long URL and
+ * large headers, the case the fast scanners in http_parser.c are for.
+ *
+ *   make bench && ./bench [iterations]
+ */
+
+#include "http_parser.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+static int on_message_complete(http_parser *parser) {
+  (*(unsigned long *) parser->data)++;
+  return 0;
+}
+
+static http_parser_settings settings = {
+  .on_message_complete = on_message_complete
+};
+
+static size_t append(char *buf, size_t off, const char *s, size_t n) {
+  memcpy(buf + off, s, n);
+  return off + n;
+}
+
+static size_t fill(char *buf, size_t off, char c, size_t n) {
+  memset(buf + off, c, n);
+  return off + n;
+}
+
+int main(int argc, char **argv) {
+  static char buf[16 * 1024];
+  unsigned long iterations = 200000;
+  unsigned long messages = 0;
+  unsigned long i;
+  struct timeval start, end;
+  http_parser parser;
+  size_t len = 0;
+  double elapsed;
+
+  if (argc > 1)
+    iterations = strtoul(argv[1], NULL, 10);
+
+#define S(s) s, sizeof(s) - 1
+  len = append(buf, len, S("GET /api/v1/"));
+  len = fill(buf, len, 'p', 300);
+  len = append(buf, len, S("?q="));
+  len = fill(buf, len, 'q', 200);
+  len = append(buf, len, S(" HTTP/1.1\r\n"
+                           "Host: www.example.com\r\n"
+                           "User-Agent: Mozilla/5.0 (X11; Linux x86_64) "
+                           "AppleWebKit/537.36 (KHTML, like Gecko) "
+                           "Chrome/41.0.2272.76 Safari/537.36\r\n"
+                           "Accept: text/html,application/xhtml+xml,"
+                           "application/xml;q=0.9,image/webp,*/*;q=0.8\r\n"
+                           "Accept-Language: en-US,en;q=0.8\r\n"
+                           "Cookie: session="));
+  len = fill(buf, len, 'c', 4096);
+  len = append(buf, len, S("\r\nX-Forwarded-For: "));
+  len = fill(buf, len, '1', 1024);
+  len = append(buf, len, S("\r\n\r\n"));
+#undef S
+  assert(len < sizeof(buf));
+
+  http_parser_init(&parser, HTTP_REQUEST);
+  parser.data = &messages;
+
+  gettimeofday(&start, NULL);
+  for (i = 0; i < iterations; i++) {
+    size_t parsed = http_parser_execute(&parser, &settings, buf, len);
+    assert(parsed == len);
+  }
+  gettimeofday(&end, NULL);
+  assert(messages == iterations);
+
+  elapsed = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+  printf("%lu requests of %lu bytes in %.3f s: %.0f req/s, %.1f MB/s\n",
+         iterations,
+         (unsigned long) len,
+         elapsed,
+         iterations / elapsed,
+         iterations * len / elapsed / (1024 * 1024));
+
+  return 0;
+}
@@ -29,6 +29,18 @@
 #include <string.h>
 #include <limits.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) &&      \
+    defined(__SSE2__)
+# define HTTP_PARSER_SSE2 1
+# include <emmintrin.h>
+# if defined(__has_attribute)
+#  if __has_attribute(target)
+#   define HTTP_PARSER_AVX2 1
+#   include <immintrin.h>
+#  endif
+# endif
+#endif
+
 #ifndef ULLONG_MAX
 # define ULLONG_MAX ((uint64_t) -1) /* 2^64-1 */
 #endif
@@ -414,6 +426,193 @@ static struct {
 
 int http_message_needs_eof(const http_parser *parser);
 
+/* Fast scanners for the states that consume long runs of bytes without doing
+ * anything but checking them: header values, header names and the path,
+ * query string and fragment of the request URL. Each returns a pointer to
+ * the first byte in [p, end) that needs to go through the state machine, or
+ * end if there is none. They may stop early, e.g. on a tab in a URL, but
+ * never late. The SSE2 and AVX2 versions process 16 and 32 bytes at a time,
+ * AVX2 is used when the CPU supports it.
+ */
+static const char *find_crlf_scalar(const char *p, const char *end)
+{
+  while (p < end && *p != CR && *p != LF)
+    p++;
+  return p;
+}
+
+static const char *find_url_end_scalar(const char *p, const char *end)
+{
+  while (p < end && IS_URL_CHAR(*p))
+    p++;
+  return p;
+}
+
+#if HTTP_PARSER_SSE2
+static const char *find_crlf_sse2(const char *p, const char *end)
+{
+  const __m128i cr = _mm_set1_epi8(CR);
+  const __m128i lf = _mm_set1_epi8(LF);
+  __m128i v;
+  int mask;
+
+  while (end - p >= 16) {
+    v = _mm_loadu_si128((const __m128i *) p);
+    mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, cr),
+                                          _mm_cmpeq_epi8(v, lf)));
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+    p += 16;
+  }
+
+  return find_crlf_scalar(p, end);
+}
+
+/* Stops on control characters, space, '#', '?' and DEL. In strict mode
+ * also on bytes with the high bit set.
+ */
+static const char *find_url_end_sse2(const char *p, const char *end)
+{
+  const __m128i min = _mm_set1_epi8(0x21);
+  const __m128i hash = _mm_set1_epi8('#');
+  const __m128i question = _mm_set1_epi8('?');
+  const __m128i del = _mm_set1_epi8(0x7f);
+  __m128i v, ok, bad;
+  unsigned int mask;
+
+  while (end - p >= 16) {
+    v = _mm_loadu_si128((const __m128i *) p);
+    ok = _mm_cmpeq_epi8(_mm_max_epu8(v, min), v);
+    bad = _mm_or_si128(_mm_cmpeq_epi8(v, hash), _mm_cmpeq_epi8(v, question));
+    bad = _mm_or_si128(bad, _mm_cmpeq_epi8(v, del));
+#if HTTP_PARSER_STRICT
+    bad = _mm_or_si128(bad, _mm_cmplt_epi8(v, _mm_setzero_si128()));
+#endif
+    mask = (~_mm_movemask_epi8(ok) & 0xffff) | _mm_movemask_epi8(bad);
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+    p += 16;
+  }
+
+  return find_url_end_scalar(p, end);
+}
+#endif  /* HTTP_PARSER_SSE2 */
+
+#if HTTP_PARSER_AVX2
+__attribute__((target("avx2")))
+static const char *find_crlf_avx2(const char *p, const char *end)
+{
+  const __m256i cr = _mm256_set1_epi8(CR);
+  const __m256i lf = _mm256_set1_epi8(LF);
+  __m256i v;
+  unsigned int mask;
+
+  while (end - p >= 32) {
+    v = _mm256_loadu_si256((const __m256i *) p);
+    mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, cr),
+                                                _mm256_cmpeq_epi8(v, lf)));
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+    p += 32;
+  }
+
+  return find_crlf_sse2(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char *find_url_end_avx2(const char *p, const char *end)
+{
+  const __m256i min = _mm256_set1_epi8(0x21);
+  const __m256i hash = _mm256_set1_epi8('#');
+  const __m256i question = _mm256_set1_epi8('?');
+  const __m256i del = _mm256_set1_epi8(0x7f);
+  __m256i v, ok, bad;
+  unsigned int mask;
+
+  while (end - p >= 32) {
+    v = _mm256_loadu_si256((const __m256i *) p);
+    ok = _mm256_cmpeq_epi8(_mm256_max_epu8(v, min), v);
+    bad = _mm256_or_si256(_mm256_cmpeq_epi8(v, hash),
+                          _mm256_cmpeq_epi8(v, question));
+    bad = _mm256_or_si256(bad, _mm256_cmpeq_epi8(v, del));
+#if HTTP_PARSER_STRICT
+    bad = _mm256_or_si256(bad, _mm256_cmpgt_epi8(_mm256_setzero_si256(), v));
+#endif
+    mask = ~(unsigned int) _mm256_movemask_epi8(ok) |
+           (unsigned int) _mm256_movemask_epi8(bad);
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+    p += 32;
+  }
+
+  return find_url_end_sse2(p, end);
+}
+#endif  /* HTTP_PARSER_AVX2 */
+
+static const char *find_crlf(const char *p, const char *end)
+{
+#if HTTP_PARSER_AVX2
+  if (end - p >= 32 && __builtin_cpu_supports("avx2"))
+    return find_crlf_avx2(p, end);
+#endif
+#if HTTP_PARSER_SSE2
+  return find_crlf_sse2(p, end);
+#else
+  return find_crlf_scalar(p, end);
+#endif
+}
+
+static const char *find_url_end(const char *p, const char *end)
+{
+#if HTTP_PARSER_AVX2
+  if (end - p >= 32 && __builtin_cpu_supports("avx2"))
+    return find_url_end_avx2(p, end);
+#endif
+#if HTTP_PARSER_SSE2
+  return find_url_end_sse2(p, end);
+#else
+  return find_url_end_scalar(p, end);
+#endif
+}
+
+/* Header names are short, a table lookup per byte is as fast as it gets. */
+static const char *find_non_token(const char *p, const char *end)
+{
+  while (p < end && TOKEN(*p))
+    p++;
+  return p;
+}
+
+/* Where the fast scanners should stop: the end of the buffer or the byte
+ * that would make parser->nread exceed HTTP_MAX_HEADER_SIZE, whichever
+ * comes first. The byte at p has been counted already.
+ */
+static const char *header_scan_end(const http_parser *parser,
+                                   const char *p,
+                                   const char *end)
+{
+  size_t room = HTTP_MAX_HEADER_SIZE - parser->nread;
+
+  if ((size_t) (end - p) > room + 1)
+    return p + room + 1;
+
+  return end;
+}
+
+/* Skips p ahead to the byte that scanner() stops on, or to the last byte in
+ * the buffer if it finds none, and updates ch and parser->nread to match.
+ */
+#define FAST_SCAN(scanner)                                           \
+do {                                                                 \
+  const char *end_ = header_scan_end(parser, p, data + len);         \
+  const char *q_ = scanner(p, end_);                                 \
+  if (q_ == end_)                                                    \
+    q_--;                                                            \
+  parser->nread += q_ - p;                                           \
+  p = q_;                                                            \
+  ch = *p;                                                           \
+} while (0)
+
 /* Our URL parser.
  *
  * This is designed to be shared by http_parser_execute() for URL validation,
@@ -1078,6 +1277,12 @@ size_t http_parser_execute (http_parser *parser,
       case s_req_fragment_start:
       case s_req_fragment:
       {
+        if (parser->state == s_req_path ||
+            parser->state == s_req_query_string ||
+            parser->state == s_req_fragment) {
+          FAST_SCAN(find_url_end);
+        }
+
         switch (ch) {
           case ' ':
             parser->state = s_req_http_start;
@@ -1276,6 +1481,9 @@ size_t http_parser_execute (http_parser *parser,
 
       case s_header_field:
       {
+        if (parser->header_state == h_general)
+          FAST_SCAN(find_non_token);
+
         c = TOKEN(ch);
 
         if (c) {
@@ -1473,6 +1681,8 @@ size_t http_parser_execute (http_parser *parser,
 
       case s_header_value:
       {
+        if (parser->header_state == h_general)
+          FAST_SCAN(find_crlf);
 
         if (ch == CR) {
           parser->state = s_header_almost_done;
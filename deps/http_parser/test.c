@@ -3044,6 +3044,123 @@ test_no_overflow_long_body (int req, size_t length)
   abort();
 }
 
+/* Long URLs, header names and header values go through the fast scanners in
+ * http_parser.c. Try lengths around their 16 and 32 byte block sizes, both in
+ * one piece and split up so that blocks straddle the calls.
+ */
+void
+test_long_elements (size_t n)
+{
+  static const char url_chars[] =
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+    "/-._~%!$&'()*+,;=:@";
+  static const char token_chars[] =
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+    "!#$%&'*+-.^_`|~";
+  char path[601], query[601], fragment[601];
+  char url[sizeof(path) + sizeof(query) + sizeof(fragment) + 1];
+  char field[602], value[MAX_ELEMENT_SIZE - 48];
+  char buf[sizeof(url) + sizeof(field) + sizeof(value) + 64];
+  /* Zero means the whole buffer in one go. */
+  static const size_t steps[] = { 0, 1, 7, 16, 31, 33 };
+  size_t buflen, i, off, step;
+
+  assert(n < sizeof(path));
+
+  for (i = 0; i < n; i++) {
+    path[i] = url_chars[i % (sizeof(url_chars) - 1)];
+    query[i] = url_chars[(i + 7) % (sizeof(url_chars) - 1)];
+    fragment[i] = url_chars[(i + 13) % (sizeof(url_chars) - 1)];
+    field[i + 1] = token_chars[i % (sizeof(token_chars) - 1)];
+  }
+  path[n] = query[n] = fragment[n] = '\0';
+  /* Start the name with an x so it isn't mistaken for a known header. */
+  field[0] = 'x';
+  field[n + 1] = '\0';
+
+  for (i = 0; i < sizeof(value) - 1 && i < 4 * n; i++) {
+    /* Everything but CR and LF, including tabs and bytes > 127. */
+    value[i] = (char) (33 + i % 223);
+    if (i % 37 == 36)
+      value[i] = '\t';
+  }
+  value[i] = '\0';
+
+  sprintf(url, "/%s?%s#%s", path, query, fragment);
+  buflen = sprintf(buf,
+                   "GET %s HTTP/1.1\r\n"
+                   "%s: %s\r\n"
+                   "Content-Length: 0\r\n"
+                   "\r\n",
+                   url, field, value);
+
+  for (i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+    step = steps[i] ? steps[i] : buflen;
+    parser_init(HTTP_REQUEST);
+
+    for (off = 0; off < buflen; off += step) {
+      size_t chunk = MIN(step, buflen - off);
+      if (parse(buf + off, chunk) != chunk) {
+        fprintf(stderr, "\n*** test_long_elements(%lu) error: %s ***\n",
+                (unsigned long) n,
+                http_errno_name(HTTP_PARSER_ERRNO(parser)));
+        abort();
+      }
+    }
+
+    assert(num_messages == 1);
+    assert(strcmp(messages[0].request_url, url) == 0);
+    assert(messages[0].num_headers == 2);
+    assert(strcmp(messages[0].headers[0][0], field) == 0);
+    assert(strcmp(messages[0].headers[0][1], value) == 0);
+    assert(strcmp(messages[0].headers[1][0], "Content-Length") == 0);
+    assert(strcmp(messages[0].headers[1][1], "0") == 0);
+
+    parser_free();
+  }
+}
+
+/* The fast scanners skip ahead over many bytes at a time. The header size
+ * limit must still hit on the same byte as when the parser is fed one byte
+ * at a time.
+ */
+void
+test_header_size_limit (const char *prefix, char fill)
+{
+  http_parser parser;
+  size_t prefix_len = strlen(prefix);
+  size_t parsed;
+  size_t n;
+  char *buf;
+
+  http_parser_init(&parser, HTTP_REQUEST);
+  parsed = http_parser_execute(&parser, &settings_null, prefix, prefix_len);
+  assert(parsed == prefix_len);
+  for (n = 0; ; n++) {
+    parsed = http_parser_execute(&parser, &settings_null, &fill, 1);
+    if (parsed != 1)
+      break;
+  }
+  assert(HTTP_PARSER_ERRNO(&parser) == HPE_HEADER_OVERFLOW);
+
+  buf = malloc(prefix_len + n + 1);
+  assert(buf);
+  memcpy(buf, prefix, prefix_len);
+  memset(buf + prefix_len, fill, n + 1);
+
+  http_parser_init(&parser, HTTP_REQUEST);
+  parsed = http_parser_execute(&parser, &settings_null, buf, prefix_len + n);
+  assert(parsed == prefix_len + n);
+  assert(HTTP_PARSER_ERRNO(&parser) == HPE_OK);
+
+  http_parser_init(&parser, HTTP_REQUEST);
+  parsed = http_parser_execute(&parser, &settings_null, buf, prefix_len + n + 1);
+  assert(parsed == prefix_len + n);
+  assert(HTTP_PARSER_ERRNO(&parser) == HPE_HEADER_OVERFLOW);
+
+  free(buf);
+}
+
 void
 test_multiple3 (const struct message *r1, const struct message *r2, const struct message *r3)
 {
@@ -3343,6 +3460,23 @@ main (void)
   test_header_content_length_overflow_error();
   test_chunk_content_length_overflow_error();
 
+  test_header_size_limit("GET /", 'a');
+  test_header_size_limit("GET /?", 'a');
+  test_header_size_limit("GET / HTTP/1.1\r\nx-name", 'a');
+  test_header_size_limit("GET / HTTP/1.1\r\nX-Value: ", 'a');
+
+  //// LONG ELEMENTS
+
+  for (i = 0; i <= 100; i++)
+    test_long_elements(i);
+  test_long_elements(127);
+  test_long_elements(128);
+  test_long_elements(129);
+  test_long_elements(255);
+  test_long_elements(256);
+  test_long_elements(257);
+  test_long_elements(480);
+
   //// RESPONSES
 
   for (i = 0; i < response_count; i++) {
@@ -26,6 +26,8 @@
   uv__io_t inotify_read_watcher;                                              \
   void* inotify_watchers;                                                     \
   int inotify_fd;                                                             \
+  void* epoll_ctl_ring;                                                       \
+  void* fs_ring;                                                              \
 
 #define UV_PLATFORM_FS_EVENT_FIELDS                                           \
   void* watchers[2];                                                          \
@@ -235,6 +235,9 @@ typedef struct {
   uv__io_t signal_io_watcher;                                                 \
   uv_signal_t child_watcher;                                                  \
   int emfile_fd;                                                              \
+  int metrics_enabled;                                                        \
+  uint64_t metrics_poll_wait;                                                 \
+  uv_metrics_t metrics;                                                       \
   UV_PLATFORM_LOOP_FIELDS                                                     \
 
 #define UV_REQ_TYPE_PRIVATE /* empty */
@@ -346,7 +346,11 @@ RB_HEAD(uv_timer_tree_s, uv_timer_s);
   /* Threadpool */                                                            \
   void* wq[2];                                                                \
   uv_mutex_t wq_mutex;                                                        \
-  uv_async_t wq_async;
+  uv_async_t wq_async;                                                        \
+  /* Bookkeeping for uv_metrics_info() */                                     \
+  int metrics_enabled;                                                        \
+  uint64_t metrics_poll_wait;                                                 \
+  uv_metrics_t metrics;
 
 #define UV_REQ_TYPE_PRIVATE                                                   \
   /* TODO: remove the req suffix */                                           \
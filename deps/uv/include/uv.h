@@ -271,6 +271,31 @@ UV_EXTERN uint64_t uv_now(const uv_loop_t*);
 UV_EXTERN int uv_backend_fd(const uv_loop_t*);
 UV_EXTERN int uv_backend_timeout(const uv_loop_t*);
 
+typedef enum {
+  UV_METRICS_TIMERS,
+  UV_METRICS_PENDING,
+  UV_METRICS_IDLE_PREPARE,
+  UV_METRICS_POLL_WAIT,     /* Blocked in the kernel, waiting for events. */
+  UV_METRICS_POLL_IO,       /* Running I/O callbacks. */
+  UV_METRICS_CHECK,
+  UV_METRICS_CLOSING,
+  UV_METRICS_PHASE_MAX
+} uv_metrics_phase;
+
+/*
+ * Event loop statistics, collected while enabled with uv_metrics_enable().
+ * Times are in nanoseconds, per phase of uv_run().
+ */
+typedef struct {
+  uint64_t loop_count;      /* Iterations of uv_run(). */
+  uint64_t events;          /* Events reported by the kernel. */
+  uint64_t phase_time[UV_METRICS_PHASE_MAX];
+  uint64_t watcher_updates; /* epoll_ctl() calls, zero on other platforms. */
+} uv_metrics_t;
+
+UV_EXTERN void uv_metrics_enable(uv_loop_t* loop, int enable);
+UV_EXTERN void uv_metrics_info(const uv_loop_t* loop, uv_metrics_t* metrics);
+
 typedef void (*uv_alloc_cb)(uv_handle_t* handle,
                             size_t suggested_size,
                             uv_buf_t* buf);
@@ -498,7 +523,13 @@ UV_EXTERN int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable);
 
 enum uv_tcp_flags {
   /* Used with uv_tcp_bind, when an IPv6 address is used. */
-  UV_TCP_IPV6ONLY = 1
+  UV_TCP_IPV6ONLY = 1,
+  /*
+   * Used with uv_tcp_bind. Lets several sockets bind to the same address and
+   * port, the kernel spreads incoming connections across them. Returns
+   * UV_ENOTSUP on platforms that don't have SO_REUSEPORT.
+   */
+  UV_TCP_REUSEPORT = 2
 };
 
 UV_EXTERN int uv_tcp_bind(uv_tcp_t* handle,
@@ -544,7 +575,17 @@ enum uv_udp_flags {
    * (provided they all set the flag) but only the last one to bind will receive
    * any traffic, in effect "stealing" the port from the previous listener.
    */
-  UV_UDP_REUSEADDR = 4
+  UV_UDP_REUSEADDR = 4,
+  /*
+   * Indicates that the message was received by recvmmsg(2) and that the
+   * buffer is a slice of the buffer returned by the allocator.
+   */
+  UV_UDP_MMSG_CHUNK = 8,
+  /*
+   * Indicates that recv_cb is done with the buffer of a recvmmsg(2) batch.
+   * The callback gets the buffer from the allocator back, nread is zero.
+   */
+  UV_UDP_MMSG_FREE = 16
 };
 
 typedef void (*uv_udp_send_cb)(uv_udp_send_t* req, int status);
@@ -597,6 +638,7 @@ UV_EXTERN int uv_udp_set_multicast_interface(uv_udp_t* handle,
                                              const char* interface_addr);
 UV_EXTERN int uv_udp_set_broadcast(uv_udp_t* handle, int on);
 UV_EXTERN int uv_udp_set_ttl(uv_udp_t* handle, int ttl);
+UV_EXTERN int uv_udp_set_recvmmsg(uv_udp_t* handle, int on);
 UV_EXTERN int uv_udp_send(uv_udp_send_t* req,
                           uv_udp_t* handle,
                           const uv_buf_t bufs[],
@@ -607,6 +649,10 @@ UV_EXTERN int uv_udp_try_send(uv_udp_t* handle,
                               const uv_buf_t bufs[],
                               unsigned int nbufs,
                               const struct sockaddr* addr);
+UV_EXTERN int uv_udp_try_send_multi(uv_udp_t* handle,
+                                    const uv_buf_t bufs[],
+                                    const struct sockaddr* const addrs[],
+                                    unsigned int nmsgs);
 UV_EXTERN int uv_udp_recv_start(uv_udp_t* handle,
                                 uv_alloc_cb alloc_cb,
                                 uv_udp_recv_cb recv_cb);
@@ -917,10 +963,47 @@ struct uv_work_s {
   UV_WORK_PRIVATE_FIELDS
 };
 
+/*
+ * Classes of thread pool work. Each class has its own queue and threads.
+ */
+typedef enum {
+  UV_WORK_FAST_IO = 0,  /* File system operations. */
+  UV_WORK_SLOW_IO,      /* DNS lookups. */
+  UV_WORK_CPU,          /* Compression, cryptography, etc. */
+  UV_WORK_CLASS_MAX
+} uv_work_class;
+
 UV_EXTERN int uv_queue_work(uv_loop_t* loop,
                             uv_work_t* req,
                             uv_work_cb work_cb,
                             uv_after_work_cb after_work_cb);
+UV_EXTERN int uv_queue_work_ex(uv_loop_t* loop,
+                               uv_work_t* req,
+                               uv_work_class kind,
+                               uv_work_cb work_cb,
+                               uv_after_work_cb after_work_cb);
+
+#define UV_THREADPOOL_HISTOGRAM_SIZE 32
+
+/*
+ * Thread pool statistics for one class of work. Times are in nanoseconds.
+ * Histogram bucket n counts work items that took at least 2^n but less than
+ * 2^(n+1) microseconds. Bucket 0 also counts anything under a microsecond,
+ * the last bucket anything that took longer.
+ */
+typedef struct {
+  unsigned int threads;    /* Zero until the first work is submitted. */
+  unsigned int queued;     /* Work items waiting for a thread right now. */
+  uint64_t submitted;      /* Includes work items that were cancelled. */
+  uint64_t completed;
+  uint64_t wait_time;      /* Total time between submit and start. */
+  uint64_t run_time;       /* Total time between start and finish. */
+  uint64_t wait_histogram[UV_THREADPOOL_HISTOGRAM_SIZE];
+  uint64_t run_histogram[UV_THREADPOOL_HISTOGRAM_SIZE];
+} uv_threadpool_stats_t;
+
+UV_EXTERN int uv_threadpool_stats(uv_work_class kind,
+                                  uv_threadpool_stats_t* stats);
 
 UV_EXTERN int uv_cancel(uv_req_t* req);
 
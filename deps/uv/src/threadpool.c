@@ -37,58 +37,221 @@ static void uv__req_init(uv_loop_t* loop,
     uv__req_init((loop), (uv_req_t*)(req), (type))
 #endif
 
+#include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define MAX_THREADPOOL_SIZE 128
 
+/* Statistics of a single worker thread. Only the thread itself writes to
+ * them so that updating them doesn't take a lock. Readers may see a torn
+ * update now and then, that's acceptable for statistics.
+ */
+struct uv__work_stats {
+  uint64_t completed;
+  uint64_t wait_time;
+  uint64_t run_time;
+  uint64_t wait_histogram[UV_THREADPOOL_HISTOGRAM_SIZE];
+  uint64_t run_histogram[UV_THREADPOOL_HISTOGRAM_SIZE];
+};
+
+/* When a work item was submitted. struct uv__work is embedded in public
+ * request types so it can't carry the time itself, the pool keeps the times
+ * in a ring that mirrors its queue instead.
+ */
+struct uv__work_stamp {
+  struct uv__work* w;
+  uint64_t time;
+};
+
+struct uv__worker {
+  struct uv__work_pool* pool;
+  struct uv__work_stats stats;
+};
+
+/* Every class of work has a queue and threads of its own so that, say, a
+ * burst of slow DNS lookups can't hold up file system operations. The
+ * threads of a class are started when the first work item is submitted.
+ */
+struct uv__work_pool {
+  QUEUE wq;
+  QUEUE exit_message;
+  uv_cond_t cond;
+  uv_thread_t* threads;
+  struct uv__worker* workers;
+  unsigned int nthreads;
+  /* Protected by the global mutex. */
+  uint64_t submitted;
+  struct uv__work_stamp* stamps;
+  unsigned int stamps_head;
+  unsigned int stamps_count;
+  unsigned int stamps_size;
+  int started;
+  /* Protected by offload_mutex, see uv__work_offload_begin(). */
+  uint64_t offloaded_submitted;
+  struct uv__work_stats offloaded;
+};
+
 static uv_once_t once = UV_ONCE_INIT;
-static uv_cond_t cond;
 static uv_mutex_t mutex;
-static unsigned int nthreads;
-static uv_thread_t* threads;
-static uv_thread_t default_threads[4];
-static QUEUE exit_message;
-static QUEUE wq;
+static uv_mutex_t offload_mutex;
+static struct uv__work_pool pools[UV_WORK_CLASS_MAX];
 static volatile int initialized;
 
+/* UV_THREADPOOL_SIZE used to size the one pool that all work shared. It still
+ * sizes every class that doesn't have its own variable set, so programs that
+ * raise it keep their uv_queue_work() and getaddrinfo concurrency.
+ */
+static const char* const pool_size_env[UV_WORK_CLASS_MAX] = {
+  "UV_THREADPOOL_SIZE",           /* UV_WORK_FAST_IO */
+  "UV_THREADPOOL_SLOW_IO_SIZE",   /* UV_WORK_SLOW_IO */
+  "UV_THREADPOOL_CPU_SIZE"        /* UV_WORK_CPU */
+};
+
+static const unsigned int pool_size_default[UV_WORK_CLASS_MAX] = {
+  4,  /* UV_WORK_FAST_IO */
+  2,  /* UV_WORK_SLOW_IO */
+  2   /* UV_WORK_CPU */
+};
+
 
 static void uv__cancelled(struct uv__work* w) {
   abort();
 }
 
 
+/* Called with the global mutex held. */
+static void uv__work_stamp_push(struct uv__work_pool* pool,
+                                struct uv__work* w,
+                                uint64_t time) {
+  struct uv__work_stamp* stamps;
+  unsigned int size;
+  unsigned int i;
+
+  if (pool->stamps_count == pool->stamps_size) {
+    size = pool->stamps_size == 0 ? 64 : 2 * pool->stamps_size;
+    stamps = malloc(size * sizeof(stamps[0]));
+    if (stamps == NULL)
+      abort();
+    for (i = 0; i < pool->stamps_count; i++)
+      stamps[i] = pool->stamps[(pool->stamps_head + i) % pool->stamps_size];
+    free(pool->stamps);
+    pool->stamps = stamps;
+    pool->stamps_head = 0;
+    pool->stamps_size = size;
+  }
+
+  i = (pool->stamps_head + pool->stamps_count) % pool->stamps_size;
+  pool->stamps[i].w = w;
+  pool->stamps[i].time = time;
+  pool->stamps_count++;
+}
+
+
+/* Called with the global mutex held, |w| must be at the head of the queue. */
+static uint64_t uv__work_stamp_shift(struct uv__work_pool* pool,
+                                     struct uv__work* w) {
+  struct uv__work_stamp* stamp;
+
+  assert(pool->stamps_count > 0);
+  stamp = pool->stamps + pool->stamps_head;
+  assert(stamp->w == w);
+  pool->stamps_head = (pool->stamps_head + 1) % pool->stamps_size;
+  pool->stamps_count--;
+
+  return stamp->time;
+}
+
+
+/* Called with the global mutex held. Returns 0 if |w| isn't queued. */
+static int uv__work_stamp_remove(struct uv__work_pool* pool,
+                                 struct uv__work* w) {
+  unsigned int size;
+  unsigned int i;
+
+  size = pool->stamps_size;
+  for (i = 0; i < pool->stamps_count; i++)
+    if (pool->stamps[(pool->stamps_head + i) % size].w == w)
+      break;
+
+  if (i == pool->stamps_count)
+    return 0;
+
+  for (; i + 1 < pool->stamps_count; i++)
+    pool->stamps[(pool->stamps_head + i) % size] =
+        pool->stamps[(pool->stamps_head + i + 1) % size];
+  pool->stamps_count--;
+
+  return 1;
+}
+
+
+static unsigned int uv__work_bucket(uint64_t ns) {
+  uint64_t us;
+  unsigned int n;
+
+  us = ns / 1000;
+  for (n = 0; us > 1 && n < UV_THREADPOOL_HISTOGRAM_SIZE - 1; n++)
+    us >>= 1;
+
+  return n;
+}
+
+
+static void uv__work_record(struct uv__work_stats* stats,
+                            uint64_t wait,
+                            uint64_t run) {
+  stats->completed++;
+  stats->wait_time += wait;
+  stats->run_time += run;
+  stats->wait_histogram[uv__work_bucket(wait)]++;
+  stats->run_histogram[uv__work_bucket(run)]++;
+}
+
+
 /* To avoid deadlock with uv_cancel() it's crucial that the worker
  * never holds the global mutex and the loop-local mutex at the same time.
  */
 static void worker(void* arg) {
+  struct uv__work_stats* stats;
+  struct uv__work_pool* pool;
   struct uv__work* w;
+  uint64_t submit_time;
+  uint64_t start;
+  uint64_t end;
   QUEUE* q;
 
-  (void) arg;
+  pool = ((struct uv__worker*) arg)->pool;
+  stats = &((struct uv__worker*) arg)->stats;
 
   for (;;) {
     uv_mutex_lock(&mutex);
 
-    while (QUEUE_EMPTY(&wq))
-      uv_cond_wait(&cond, &mutex);
+    while (QUEUE_EMPTY(&pool->wq))
+      uv_cond_wait(&pool->cond, &mutex);
 
-    q = QUEUE_HEAD(&wq);
+    q = QUEUE_HEAD(&pool->wq);
 
-    if (q == &exit_message)
-      uv_cond_signal(&cond);
+    if (q == &pool->exit_message)
+      uv_cond_signal(&pool->cond);
     else {
       QUEUE_REMOVE(q);
       QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
                              executing. */
+      w = QUEUE_DATA(q, struct uv__work, wq);
+      submit_time = uv__work_stamp_shift(pool, w);
     }
 
     uv_mutex_unlock(&mutex);
 
-    if (q == &exit_message)
+    if (q == &pool->exit_message)
       break;
 
-    w = QUEUE_DATA(q, struct uv__work, wq);
+    start = uv_hrtime();
     w->work(w);
+    end = uv_hrtime();
+
+    uv__work_record(stats, start - submit_time, end - start);
 
     uv_mutex_lock(&w->loop->wq_mutex);
     w->work = NULL;  /* Signal uv_cancel() that the work req is done
@@ -100,99 +263,232 @@ static void worker(void* arg) {
 }
 
 
-static void post(QUEUE* q) {
+/* Called with the global mutex held. */
+static void start_pool(struct uv__work_pool* pool) {
+  unsigned int i;
+
+  pool->threads = malloc(pool->nthreads * sizeof(pool->threads[0]));
+  pool->workers = calloc(pool->nthreads, sizeof(pool->workers[0]));
+  if (pool->threads == NULL || pool->workers == NULL)
+    abort();
+
+  for (i = 0; i < pool->nthreads; i++) {
+    pool->workers[i].pool = pool;
+    if (uv_thread_create(pool->threads + i, worker, pool->workers + i))
+      abort();
+  }
+
+  pool->started = 1;
+}
+
+
+static void post(struct uv__work_pool* pool, struct uv__work* w) {
+  uint64_t now;
+
+  now = uv_hrtime();
   uv_mutex_lock(&mutex);
-  QUEUE_INSERT_TAIL(&wq, q);
-  uv_cond_signal(&cond);
+  if (pool->started == 0)
+    start_pool(pool);
+  pool->submitted++;
+  uv__work_stamp_push(pool, w, now);
+  QUEUE_INSERT_TAIL(&pool->wq, &w->wq);
+  uv_cond_signal(&pool->cond);
   uv_mutex_unlock(&mutex);
 }
 
 
 #ifndef _WIN32
 UV_DESTRUCTOR(static void cleanup(void)) {
+  struct uv__work_pool* pool;
   unsigned int i;
+  unsigned int k;
 
   if (initialized == 0)
     return;
 
-  post(&exit_message);
+  for (k = 0; k < ARRAY_SIZE(pools); k++) {
+    pool = pools + k;
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_join(threads + i))
-      abort();
+    if (pool->started) {
+      uv_mutex_lock(&mutex);
+      QUEUE_INSERT_TAIL(&pool->wq, &pool->exit_message);
+      uv_cond_signal(&pool->cond);
+      uv_mutex_unlock(&mutex);
 
-  if (threads != default_threads)
-    free(threads);
+      for (i = 0; i < pool->nthreads; i++)
+        if (uv_thread_join(pool->threads + i))
+          abort();
 
-  uv_mutex_destroy(&mutex);
-  uv_cond_destroy(&cond);
+      free(pool->threads);
+      free(pool->workers);
+    }
+
+    uv_cond_destroy(&pool->cond);
+    free(pool->stamps);
+    pool->stamps = NULL;
+    pool->stamps_head = 0;
+    pool->stamps_count = 0;
+    pool->stamps_size = 0;
+    pool->threads = NULL;
+    pool->workers = NULL;
+    pool->nthreads = 0;
+    pool->started = 0;
+  }
 
-  threads = NULL;
-  nthreads = 0;
+  uv_mutex_destroy(&offload_mutex);
+  uv_mutex_destroy(&mutex);
   initialized = 0;
 }
 #endif
 
 
 static void init_once(void) {
-  unsigned int i;
+  struct uv__work_pool* pool;
   const char* val;
-
-  nthreads = ARRAY_SIZE(default_threads);
-  val = getenv("UV_THREADPOOL_SIZE");
-  if (val != NULL)
-    nthreads = atoi(val);
-  if (nthreads == 0)
-    nthreads = 1;
-  if (nthreads > MAX_THREADPOOL_SIZE)
-    nthreads = MAX_THREADPOOL_SIZE;
-
-  threads = default_threads;
-  if (nthreads > ARRAY_SIZE(default_threads)) {
-    threads = malloc(nthreads * sizeof(threads[0]));
-    if (threads == NULL) {
-      nthreads = ARRAY_SIZE(default_threads);
-      threads = default_threads;
-    }
-  }
-
-  if (uv_cond_init(&cond))
-    abort();
+  unsigned int k;
 
   if (uv_mutex_init(&mutex))
     abort();
 
-  QUEUE_INIT(&wq);
+  if (uv_mutex_init(&offload_mutex))
+    abort();
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_create(threads + i, worker, NULL))
+  for (k = 0; k < ARRAY_SIZE(pools); k++) {
+    pool = pools + k;
+
+    pool->nthreads = pool_size_default[k];
+    val = getenv(pool_size_env[k]);
+    if (val == NULL)
+      val = getenv("UV_THREADPOOL_SIZE");
+    if (val != NULL)
+      pool->nthreads = atoi(val);
+    if (pool->nthreads == 0)
+      pool->nthreads = 1;
+    if (pool->nthreads > MAX_THREADPOOL_SIZE)
+      pool->nthreads = MAX_THREADPOOL_SIZE;
+
+    if (uv_cond_init(&pool->cond))
       abort();
 
+    QUEUE_INIT(&pool->wq);
+    pool->threads = NULL;
+    pool->workers = NULL;
+    pool->submitted = 0;
+    pool->stamps = NULL;
+    pool->stamps_head = 0;
+    pool->stamps_count = 0;
+    pool->stamps_size = 0;
+    pool->started = 0;
+    pool->offloaded_submitted = 0;
+    memset(&pool->offloaded, 0, sizeof(pool->offloaded));
+  }
+
   initialized = 1;
 }
 
 
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work* w,
+                     uv_work_class kind,
                      void (*work)(struct uv__work* w),
                      void (*done)(struct uv__work* w, int status)) {
+  assert((unsigned int) kind < UV_WORK_CLASS_MAX);
   uv_once(&once, init_once);
   w->loop = loop;
   w->work = work;
   w->done = done;
-  post(&w->wq);
+  post(pools + kind, w);
+}
+
+
+static void uv__work_stats_add(uv_threadpool_stats_t* stats,
+                               const struct uv__work_stats* ws) {
+  unsigned int k;
+
+  stats->completed += ws->completed;
+  stats->wait_time += ws->wait_time;
+  stats->run_time += ws->run_time;
+  for (k = 0; k < UV_THREADPOOL_HISTOGRAM_SIZE; k++) {
+    stats->wait_histogram[k] += ws->wait_histogram[k];
+    stats->run_histogram[k] += ws->run_histogram[k];
+  }
+}
+
+
+/* Work of class |kind| that the platform runs without the thread pool, file
+ * system requests on io_uring for example, still shows up in its statistics.
+ * It doesn't wait for a thread, all of its time counts as run time.
+ *
+ * The counts have a mutex of their own. Taking the global mutex here would
+ * make every such request contend with the thread pool it is meant to bypass.
+ */
+void uv__work_offload_begin(uv_work_class kind) {
+  assert((unsigned int) kind < UV_WORK_CLASS_MAX);
+  uv_once(&once, init_once);
+  uv_mutex_lock(&offload_mutex);
+  pools[kind].offloaded_submitted++;
+  uv_mutex_unlock(&offload_mutex);
+}
+
+
+void uv__work_offload_end(uv_work_class kind, uint64_t start, uint64_t end) {
+  assert((unsigned int) kind < UV_WORK_CLASS_MAX);
+  uv_mutex_lock(&offload_mutex);
+  uv__work_record(&pools[kind].offloaded, 0, end - start);
+  uv_mutex_unlock(&offload_mutex);
+}
+
+
+int uv_threadpool_stats(uv_work_class kind, uv_threadpool_stats_t* stats) {
+  struct uv__work_pool* pool;
+  unsigned int i;
+  QUEUE* q;
+
+  if ((unsigned int) kind >= UV_WORK_CLASS_MAX)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+  memset(stats, 0, sizeof(*stats));
+  pool = pools + kind;
+
+  uv_mutex_lock(&mutex);
+
+  stats->submitted = pool->submitted;
+  QUEUE_FOREACH(q, &pool->wq)
+    if (q != &pool->exit_message)
+      stats->queued++;
+
+  if (pool->started) {
+    stats->threads = pool->nthreads;
+    for (i = 0; i < pool->nthreads; i++)
+      uv__work_stats_add(stats, &pool->workers[i].stats);
+  }
+
+  uv_mutex_unlock(&mutex);
+
+  uv_mutex_lock(&offload_mutex);
+  stats->submitted += pool->offloaded_submitted;
+  uv__work_stats_add(stats, &pool->offloaded);
+  uv_mutex_unlock(&offload_mutex);
+
+  return 0;
 }
 
 
 static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
+  unsigned int k;
   int cancelled;
 
   uv_mutex_lock(&mutex);
   uv_mutex_lock(&w->loop->wq_mutex);
 
   cancelled = !QUEUE_EMPTY(&w->wq) && w->work != NULL;
-  if (cancelled)
+  if (cancelled) {
     QUEUE_REMOVE(&w->wq);
+    for (k = 0; k < ARRAY_SIZE(pools); k++)
+      if (uv__work_stamp_remove(pools + k, w))
+        break;
+  }
 
   uv_mutex_unlock(&w->loop->wq_mutex);
   uv_mutex_unlock(&mutex);
@@ -262,14 +558,26 @@ int uv_queue_work(uv_loop_t* loop,
                   uv_work_t* req,
                   uv_work_cb work_cb,
                   uv_after_work_cb after_work_cb) {
+  return uv_queue_work_ex(loop, req, UV_WORK_CPU, work_cb, after_work_cb);
+}
+
+
+int uv_queue_work_ex(uv_loop_t* loop,
+                     uv_work_t* req,
+                     uv_work_class kind,
+                     uv_work_cb work_cb,
+                     uv_after_work_cb after_work_cb) {
   if (work_cb == NULL)
     return UV_EINVAL;
 
+  if ((unsigned int) kind >= UV_WORK_CLASS_MAX)
+    return UV_EINVAL;
+
   uv__req_init(loop, req, UV_WORK);
   req->loop = loop;
   req->work_cb = work_cb;
   req->after_work_cb = after_work_cb;
-  uv__work_submit(loop, &req->work_req, uv__queue_work, uv__queue_done);
+  uv__work_submit(loop, &req->work_req, kind, uv__queue_work, uv__queue_done);
   return 0;
 }
 
@@ -263,7 +263,7 @@ void uv__async_stop(uv_loop_t* loop, struct uv__async* wa) {
     wa->wfd = -1;
   }
 
-  uv__io_stop(loop, &wa->io_watcher, UV__POLLIN);
+  uv__io_close(loop, &wa->io_watcher);
   uv__close(wa->io_watcher.fd);
   wa->io_watcher.fd = -1;
 }
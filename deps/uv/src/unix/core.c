@@ -302,6 +302,7 @@ int uv_loop_alive(const uv_loop_t* loop) {
 
 
 int uv_run(uv_loop_t* loop, uv_run_mode mode) {
+  uint64_t t;
   int timeout;
   int r;
 
@@ -310,19 +311,26 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
     uv__update_time(loop);
 
   while (r != 0 && loop->stop_flag == 0) {
+    t = uv__metrics_begin(loop);
     uv__update_time(loop);
     uv__run_timers(loop);
+    t = uv__metrics_phase(loop, UV_METRICS_TIMERS, t);
     uv__run_pending(loop);
+    t = uv__metrics_phase(loop, UV_METRICS_PENDING, t);
     uv__run_idle(loop);
     uv__run_prepare(loop);
+    t = uv__metrics_phase(loop, UV_METRICS_IDLE_PREPARE, t);
 
     timeout = 0;
     if ((mode & UV_RUN_NOWAIT) == 0)
       timeout = uv_backend_timeout(loop);
 
     uv__io_poll(loop, timeout);
+    t = uv__metrics_poll(loop, t);
     uv__run_check(loop);
+    t = uv__metrics_phase(loop, UV_METRICS_CHECK, t);
     uv__run_closing_handles(loop);
+    t = uv__metrics_phase(loop, UV_METRICS_CLOSING, t);
 
     if (mode == UV_RUN_ONCE) {
       /* UV_RUN_ONCE implies forward progess: at least one callback must have
@@ -335,6 +343,7 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
        */
       uv__update_time(loop);
       uv__run_timers(loop);
+      uv__metrics_phase(loop, UV_METRICS_TIMERS, t);
     }
 
     r = uv__loop_alive(loop);
@@ -776,6 +785,12 @@ void uv__io_start(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   w->pevents |= events;
   maybe_resize(loop, w->fd + 1);
 
+  /* Not registered with the backend, or only as the previous owner of a file
+   * descriptor number that's been closed and reused since, see uv__io_stop().
+   */
+  if (loop->watchers[w->fd] != w)
+    w->events = 0;
+
 #if !defined(__sun)
   /* The event ports backend needs to rearm all file descriptors on each and
    * every tick of the event loop but the other backends allow us to
@@ -793,13 +808,24 @@ void uv__io_start(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   if (QUEUE_EMPTY(&w->watcher_queue))
     QUEUE_INSERT_TAIL(&loop->watcher_queue, &w->watcher_queue);
 
-  if (loop->watchers[w->fd] == NULL) {
+  if (loop->watchers[w->fd] != w) {
+    if (loop->watchers[w->fd] == NULL)
+      loop->nfds++;
     loop->watchers[w->fd] = w;
-    loop->nfds++;
   }
 }
 
 
+void uv__io_detach(uv_loop_t* loop, uv__io_t* w) {
+  if (loop->watchers[w->fd] == w) {
+    assert(loop->nfds > 0);
+    loop->watchers[w->fd] = NULL;
+    loop->nfds--;
+  }
+  w->events = 0;
+}
+
+
 void uv__io_stop(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   assert(0 == (events & ~(UV__POLLIN | UV__POLLOUT)));
   assert(0 != events);
@@ -818,14 +844,16 @@ void uv__io_stop(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   if (w->pevents == 0) {
     QUEUE_REMOVE(&w->watcher_queue);
     QUEUE_INIT(&w->watcher_queue);
-
-    if (loop->watchers[w->fd] != NULL) {
-      assert(loop->watchers[w->fd] == w);
-      assert(loop->nfds > 0);
-      loop->watchers[w->fd] = NULL;
-      loop->nfds--;
-      w->events = 0;
-    }
+#if defined(__linux__)
+    /* Stay registered with epoll and keep w->events, a stream that pauses
+     * and resumes reading would otherwise cost an EPOLL_CTL_ADD (that fails
+     * with EEXIST) and an EPOLL_CTL_MOD every time. uv__io_poll() drops
+     * the registration when an event comes in while nobody is interested,
+     * uv__io_close() when the file descriptor goes away.
+     */
+#else
+    uv__io_detach(loop, w);
+#endif
   }
   else if (QUEUE_EMPTY(&w->watcher_queue))
     QUEUE_INSERT_TAIL(&loop->watcher_queue, &w->watcher_queue);
@@ -836,6 +864,9 @@ void uv__io_close(uv_loop_t* loop, uv__io_t* w) {
   uv__io_stop(loop, w, UV__POLLIN | UV__POLLOUT);
   QUEUE_REMOVE(&w->pending_queue);
 
+  if (w->fd != -1 && (unsigned) w->fd < loop->nwatchers)
+    uv__io_detach(loop, w);
+
   /* Remove stale events for this file descriptor */
   uv__platform_invalidate_fd(loop, w->fd);
 }
@@ -113,7 +113,11 @@
 #define POST                                                                  \
   do {                                                                        \
     if ((cb) != NULL) {                                                       \
-      uv__work_submit((loop), &(req)->work_req, uv__fs_work, uv__fs_done);    \
+      uv__work_submit((loop),                                                 \
+                      &(req)->work_req,                                       \
+                      UV_WORK_FAST_IO,                                        \
+                      uv__fs_work,                                            \
+                      uv__fs_done);                                           \
       return 0;                                                               \
     }                                                                         \
     else {                                                                    \
@@ -895,6 +899,8 @@ int uv_fs_chown(uv_loop_t* loop,
 int uv_fs_close(uv_loop_t* loop, uv_fs_t* req, uv_file file, uv_fs_cb cb) {
   INIT(CLOSE);
   req->file = file;
+  if (cb != NULL && uv__iou_fs_close(loop, req))
+    return 0;
   POST;
 }
 
@@ -928,6 +934,8 @@ int uv_fs_fchown(uv_loop_t* loop,
 int uv_fs_fdatasync(uv_loop_t* loop, uv_fs_t* req, uv_file file, uv_fs_cb cb) {
   INIT(FDATASYNC);
   req->file = file;
+  if (cb != NULL && uv__iou_fs_fsync(loop, req, /* datasync */ 1))
+    return 0;
   POST;
 }
 
@@ -935,6 +943,9 @@ int uv_fs_fdatasync(uv_loop_t* loop, uv_fs_t* req, uv_file file, uv_fs_cb cb) {
 int uv_fs_fstat(uv_loop_t* loop, uv_fs_t* req, uv_file file, uv_fs_cb cb) {
   INIT(FSTAT);
   req->file = file;
+  if (cb != NULL &&
+      uv__iou_fs_statx(loop, req, /* is_fstat */ 1, /* is_lstat */ 0))
+    return 0;
   POST;
 }
 
@@ -942,6 +953,8 @@ int uv_fs_fstat(uv_loop_t* loop, uv_fs_t* req, uv_file file, uv_fs_cb cb) {
 int uv_fs_fsync(uv_loop_t* loop, uv_fs_t* req, uv_file file, uv_fs_cb cb) {
   INIT(FSYNC);
   req->file = file;
+  if (cb != NULL && uv__iou_fs_fsync(loop, req, /* datasync */ 0))
+    return 0;
   POST;
 }
 
@@ -975,6 +988,9 @@ int uv_fs_futime(uv_loop_t* loop,
 int uv_fs_lstat(uv_loop_t* loop, uv_fs_t* req, const char* path, uv_fs_cb cb) {
   INIT(LSTAT);
   PATH;
+  if (cb != NULL &&
+      uv__iou_fs_statx(loop, req, /* is_fstat */ 0, /* is_lstat */ 1))
+    return 0;
   POST;
 }
 
@@ -1024,6 +1040,8 @@ int uv_fs_open(uv_loop_t* loop,
   PATH;
   req->flags = flags;
   req->mode = mode;
+  if (cb != NULL && uv__iou_fs_open(loop, req))
+    return 0;
   POST;
 }
 
@@ -1048,6 +1066,8 @@ int uv_fs_read(uv_loop_t* loop, uv_fs_t* req,
   memcpy(req->bufs, bufs, nbufs * sizeof(*bufs));
 
   req->off = off;
+  if (cb != NULL && uv__iou_fs_read_or_write(loop, req, /* is_read */ 1))
+    return 0;
   POST;
 }
 
@@ -1111,6 +1131,9 @@ int uv_fs_sendfile(uv_loop_t* loop,
 int uv_fs_stat(uv_loop_t* loop, uv_fs_t* req, const char* path, uv_fs_cb cb) {
   INIT(STAT);
   PATH;
+  if (cb != NULL &&
+      uv__iou_fs_statx(loop, req, /* is_fstat */ 0, /* is_lstat */ 0))
+    return 0;
   POST;
 }
 
@@ -1170,6 +1193,8 @@ int uv_fs_write(uv_loop_t* loop,
   memcpy(req->bufs, bufs, nbufs * sizeof(*bufs));
 
   req->off = off;
+  if (cb != NULL && uv__iou_fs_read_or_write(loop, req, /* is_read */ 0))
+    return 0;
   POST;
 }
 
@@ -29,9 +29,11 @@
 #include <errno.h>
 
 #include <net/if.h>
+#include <sys/mman.h>
 #include <sys/param.h>
 #include <sys/prctl.h>
 #include <sys/sysinfo.h>
+#include <sys/sysmacros.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <time.h>
@@ -68,10 +70,293 @@
 # define CLOCK_BOOTTIME 7
 #endif
 
+/* Watcher changes are normally applied with one epoll_ctl() system call
+ * each.  When UV_USE_IO_URING=1 is set and the kernel supports
+ * IORING_OP_EPOLL_CTL (5.6+), they are queued on an io_uring instead and
+ * submitted with a single io_uring_enter() call right before epoll_wait().
+ *
+ * The same switch makes the loop run asynchronous open, close, read, write,
+ * fsync and stat requests on a second io_uring rather than the thread pool.
+ * Requests are submitted in batches right before polling; completions wake
+ * up epoll_wait() through the ring's file descriptor.
+ */
+#define UV__EPOLL_CTL_RING_ENTRIES 256
+#define UV__FS_RING_ENTRIES 128
+
+struct uv__iou {
+  uint32_t* sqhead;
+  uint32_t* sqtail;
+  uint32_t* sqarray;
+  uint32_t sqmask;
+  uint32_t* cqhead;
+  uint32_t* cqtail;
+  uint32_t cqmask;
+  struct uv__io_uring_sqe* sqe;
+  struct uv__io_uring_cqe* cqe;
+  void* sq;
+  void* cq;  /* Same as sq when the kernel supports IORING_FEAT_SINGLE_MMAP. */
+  size_t sqlen;
+  size_t cqlen;
+  size_t sqelen;
+  uint32_t sqentries;
+  uint32_t cqentries;
+  uint32_t features;
+  int ringfd;
+};
+
+struct uv__epoll_ctl_ring {
+  struct uv__iou iou;
+  uint32_t pending;
+  struct uv__epoll_event events[UV__EPOLL_CTL_RING_ENTRIES];
+};
+
+struct uv__fs_ring_slot {
+  uv_fs_t* req;
+  uint64_t submit_time;  /* For uv_threadpool_stats(). */
+};
+
+struct uv__fs_ring {
+  struct uv__iou iou;
+  uv__io_t watcher;
+  uint32_t in_flight;  /* Queued or submitted but not completed yet. */
+  /* One slot per completion queue entry, the user_data of an SQE is the
+   * index of its slot. The free ones are kept on a stack, in_flight of them
+   * are in use.
+   */
+  struct uv__fs_ring_slot* slots;
+  uint32_t* free_slots;
+};
+
 static int read_models(unsigned int numcpus, uv_cpu_info_t* ci);
 static int read_times(unsigned int numcpus, uv_cpu_info_t* ci);
 static void read_speeds(unsigned int numcpus, uv_cpu_info_t* ci);
 static unsigned long read_cpufreq(unsigned int cpunum);
+static void uv__epoll_ctl_flush(uv_loop_t* loop);
+static void uv__fs_ring_poll(uv_loop_t* loop,
+                             uv__io_t* w,
+                             unsigned int events);
+
+
+static int uv__use_io_uring(void) {
+  static int use_io_uring = -1;
+
+  if (use_io_uring == -1) {
+    const char* val = getenv("UV_USE_IO_URING");
+    use_io_uring = (val != NULL && atoi(val) != 0);  /* Off by default. */
+  }
+
+  return use_io_uring;
+}
+
+
+/* Counted for uv_metrics_info(). */
+static int uv__loop_epoll_ctl(uv_loop_t* loop,
+                              int op,
+                              int fd,
+                              struct uv__epoll_event* e) {
+  if (loop->metrics_enabled)
+    loop->metrics.watcher_updates++;
+  return uv__epoll_ctl(loop->backend_fd, op, fd, e);
+}
+
+
+static int uv__iou_init(struct uv__iou* iou,
+                        uint32_t entries,
+                        const uint8_t* ops,
+                        size_t nops) {
+  struct uv__io_uring_params params;
+  struct uv__io_uring_probe probe;
+  size_t sqlen;
+  size_t cqlen;
+  size_t sqelen;
+  uint32_t i;
+  uint8_t op;
+  char* sq;
+  char* cq;
+  char* sqe;
+  int ringfd;
+  int err;
+
+  memset(&params, 0, sizeof(params));
+  ringfd = uv__io_uring_setup(entries, &params);
+  if (ringfd == -1)
+    return -errno;
+
+  /* The ring is useless to us if the kernel doesn't know the operations. */
+  memset(&probe, 0, sizeof(probe));
+  if (uv__io_uring_register(ringfd,
+                            UV__IORING_REGISTER_PROBE,
+                            &probe,
+                            ARRAY_SIZE(probe.ops))) {
+    err = -errno;
+    goto fail;
+  }
+
+  for (i = 0; i < nops; i++) {
+    op = ops[i];
+    if (op > probe.last_op ||
+        op >= ARRAY_SIZE(probe.ops) ||
+        (probe.ops[op].flags & UV__IO_URING_OP_SUPPORTED) == 0) {
+      err = -ENOSYS;
+      goto fail;
+    }
+  }
+
+  sqlen = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cqlen = params.cq_off.cqes +
+          params.cq_entries * sizeof(struct uv__io_uring_cqe);
+  sqelen = params.sq_entries * sizeof(struct uv__io_uring_sqe);
+
+  if (params.features & UV__IORING_FEAT_SINGLE_MMAP) {
+    if (sqlen < cqlen)
+      sqlen = cqlen;
+    cqlen = sqlen;
+  }
+
+  sq = mmap(NULL,
+            sqlen,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            ringfd,
+            UV__IORING_OFF_SQ_RING);
+  if (sq == MAP_FAILED) {
+    err = -errno;
+    goto fail;
+  }
+
+  cq = sq;
+  if ((params.features & UV__IORING_FEAT_SINGLE_MMAP) == 0) {
+    cq = mmap(NULL,
+              cqlen,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE,
+              ringfd,
+              UV__IORING_OFF_CQ_RING);
+    if (cq == MAP_FAILED) {
+      err = -errno;
+      goto fail_cq;
+    }
+  }
+
+  sqe = mmap(NULL,
+             sqelen,
+             PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE,
+             ringfd,
+             UV__IORING_OFF_SQES);
+  if (sqe == MAP_FAILED) {
+    err = -errno;
+    goto fail_sqe;
+  }
+
+  iou->sqhead = (uint32_t*) (sq + params.sq_off.head);
+  iou->sqtail = (uint32_t*) (sq + params.sq_off.tail);
+  iou->sqarray = (uint32_t*) (sq + params.sq_off.array);
+  iou->sqmask = *(uint32_t*) (sq + params.sq_off.ring_mask);
+  iou->cqhead = (uint32_t*) (cq + params.cq_off.head);
+  iou->cqtail = (uint32_t*) (cq + params.cq_off.tail);
+  iou->cqmask = *(uint32_t*) (cq + params.cq_off.ring_mask);
+  iou->sqe = (struct uv__io_uring_sqe*) sqe;
+  iou->cqe = (struct uv__io_uring_cqe*) (cq + params.cq_off.cqes);
+  iou->sq = sq;
+  iou->cq = cq;
+  iou->sqlen = sqlen;
+  iou->cqlen = cqlen;
+  iou->sqelen = sqelen;
+  iou->sqentries = params.sq_entries;
+  iou->cqentries = params.cq_entries;
+  iou->features = params.features;
+  iou->ringfd = ringfd;
+
+  /* Slot i in the submission array always points to submission entry i. */
+  for (i = 0; i <= iou->sqmask; i++)
+    iou->sqarray[i] = i;
+
+  return 0;
+
+fail_sqe:
+  if (cq != sq)
+    munmap(cq, cqlen);
+
+fail_cq:
+  munmap(sq, sqlen);
+
+fail:
+  uv__close(ringfd);
+  return err;
+}
+
+
+static void uv__iou_delete(struct uv__iou* iou) {
+  munmap(iou->sqe, iou->sqelen);
+  if (iou->cq != iou->sq)
+    munmap(iou->cq, iou->cqlen);
+  munmap(iou->sq, iou->sqlen);
+  uv__close(iou->ringfd);
+  iou->ringfd = -1;
+}
+
+
+static void uv__epoll_ctl_ring_init(uv_loop_t* loop) {
+  static const uint8_t ops[] = { UV__IORING_OP_EPOLL_CTL };
+  struct uv__epoll_ctl_ring* ctl;
+
+  ctl = malloc(sizeof(*ctl));
+  if (ctl == NULL)
+    return;
+
+  /* Fall back to plain epoll_ctl() if the kernel is too old or io_uring has
+   * been disabled by the administrator or a seccomp filter.
+   */
+  if (uv__iou_init(&ctl->iou, ARRAY_SIZE(ctl->events), ops, ARRAY_SIZE(ops))) {
+    free(ctl);
+    return;
+  }
+
+  ctl->pending = 0;
+  loop->epoll_ctl_ring = ctl;
+}
+
+
+static void uv__fs_ring_init(uv_loop_t* loop) {
+  static const uint8_t ops[] = {
+    UV__IORING_OP_READV,
+    UV__IORING_OP_WRITEV,
+    UV__IORING_OP_FSYNC,
+    UV__IORING_OP_OPENAT,
+    UV__IORING_OP_CLOSE,
+    UV__IORING_OP_STATX
+  };
+  struct uv__fs_ring* ring;
+  uint32_t i;
+
+  ring = malloc(sizeof(*ring));
+  if (ring == NULL)
+    return;
+
+  /* The read/write/open/close/stat operations are 5.6+, like EPOLL_CTL. */
+  if (uv__iou_init(&ring->iou, UV__FS_RING_ENTRIES, ops, ARRAY_SIZE(ops))) {
+    free(ring);
+    return;
+  }
+
+  ring->slots = malloc(ring->iou.cqentries * sizeof(ring->slots[0]));
+  ring->free_slots = malloc(ring->iou.cqentries * sizeof(ring->free_slots[0]));
+  if (ring->slots == NULL || ring->free_slots == NULL) {
+    free(ring->free_slots);
+    free(ring->slots);
+    uv__iou_delete(&ring->iou);
+    free(ring);
+    return;
+  }
+
+  for (i = 0; i < ring->iou.cqentries; i++)
+    ring->free_slots[i] = i;
+
+  uv__io_init(&ring->watcher, uv__fs_ring_poll, ring->iou.ringfd);
+  ring->in_flight = 0;
+  loop->fs_ring = ring;
+}
 
 
 int uv__platform_loop_init(uv_loop_t* loop, int default_loop) {
@@ -92,17 +377,45 @@ int uv__platform_loop_init(uv_loop_t* loop, int default_loop) {
   loop->backend_fd = fd;
   loop->inotify_fd = -1;
   loop->inotify_watchers = NULL;
+  loop->epoll_ctl_ring = NULL;
+  loop->fs_ring = NULL;
 
   if (fd == -1)
     return -errno;
 
+  if (uv__use_io_uring()) {
+    uv__epoll_ctl_ring_init(loop);
+    uv__fs_ring_init(loop);
+  }
+
   return 0;
 }
 
 
 void uv__platform_loop_delete(uv_loop_t* loop) {
+  struct uv__epoll_ctl_ring* ctl;
+  struct uv__fs_ring* ring;
+
+  ring = loop->fs_ring;
+  if (ring != NULL) {
+    assert(ring->in_flight == 0);
+    uv__io_close(loop, &ring->watcher);
+    uv__iou_delete(&ring->iou);
+    free(ring->free_slots);
+    free(ring->slots);
+    free(ring);
+    loop->fs_ring = NULL;
+  }
+
+  ctl = loop->epoll_ctl_ring;
+  if (ctl != NULL) {
+    uv__iou_delete(&ctl->iou);
+    free(ctl);
+    loop->epoll_ctl_ring = NULL;
+  }
+
   if (loop->inotify_fd == -1) return;
-  uv__io_stop(loop, &loop->inotify_read_watcher, UV__POLLIN);
+  uv__io_close(loop, &loop->inotify_read_watcher);
   uv__close(loop->inotify_fd);
   loop->inotify_fd = -1;
 }
@@ -131,7 +444,403 @@ void uv__platform_invalidate_fd(uv_loop_t* loop, int fd) {
    * We pass in a dummy epoll_event, to work around a bug in old kernels.
    */
   if (loop->backend_fd >= 0)
-    uv__epoll_ctl(loop->backend_fd, UV__EPOLL_CTL_DEL, fd, &dummy);
+    uv__loop_epoll_ctl(loop, UV__EPOLL_CTL_DEL, fd, &dummy);
+}
+
+
+static void uv__epoll_ctl_prep(uv_loop_t* loop,
+                               int op,
+                               int fd,
+                               const struct uv__epoll_event* e) {
+  struct uv__epoll_ctl_ring* ctl;
+  struct uv__io_uring_sqe* sqe;
+  struct uv__iou* iou;
+  uint32_t slot;
+
+  ctl = loop->epoll_ctl_ring;
+  if (ctl->pending == ARRAY_SIZE(ctl->events))
+    uv__epoll_ctl_flush(loop);
+
+  if (loop->metrics_enabled)
+    loop->metrics.watcher_updates++;
+
+  iou = &ctl->iou;
+  slot = ctl->pending++;
+  ctl->events[slot] = *e;
+
+  sqe = iou->sqe + ((*iou->sqtail + slot) & iou->sqmask);
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = UV__IORING_OP_EPOLL_CTL;
+  sqe->fd = loop->backend_fd;
+  sqe->off = fd;
+  sqe->len = op;
+  sqe->addr = (uintptr_t) &ctl->events[slot];
+  sqe->user_data = (uint64_t) op << 32 | slot;
+}
+
+
+static void uv__epoll_ctl_flush(uv_loop_t* loop) {
+  struct uv__epoll_ctl_ring* ctl;
+  struct uv__io_uring_cqe* cqe;
+  struct uv__epoll_event* e;
+  struct uv__iou* iou;
+  uint32_t nsubmit;
+  uint32_t ndone;
+  uint32_t head;
+  uint32_t tail;
+  int op;
+  int rc;
+
+  ctl = loop->epoll_ctl_ring;
+  if (ctl->pending == 0)
+    return;
+
+  iou = &ctl->iou;
+
+  /* Make the new entries visible to the kernel. */
+  __atomic_store_n(iou->sqtail, *iou->sqtail + ctl->pending, __ATOMIC_RELEASE);
+
+  nsubmit = ctl->pending;
+  ndone = 0;
+
+  while (ndone < ctl->pending) {
+    rc = uv__io_uring_enter(iou->ringfd,
+                            nsubmit,
+                            ctl->pending - ndone,
+                            UV__IORING_ENTER_GETEVENTS);
+    if (rc == -1) {
+      if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+        abort();
+    } else if (nsubmit > 0) {
+      nsubmit -= rc;  /* Number of submitted entries. */
+    }
+
+    head = *iou->cqhead;
+    tail = __atomic_load_n(iou->cqtail, __ATOMIC_ACQUIRE);
+
+    for (; head != tail; head++, ndone++) {
+      cqe = iou->cqe + (head & iou->cqmask);
+      if (cqe->res == 0)
+        continue;
+
+      op = cqe->user_data >> 32;
+      e = &ctl->events[(uint32_t) cqe->user_data];
+
+      if (cqe->res != -EEXIST || op != UV__EPOLL_CTL_ADD)
+        abort();
+
+      /* We've reactivated a file descriptor that's been watched before. */
+      if (uv__loop_epoll_ctl(loop, UV__EPOLL_CTL_MOD, (int) e->data, e))
+        abort();
+    }
+
+    __atomic_store_n(iou->cqhead, tail, __ATOMIC_RELEASE);
+  }
+
+  ctl->pending = 0;
+}
+
+
+/* Returns the number of entries that are still waiting to be submitted. */
+static uint32_t uv__fs_ring_submit(struct uv__fs_ring* ring) {
+  struct uv__iou* iou;
+  uint32_t nsubmit;
+  int rc;
+
+  iou = &ring->iou;
+  nsubmit = *iou->sqtail - __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE);
+
+  while (nsubmit > 0) {
+    rc = uv__io_uring_enter(iou->ringfd, nsubmit, 0, 0);
+    if (rc == -1) {
+      /* Out of kernel resources, try again on the next tick. */
+      if (errno == EAGAIN || errno == EBUSY)
+        break;
+      if (errno != EINTR)
+        abort();
+      continue;
+    }
+    nsubmit -= rc;
+  }
+
+  return nsubmit;
+}
+
+
+static struct uv__io_uring_sqe* uv__iou_fs_get_sqe(uv_loop_t* loop,
+                                                   uv_fs_t* req) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__fs_ring_slot* slot;
+  struct uv__fs_ring* ring;
+  struct uv__iou* iou;
+  uint32_t index;
+  uint32_t tail;
+
+  ring = loop->fs_ring;
+  if (ring == NULL)
+    return NULL;
+
+  iou = &ring->iou;
+
+  /* Don't overrun the completion queue, leave the rest to the thread pool. */
+  if (ring->in_flight == iou->cqentries)
+    return NULL;
+
+  tail = *iou->sqtail;
+  if (tail - __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE) == iou->sqentries) {
+    uv__fs_ring_submit(ring);
+    if (tail - __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE) == iou->sqentries)
+      return NULL;
+  }
+
+  index = ring->free_slots[iou->cqentries - ring->in_flight - 1];
+  slot = ring->slots + index;
+  slot->req = req;
+  slot->submit_time = uv_hrtime();
+  uv__work_offload_begin(UV_WORK_FAST_IO);
+
+  sqe = iou->sqe + (tail & iou->sqmask);
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->user_data = index;
+
+  /* Not in the thread pool, uv_cancel() should return UV_EBUSY. */
+  req->work_req.loop = loop;
+  req->work_req.work = NULL;
+  QUEUE_INIT(&req->work_req.wq);
+
+  /* Make the entry visible to the kernel, it's submitted by uv__io_poll(). */
+  __atomic_store_n(iou->sqtail, tail + 1, __ATOMIC_RELEASE);
+
+  /* Once started, the watcher stays on. Stopping and restarting it for every
+   * batch would cost more epoll_ctl() calls than the ring saves.
+   */
+  if (!uv__io_active(&ring->watcher, UV__POLLIN))
+    uv__io_start(loop, &ring->watcher, UV__POLLIN);
+
+  ring->in_flight++;
+
+  return sqe;
+}
+
+
+int uv__iou_fs_close(uv_loop_t* loop, uv_fs_t* req) {
+  struct uv__io_uring_sqe* sqe;
+
+  sqe = uv__iou_fs_get_sqe(loop, req);
+  if (sqe == NULL)
+    return 0;
+
+  sqe->opcode = UV__IORING_OP_CLOSE;
+  sqe->fd = req->file;
+
+  return 1;
+}
+
+
+int uv__iou_fs_fsync(uv_loop_t* loop, uv_fs_t* req, int datasync) {
+  struct uv__io_uring_sqe* sqe;
+
+  sqe = uv__iou_fs_get_sqe(loop, req);
+  if (sqe == NULL)
+    return 0;
+
+  sqe->opcode = UV__IORING_OP_FSYNC;
+  sqe->fd = req->file;
+  sqe->rw_flags = datasync ? UV__IORING_FSYNC_DATASYNC : 0;
+
+  return 1;
+}
+
+
+int uv__iou_fs_open(uv_loop_t* loop, uv_fs_t* req) {
+  struct uv__io_uring_sqe* sqe;
+
+  sqe = uv__iou_fs_get_sqe(loop, req);
+  if (sqe == NULL)
+    return 0;
+
+  /* Every kernel with io_uring knows O_CLOEXEC, no need for the cloexec lock
+   * that the thread pool implementation takes.
+   */
+  sqe->opcode = UV__IORING_OP_OPENAT;
+  sqe->fd = UV__AT_FDCWD;
+  sqe->addr = (uintptr_t) req->path;
+  sqe->len = req->mode;
+  sqe->rw_flags = req->flags | UV__O_CLOEXEC;
+
+  return 1;
+}
+
+
+int uv__iou_fs_read_or_write(uv_loop_t* loop, uv_fs_t* req, int is_read) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__fs_ring* ring;
+
+  /* Reads and writes at the current file position need 5.6+. */
+  ring = loop->fs_ring;
+  if (ring == NULL)
+    return 0;
+
+  if (req->off < 0 && (ring->iou.features & UV__IORING_FEAT_RW_CUR_POS) == 0)
+    return 0;
+
+  sqe = uv__iou_fs_get_sqe(loop, req);
+  if (sqe == NULL)
+    return 0;
+
+  sqe->opcode = is_read ? UV__IORING_OP_READV : UV__IORING_OP_WRITEV;
+  sqe->fd = req->file;
+  sqe->addr = (uintptr_t) req->bufs;
+  sqe->len = req->nbufs;
+  sqe->off = req->off < 0 ? (uint64_t) -1 : (uint64_t) req->off;
+
+  return 1;
+}
+
+
+int uv__iou_fs_statx(uv_loop_t* loop,
+                     uv_fs_t* req,
+                     int is_fstat,
+                     int is_lstat) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__statx* statxbuf;
+
+  if (loop->fs_ring == NULL)
+    return 0;
+
+  statxbuf = malloc(sizeof(*statxbuf));
+  if (statxbuf == NULL)
+    return 0;
+
+  sqe = uv__iou_fs_get_sqe(loop, req);
+  if (sqe == NULL) {
+    free(statxbuf);
+    return 0;
+  }
+
+  /* Released again in uv__iou_fs_done(). */
+  req->ptr = statxbuf;
+
+  sqe->opcode = UV__IORING_OP_STATX;
+  sqe->fd = is_fstat ? req->file : UV__AT_FDCWD;
+  sqe->addr = (uintptr_t) (is_fstat ? "" : req->path);
+  sqe->off = (uintptr_t) statxbuf;
+  sqe->len = UV__STATX_BASIC_STATS;
+
+  if (is_fstat)
+    sqe->rw_flags |= UV__AT_EMPTY_PATH;
+
+  if (is_lstat)
+    sqe->rw_flags |= UV__AT_SYMLINK_NOFOLLOW;
+
+  return 1;
+}
+
+
+static void uv__statx_to_stat(const struct uv__statx* src, uv_stat_t* dst) {
+  dst->st_dev = makedev(src->stx_dev_major, src->stx_dev_minor);
+  dst->st_mode = src->stx_mode;
+  dst->st_nlink = src->stx_nlink;
+  dst->st_uid = src->stx_uid;
+  dst->st_gid = src->stx_gid;
+  dst->st_rdev = makedev(src->stx_rdev_major, src->stx_rdev_minor);
+  dst->st_ino = src->stx_ino;
+  dst->st_size = src->stx_size;
+  dst->st_blksize = src->stx_blksize;
+  dst->st_blocks = src->stx_blocks;
+  /* Same as the thread pool implementation, see uv__to_stat(). That includes
+   * the resolution of the timestamps.
+   */
+  dst->st_atim.tv_sec = src->stx_atime.tv_sec;
+  dst->st_mtim.tv_sec = src->stx_mtime.tv_sec;
+  dst->st_ctim.tv_sec = src->stx_ctime.tv_sec;
+  dst->st_birthtim.tv_sec = src->stx_ctime.tv_sec;
+#if defined(_BSD_SOURCE) || defined(_SVID_SOURCE) || defined(_XOPEN_SOURCE)
+  dst->st_atim.tv_nsec = src->stx_atime.tv_nsec;
+  dst->st_mtim.tv_nsec = src->stx_mtime.tv_nsec;
+  dst->st_ctim.tv_nsec = src->stx_ctime.tv_nsec;
+  dst->st_birthtim.tv_nsec = src->stx_ctime.tv_nsec;
+#else
+  dst->st_atim.tv_nsec = 0;
+  dst->st_mtim.tv_nsec = 0;
+  dst->st_ctim.tv_nsec = 0;
+  dst->st_birthtim.tv_nsec = 0;
+#endif
+  dst->st_flags = 0;
+  dst->st_gen = 0;
+}
+
+
+static void uv__iou_fs_done(uv_loop_t* loop, uv_fs_t* req, int32_t res) {
+  struct uv__statx* statxbuf;
+
+  switch (req->fs_type) {
+    case UV_FS_READ:
+    case UV_FS_WRITE:
+      if (req->bufs != req->bufsml)
+        free(req->bufs);
+      break;
+
+    case UV_FS_FSTAT:
+    case UV_FS_LSTAT:
+    case UV_FS_STAT:
+      statxbuf = req->ptr;
+      req->ptr = NULL;
+      if (res == 0) {
+        uv__statx_to_stat(statxbuf, &req->statbuf);
+        req->ptr = &req->statbuf;
+      }
+      free(statxbuf);
+      break;
+
+    default:
+      break;
+  }
+
+  req->result = res;
+  uv__req_unregister(loop, req);
+  req->cb(req);
+}
+
+
+static void uv__fs_ring_poll(uv_loop_t* loop,
+                             uv__io_t* w,
+                             unsigned int events) {
+  struct uv__io_uring_cqe* cqe;
+  struct uv__fs_ring_slot* slot;
+  struct uv__fs_ring* ring;
+  struct uv__iou* iou;
+  uv_fs_t* req;
+  uint32_t index;
+  uint32_t head;
+  uint32_t tail;
+  int32_t res;
+
+  ring = container_of(w, struct uv__fs_ring, watcher);
+  iou = &ring->iou;
+
+  head = *iou->cqhead;
+  tail = __atomic_load_n(iou->cqtail, __ATOMIC_ACQUIRE);
+
+  while (head != tail) {
+    cqe = iou->cqe + (head & iou->cqmask);
+    index = (uint32_t) cqe->user_data;
+    res = cqe->res;
+
+    /* Release the entry before running the callback, it can queue more. */
+    __atomic_store_n(iou->cqhead, ++head, __ATOMIC_RELEASE);
+
+    assert(index < iou->cqentries);
+    slot = ring->slots + index;
+    req = slot->req;
+    uv__work_offload_end(UV_WORK_FAST_IO, slot->submit_time, uv_hrtime());
+
+    assert(ring->in_flight > 0);
+    ring->in_flight--;
+    ring->free_slots[iou->cqentries - ring->in_flight - 1] = index;
+
+    uv__iou_fs_done(loop, req, res);
+  }
 }
 
 
@@ -139,10 +848,12 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   struct uv__epoll_event events[1024];
   struct uv__epoll_event* pe;
   struct uv__epoll_event e;
+  struct uv__epoll_ctl_ring* ctl;
   QUEUE* q;
   uv__io_t* w;
   uint64_t base;
   uint64_t diff;
+  uint64_t wait_start;
   int nevents;
   int count;
   int nfds;
@@ -156,6 +867,8 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     return;
   }
 
+  ctl = loop->epoll_ctl_ring;
+
   while (!QUEUE_EMPTY(&loop->watcher_queue)) {
     q = QUEUE_HEAD(&loop->watcher_queue);
     QUEUE_REMOVE(q);
@@ -166,6 +879,15 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     assert(w->fd >= 0);
     assert(w->fd < (int) loop->nwatchers);
 
+    /* Do EPOLL_CTL_MOD lazily when we only stop watching events: skip the
+     * system call, squelch the events after epoll_wait() and reprogram the
+     * kernel only when one of them actually fires.  Saves a system call
+     * for every uv_read_stop/uv_read_start cycle.  w->events is the mask
+     * that's in the kernel, a superset of w->pevents in that case.
+     */
+    if (w->events != 0 && (w->pevents & ~w->events) == 0)
+      continue;
+
     e.events = w->pevents;
     e.data = w->fd;
 
@@ -174,28 +896,38 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     else
       op = UV__EPOLL_CTL_MOD;
 
-    /* XXX Future optimization: do EPOLL_CTL_MOD lazily if we stop watching
-     * events, skip the syscall and squelch the events after epoll_wait().
-     */
-    if (uv__epoll_ctl(loop->backend_fd, op, w->fd, &e)) {
+    if (ctl != NULL)
+      uv__epoll_ctl_prep(loop, op, w->fd, &e);
+    else if (uv__loop_epoll_ctl(loop, op, w->fd, &e)) {
       if (errno != EEXIST)
         abort();
 
       assert(op == UV__EPOLL_CTL_ADD);
 
       /* We've reactivated a file descriptor that's been watched before. */
-      if (uv__epoll_ctl(loop->backend_fd, UV__EPOLL_CTL_MOD, w->fd, &e))
+      if (uv__loop_epoll_ctl(loop, UV__EPOLL_CTL_MOD, w->fd, &e))
         abort();
     }
 
     w->events = w->pevents;
   }
 
+  if (ctl != NULL)
+    uv__epoll_ctl_flush(loop);
+
+  /* Entries that the kernel didn't take yet are retried on the next tick.
+   * Don't block in epoll_wait() in the meantime, nothing would wake it up.
+   */
+  if (loop->fs_ring != NULL && uv__fs_ring_submit(loop->fs_ring) != 0)
+    timeout = 0;
+
   assert(timeout >= -1);
   base = loop->time;
   count = 48; /* Benchmarks suggest this gives the best throughput. */
 
   for (;;) {
+    wait_start = uv__metrics_wait_begin(loop);
+
     if (!no_epoll_wait) {
       nfds = uv__epoll_wait(loop->backend_fd,
                             events,
@@ -213,6 +945,8 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
                              NULL);
     }
 
+    SAVE_ERRNO(uv__metrics_wait_end(loop, wait_start, nfds));
+
     /* Update loop->time unconditionally. It's tempting to skip the update when
      * timeout == 0 (i.e. non-blocking poll) but there is no guarantee that the
      * operating system didn't reschedule our process while in the syscall.
@@ -262,7 +996,16 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
          * Ignore all errors because we may be racing with another thread
          * when the file descriptor is closed.
          */
-        uv__epoll_ctl(loop->backend_fd, UV__EPOLL_CTL_DEL, fd, pe);
+        uv__loop_epoll_ctl(loop, UV__EPOLL_CTL_DEL, fd, pe);
+        continue;
+      }
+
+      if (w->pevents == 0) {
+        /* Stopped but still registered, see uv__io_stop(). Disarm it now
+         * that it's waking us up.
+         */
+        uv__loop_epoll_ctl(loop, UV__EPOLL_CTL_DEL, fd, pe);
+        uv__io_detach(loop, w);
         continue;
       }
 
@@ -271,7 +1014,20 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
        * the current watcher. Also, filters out events that users has not
        * requested us to watch.
        */
-      pe->events &= w->pevents | UV__POLLERR | UV__POLLHUP;
+      if (pe->events & ~(w->pevents | UV__POLLERR | UV__POLLHUP)) {
+        pe->events &= w->pevents | UV__POLLERR | UV__POLLHUP;
+
+        /* An event we stopped watching lazily, see above. Now is the time
+         * to tell the kernel or it will keep waking us up.
+         */
+        if (w->events != w->pevents) {
+          e.events = w->pevents;
+          e.data = fd;
+          if (uv__loop_epoll_ctl(loop, UV__EPOLL_CTL_MOD, fd, &e))
+            abort();
+          w->events = w->pevents;
+        }
+      }
 
       /* Work around an epoll quirk where it sometimes reports just the
        * EPOLLERR or EPOLLHUP event.  In order to force the event loop to
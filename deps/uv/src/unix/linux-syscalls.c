@@ -119,6 +119,30 @@
 # endif
 #endif /* __NR_epoll_pwait */
 
+#ifndef __NR_io_uring_setup
+# if defined(__x86_64__) || defined(__i386__)
+#  define __NR_io_uring_setup 425
+# elif defined(__arm__)
+#  define __NR_io_uring_setup (UV_SYSCALL_BASE + 425)
+# endif
+#endif /* __NR_io_uring_setup */
+
+#ifndef __NR_io_uring_enter
+# if defined(__x86_64__) || defined(__i386__)
+#  define __NR_io_uring_enter 426
+# elif defined(__arm__)
+#  define __NR_io_uring_enter (UV_SYSCALL_BASE + 426)
+# endif
+#endif /* __NR_io_uring_enter */
+
+#ifndef __NR_io_uring_register
+# if defined(__x86_64__) || defined(__i386__)
+#  define __NR_io_uring_register 427
+# elif defined(__arm__)
+#  define __NR_io_uring_register (UV_SYSCALL_BASE + 427)
+# endif
+#endif /* __NR_io_uring_register */
+
 #ifndef __NR_inotify_init
 # if defined(__x86_64__)
 #  define __NR_inotify_init 253
@@ -335,6 +359,49 @@ int uv__epoll_pwait(int epfd,
 }
 
 
+int uv__io_uring_setup(unsigned int entries,
+                       struct uv__io_uring_params* params) {
+#if defined(__NR_io_uring_setup)
+  return syscall(__NR_io_uring_setup, entries, params);
+#else
+  return errno = ENOSYS, -1;
+#endif
+}
+
+
+int uv__io_uring_enter(int fd,
+                       unsigned int to_submit,
+                       unsigned int min_complete,
+                       unsigned int flags) {
+#if defined(__NR_io_uring_enter)
+  /* The last two arguments are the signal mask and its size; we don't
+   * use them.
+   */
+  return syscall(__NR_io_uring_enter,
+                 fd,
+                 to_submit,
+                 min_complete,
+                 flags,
+                 NULL,
+                 0L);
+#else
+  return errno = ENOSYS, -1;
+#endif
+}
+
+
+int uv__io_uring_register(int fd,
+                          unsigned int opcode,
+                          void* arg,
+                          unsigned int nargs) {
+#if defined(__NR_io_uring_register)
+  return syscall(__NR_io_uring_register, fd, opcode, arg, nargs);
+#else
+  return errno = ENOSYS, -1;
+#endif
+}
+
+
 int uv__inotify_init(void) {
 #if defined(__NR_inotify_init)
   return syscall(__NR_inotify_init);
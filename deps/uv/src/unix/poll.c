@@ -83,10 +83,10 @@ int uv_poll_start(uv_poll_t* handle, int pevents, uv_poll_cb poll_cb) {
   assert((pevents & ~(UV_READABLE | UV_WRITABLE)) == 0);
   assert(!(handle->flags & (UV_CLOSING | UV_CLOSED)));
 
-  uv__poll_stop(handle);
-
-  if (pevents == 0)
+  if (pevents == 0) {
+    uv__poll_stop(handle);
     return 0;
+  }
 
   events = 0;
   if (pevents & UV_READABLE)
@@ -94,6 +94,14 @@ int uv_poll_start(uv_poll_t* handle, int pevents, uv_poll_cb poll_cb) {
   if (pevents & UV_WRITABLE)
     events |= UV__POLLOUT;
 
+  /* Only stop the events we're no longer interested in. Stopping all of them
+   * makes the backend forget about the file descriptor and register it anew.
+   */
+  if (events != (UV__POLLIN | UV__POLLOUT))
+    uv__io_stop(handle->loop,
+                &handle->io_watcher,
+                ~events & (UV__POLLIN | UV__POLLOUT));
+
   uv__io_start(handle->loop, &handle->io_watcher, events);
   uv__handle_start(handle);
   handle->poll_cb = poll_cb;
@@ -103,5 +111,11 @@ int uv_poll_start(uv_poll_t* handle, int pevents, uv_poll_cb poll_cb) {
 
 
 void uv__poll_close(uv_poll_t* handle) {
-  uv__poll_stop(handle);
+  /* The file descriptor may be a dup() of one that is still open elsewhere,
+   * in which case the kernel keeps the epoll/kqueue registration alive after
+   * the user closes it. uv__io_close() removes it so we don't get junk
+   * events later.
+   */
+  uv__io_close(handle->loop, &handle->io_watcher);
+  uv__handle_stop(handle);
 }
@@ -67,6 +67,11 @@ int uv__tcp_bind(uv_tcp_t* tcp,
   if ((flags & UV_TCP_IPV6ONLY) && addr->sa_family != AF_INET6)
     return -EINVAL;
 
+#ifndef SO_REUSEPORT
+  if (flags & UV_TCP_REUSEPORT)
+    return -ENOTSUP;
+#endif
+
   err = maybe_new_socket(tcp,
                          addr->sa_family,
                          UV_STREAM_READABLE | UV_STREAM_WRITABLE);
@@ -77,6 +82,18 @@ int uv__tcp_bind(uv_tcp_t* tcp,
   if (setsockopt(tcp->io_watcher.fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)))
     return -errno;
 
+#ifdef SO_REUSEPORT
+  if (flags & UV_TCP_REUSEPORT) {
+    if (setsockopt(tcp->io_watcher.fd,
+                   SOL_SOCKET,
+                   SO_REUSEPORT,
+                   &on,
+                   sizeof(on))) {
+      return -errno;
+    }
+  }
+#endif
+
 #ifdef IPV6_V6ONLY
   if (addr->sa_family == AF_INET6) {
     on = (flags & UV_TCP_IPV6ONLY) != 0;
@@ -36,6 +36,13 @@
 # define IPV6_DROP_MEMBERSHIP IPV6_LEAVE_GROUP
 #endif
 
+#define UV__UDP_DGRAM_MAXSIZE (64 * 1024)
+
+#if defined(__linux__)
+# define UV__MMSG_MAXWIDTH 20
+# define UV__SENDMMSG_MAXWIDTH 64
+#endif
+
 
 static void uv__udp_run_completed(uv_udp_t* handle);
 static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents);
@@ -140,6 +147,80 @@ static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents) {
 }
 
 
+#if defined(__linux__)
+static ssize_t uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf) {
+  struct sockaddr_storage peers[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr msgs[UV__MMSG_MAXWIDTH];
+  struct iovec iov[UV__MMSG_MAXWIDTH];
+  uv_buf_t chunk;
+  ssize_t nread;
+  size_t chunks;
+  size_t k;
+  int flags;
+
+  chunks = buf->len / UV__UDP_DGRAM_MAXSIZE;
+  if (chunks > ARRAY_SIZE(msgs))
+    chunks = ARRAY_SIZE(msgs);
+
+  if (chunks == 0) {
+    handle->recv_cb(handle, UV_ENOBUFS, buf, NULL, 0);
+    return -1;
+  }
+
+  memset(msgs, 0, chunks * sizeof(msgs[0]));
+  for (k = 0; k < chunks; k++) {
+    iov[k].iov_base = buf->base + k * UV__UDP_DGRAM_MAXSIZE;
+    iov[k].iov_len = UV__UDP_DGRAM_MAXSIZE;
+    msgs[k].msg_hdr.msg_iov = iov + k;
+    msgs[k].msg_hdr.msg_iovlen = 1;
+    msgs[k].msg_hdr.msg_name = peers + k;
+    msgs[k].msg_hdr.msg_namelen = sizeof(peers[0]);
+  }
+
+  do
+    nread = uv__recvmmsg(handle->io_watcher.fd, msgs, chunks, 0, NULL);
+  while (nread == -1 && errno == EINTR);
+
+  if (nread == -1) {
+    if (errno == ENOSYS) {
+      /* Kernel too old, fall back to recvmsg(). */
+      handle->flags &= ~UV_UDP_RECVMMSG;
+      handle->recv_cb(handle, 0, buf, NULL, 0);
+      return 0;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      handle->recv_cb(handle, 0, buf, NULL, 0);
+    else
+      handle->recv_cb(handle, -errno, buf, NULL, 0);
+    return -1;
+  }
+
+  for (k = 0; k < (size_t) nread; k++) {
+    if (handle->recv_cb == NULL || handle->io_watcher.fd == -1)
+      break;
+
+    flags = UV_UDP_MMSG_CHUNK;
+    if (msgs[k].msg_hdr.msg_flags & MSG_TRUNC)
+      flags |= UV_UDP_PARTIAL;
+
+    chunk = uv_buf_init(iov[k].iov_base, iov[k].iov_len);
+    handle->recv_cb(handle,
+                    msgs[k].msg_len,
+                    &chunk,
+                    msgs[k].msg_hdr.msg_namelen == 0 ?
+                        NULL : (const struct sockaddr*) &peers[k],
+                    flags);
+  }
+
+  /* recv_cb may have stopped or closed the handle but it still owns buf. */
+  if (handle->recv_cb != NULL)
+    handle->recv_cb(handle, 0, buf, NULL, UV_UDP_MMSG_FREE);
+
+  return nread;
+}
+#endif
+
+
 static void uv__udp_recvmsg(uv_udp_t* handle) {
   struct sockaddr_storage peer;
   struct msghdr h;
@@ -160,7 +241,22 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
   h.msg_name = &peer;
 
   do {
-    handle->alloc_cb((uv_handle_t*) handle, 64 * 1024, &buf);
+#if defined(__linux__)
+    if (handle->flags & UV_UDP_RECVMMSG) {
+      handle->alloc_cb((uv_handle_t*) handle,
+                       UV__UDP_DGRAM_MAXSIZE * UV__MMSG_MAXWIDTH,
+                       &buf);
+      if (buf.len == 0) {
+        handle->recv_cb(handle, UV_ENOBUFS, &buf, NULL, 0);
+        return;
+      }
+      assert(buf.base != NULL);
+      nread = uv__udp_recvmmsg(handle, &buf);
+      continue;
+    }
+#endif
+
+    handle->alloc_cb((uv_handle_t*) handle, UV__UDP_DGRAM_MAXSIZE, &buf);
     if (buf.len == 0) {
       handle->recv_cb(handle, UV_ENOBUFS, &buf, NULL, 0);
       return;
@@ -462,6 +558,99 @@ int uv__udp_try_send(uv_udp_t* handle,
 }
 
 
+static socklen_t uv__udp_addrlen(const struct sockaddr* addr) {
+  if (addr->sa_family == AF_INET6)
+    return sizeof(struct sockaddr_in6);
+  return sizeof(struct sockaddr_in);
+}
+
+
+int uv__udp_try_send_multi(uv_udp_t* handle,
+                           const uv_buf_t bufs[],
+                           const struct sockaddr* const addrs[],
+                           unsigned int nmsgs) {
+#if defined(__linux__)
+  struct uv__mmsghdr msgs[UV__SENDMMSG_MAXWIDTH];
+  unsigned int k;
+  unsigned int n;
+#endif
+  struct msghdr h;
+  unsigned int sent;
+  ssize_t r;
+  int err;
+
+  /* already sending a message */
+  if (handle->send_queue_count != 0)
+    return -EAGAIN;
+
+  err = uv__udp_maybe_deferred_bind(handle, addrs[0]->sa_family, 0);
+  if (err)
+    return err;
+
+  sent = 0;
+
+#if defined(__linux__)
+  while (sent < nmsgs) {
+    n = nmsgs - sent;
+    if (n > ARRAY_SIZE(msgs))
+      n = ARRAY_SIZE(msgs);
+
+    memset(msgs, 0, n * sizeof(msgs[0]));
+    for (k = 0; k < n; k++) {
+      msgs[k].msg_hdr.msg_name = (struct sockaddr*) addrs[sent + k];
+      msgs[k].msg_hdr.msg_namelen = uv__udp_addrlen(addrs[sent + k]);
+      msgs[k].msg_hdr.msg_iov = (struct iovec*) &bufs[sent + k];
+      msgs[k].msg_hdr.msg_iovlen = 1;
+    }
+
+    do
+      r = uv__sendmmsg(handle->io_watcher.fd, msgs, n, 0);
+    while (r == -1 && errno == EINTR);
+
+    if (r == -1) {
+      if (errno == ENOSYS)
+        goto fallback;  /* Kernel too old, send one at a time. */
+      goto error;
+    }
+
+    sent += r;
+
+    /* Socket buffer is full or the next message is going to fail. */
+    if ((unsigned int) r < n)
+      return sent;
+  }
+
+  return sent;
+
+fallback:
+#endif
+
+  for (; sent < nmsgs; sent++) {
+    memset(&h, 0, sizeof(h));
+    h.msg_name = (struct sockaddr*) addrs[sent];
+    h.msg_namelen = uv__udp_addrlen(addrs[sent]);
+    h.msg_iov = (struct iovec*) &bufs[sent];
+    h.msg_iovlen = 1;
+
+    do
+      r = sendmsg(handle->io_watcher.fd, &h, 0);
+    while (r == -1 && errno == EINTR);
+
+    if (r == -1)
+      goto error;
+  }
+
+  return sent;
+
+error:
+  if (sent > 0)
+    return sent;
+  if (errno == EAGAIN || errno == EWOULDBLOCK)
+    return -EAGAIN;
+  return -errno;
+}
+
+
 static int uv__udp_set_membership4(uv_udp_t* handle,
                                    const struct sockaddr_in* multicast_addr,
                                    const char* interface_addr,
@@ -631,6 +820,19 @@ int uv_udp_set_broadcast(uv_udp_t* handle, int on) {
 }
 
 
+int uv_udp_set_recvmmsg(uv_udp_t* handle, int on) {
+#if defined(__linux__)
+  if (on)
+    handle->flags |= UV_UDP_RECVMMSG;
+  else
+    handle->flags &= ~UV_UDP_RECVMMSG;
+  return 0;
+#else
+  return -ENOTSUP;
+#endif
+}
+
+
 int uv_udp_set_ttl(uv_udp_t* handle, int ttl) {
   if (ttl < 1 || ttl > 255)
     return -EINVAL;
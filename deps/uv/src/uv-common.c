@@ -239,6 +239,23 @@ int uv_udp_try_send(uv_udp_t* handle,
 }
 
 
+int uv_udp_try_send_multi(uv_udp_t* handle,
+                          const uv_buf_t bufs[],
+                          const struct sockaddr* const addrs[],
+                          unsigned int nmsgs) {
+  unsigned int i;
+
+  if (handle->type != UV_UDP || nmsgs == 0)
+    return UV_EINVAL;
+
+  for (i = 0; i < nmsgs; i++)
+    if (addrs[i]->sa_family != AF_INET && addrs[i]->sa_family != AF_INET6)
+      return UV_EINVAL;
+
+  return uv__udp_try_send_multi(handle, bufs, addrs, nmsgs);
+}
+
+
 int uv_udp_recv_start(uv_udp_t* handle,
                       uv_alloc_cb alloc_cb,
                       uv_udp_recv_cb recv_cb) {
@@ -338,6 +355,77 @@ uint64_t uv_now(const uv_loop_t* loop) {
 }
 
 
+void uv_metrics_enable(uv_loop_t* loop, int enable) {
+  /* Takes effect at the start of the next loop iteration. */
+  loop->metrics_enabled = (enable != 0);
+}
+
+
+void uv_metrics_info(const uv_loop_t* loop, uv_metrics_t* metrics) {
+  *metrics = loop->metrics;
+}
+
+
+uint64_t uv__metrics_begin(uv_loop_t* loop) {
+  if (loop->metrics_enabled == 0)
+    return 0;
+  loop->metrics.loop_count += 1;
+  return uv_hrtime();
+}
+
+
+uint64_t uv__metrics_phase(uv_loop_t* loop,
+                           uv_metrics_phase phase,
+                           uint64_t start) {
+  uint64_t now;
+
+  if (start == 0)
+    return 0;
+
+  now = uv_hrtime();
+  loop->metrics.phase_time[phase] += now - start;
+  return now;
+}
+
+
+uint64_t uv__metrics_poll(uv_loop_t* loop, uint64_t start) {
+  uint64_t wait;
+  uint64_t now;
+
+  wait = loop->metrics_poll_wait;
+  loop->metrics_poll_wait = 0;
+
+  if (start == 0)
+    return 0;
+
+  /* Everything that isn't spent waiting for events is spent on callbacks
+   * or on (re)arming the watchers.
+   */
+  now = uv_hrtime();
+  if (wait > now - start)
+    wait = now - start;
+  loop->metrics.phase_time[UV_METRICS_POLL_WAIT] += wait;
+  loop->metrics.phase_time[UV_METRICS_POLL_IO] += now - start - wait;
+  return now;
+}
+
+
+uint64_t uv__metrics_wait_begin(const uv_loop_t* loop) {
+  if (loop->metrics_enabled == 0)
+    return 0;
+  return uv_hrtime();
+}
+
+
+void uv__metrics_wait_end(uv_loop_t* loop, uint64_t start, int nevents) {
+  if (start == 0)
+    return;
+  loop->metrics_poll_wait += uv_hrtime() - start;
+  if (nevents > 0)
+    loop->metrics.events += nevents;
+}
+
+
 
 size_t uv__count_bufs(const uv_buf_t bufs[], unsigned int nbufs) {
   unsigned int i;
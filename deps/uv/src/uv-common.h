@@ -89,6 +89,11 @@ int uv__udp_try_send(uv_udp_t* handle,
                      const struct sockaddr* addr,
                      unsigned int addrlen);
 
+int uv__udp_try_send_multi(uv_udp_t* handle,
+                           const uv_buf_t bufs[],
+                           const struct sockaddr* const addrs[],
+                           unsigned int nmsgs);
+
 int uv__udp_recv_start(uv_udp_t* handle, uv_alloc_cb alloccb,
                        uv_udp_recv_cb recv_cb);
 
@@ -100,17 +105,33 @@ int uv__getaddrinfo_translate_error(int sys_err);    /* EAI_* error. */
 
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work *w,
+                     uv_work_class kind,
                      void (*work)(struct uv__work *w),
                      void (*done)(struct uv__work *w, int status));
 
 void uv__work_done(uv_async_t* handle);
 
+void uv__work_offload_begin(uv_work_class kind);
+void uv__work_offload_end(uv_work_class kind, uint64_t start, uint64_t end);
+
 size_t uv__count_bufs(const uv_buf_t bufs[], unsigned int nbufs);
 
 int uv__socket_sockopt(uv_handle_t* handle, int optname, int* value);
 
 void uv__fs_scandir_cleanup(uv_fs_t* req);
 
+/* Event loop metrics. uv__metrics_begin() returns zero when metrics are off
+ * and the other functions do nothing when passed a zero timestamp.
+ */
+uint64_t uv__metrics_begin(uv_loop_t* loop);
+uint64_t uv__metrics_phase(uv_loop_t* loop,
+                           uv_metrics_phase phase,
+                           uint64_t start);
+uint64_t uv__metrics_poll(uv_loop_t* loop, uint64_t start);
+/* For the backends, around the call that waits for events. */
+uint64_t uv__metrics_wait_begin(const uv_loop_t* loop);
+void uv__metrics_wait_end(uv_loop_t* loop, uint64_t start, int nevents);
+
 #define uv__has_active_reqs(loop)                                             \
   (QUEUE_EMPTY(&(loop)->active_reqs) == 0)
 
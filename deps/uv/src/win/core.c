@@ -139,6 +139,10 @@ int uv_loop_init(uv_loop_t* loop) {
   loop->time = 0;
   uv_update_time(loop);
 
+  loop->metrics_enabled = 0;
+  loop->metrics_poll_wait = 0;
+  memset(&loop->metrics, 0, sizeof(loop->metrics));
+
   QUEUE_INIT(&loop->wq);
   QUEUE_INIT(&loop->handle_queue);
   QUEUE_INIT(&loop->active_reqs);
@@ -302,6 +306,9 @@ static void uv_poll(uv_loop_t* loop, DWORD timeout) {
   ULONG_PTR key;
   OVERLAPPED* overlapped;
   uv_req_t* req;
+  uint64_t wait_start;
+
+  wait_start = uv__metrics_wait_begin(loop);
 
   GetQueuedCompletionStatus(loop->iocp,
                             &bytes,
@@ -310,6 +317,8 @@ static void uv_poll(uv_loop_t* loop, DWORD timeout) {
                             timeout);
 
   if (overlapped) {
+    uv__metrics_wait_end(loop, wait_start, 1);
+
     /* Package was dequeued */
     req = uv_overlapped_to_req(overlapped);
     uv_insert_pending_req(loop, req);
@@ -321,11 +330,15 @@ static void uv_poll(uv_loop_t* loop, DWORD timeout) {
   } else if (GetLastError() != WAIT_TIMEOUT) {
     /* Serious error */
     uv_fatal_error(GetLastError(), "GetQueuedCompletionStatus");
-  } else if (timeout > 0) {
-    /* GetQueuedCompletionStatus can occasionally return a little early.
-     * Make sure that the desired timeout is reflected in the loop time.
-     */
-    uv__time_forward(loop, timeout);
+  } else {
+    uv__metrics_wait_end(loop, wait_start, 0);
+
+    if (timeout > 0) {
+      /* GetQueuedCompletionStatus can occasionally return a little early.
+       * Make sure that the desired timeout is reflected in the loop time.
+       */
+      uv__time_forward(loop, timeout);
+    }
   }
 }
 
@@ -336,6 +349,9 @@ static void uv_poll_ex(uv_loop_t* loop, DWORD timeout) {
   OVERLAPPED_ENTRY overlappeds[128];
   ULONG count;
   ULONG i;
+  uint64_t wait_start;
+
+  wait_start = uv__metrics_wait_begin(loop);
 
   success = pGetQueuedCompletionStatusEx(loop->iocp,
                                          overlappeds,
@@ -345,6 +361,8 @@ static void uv_poll_ex(uv_loop_t* loop, DWORD timeout) {
                                          FALSE);
 
   if (success) {
+    uv__metrics_wait_end(loop, wait_start, (int) count);
+
     for (i = 0; i < count; i++) {
       /* Package was dequeued */
       req = uv_overlapped_to_req(overlappeds[i].lpOverlapped);
@@ -358,11 +376,15 @@ static void uv_poll_ex(uv_loop_t* loop, DWORD timeout) {
   } else if (GetLastError() != WAIT_TIMEOUT) {
     /* Serious error */
     uv_fatal_error(GetLastError(), "GetQueuedCompletionStatusEx");
-  } else if (timeout > 0) {
-    /* GetQueuedCompletionStatus can occasionally return a little early.
-     * Make sure that the desired timeout is reflected in the loop time.
-     */
-    uv__time_forward(loop, timeout);
+  } else {
+    uv__metrics_wait_end(loop, wait_start, 0);
+
+    if (timeout > 0) {
+      /* GetQueuedCompletionStatus can occasionally return a little early.
+       * Make sure that the desired timeout is reflected in the loop time.
+       */
+      uv__time_forward(loop, timeout);
+    }
   }
 }
 
@@ -381,6 +403,7 @@ int uv_loop_alive(const uv_loop_t* loop) {
 
 int uv_run(uv_loop_t *loop, uv_run_mode mode) {
   DWORD timeout;
+  uint64_t t;
   int r;
   void (*poll)(uv_loop_t* loop, DWORD timeout);
 
@@ -394,21 +417,29 @@ int uv_run(uv_loop_t *loop, uv_run_mode mode) {
     uv_update_time(loop);
 
   while (r != 0 && loop->stop_flag == 0) {
+    t = uv__metrics_begin(loop);
     uv_update_time(loop);
     uv_process_timers(loop);
+    t = uv__metrics_phase(loop, UV_METRICS_TIMERS, t);
 
+    /* This is where the I/O callbacks run on Windows. */
     uv_process_reqs(loop);
+    t = uv__metrics_phase(loop, UV_METRICS_PENDING, t);
     uv_idle_invoke(loop);
     uv_prepare_invoke(loop);
+    t = uv__metrics_phase(loop, UV_METRICS_IDLE_PREPARE, t);
 
     timeout = 0;
     if ((mode & UV_RUN_NOWAIT) == 0)
       timeout = uv_backend_timeout(loop);
 
     (*poll)(loop, timeout);
+    t = uv__metrics_poll(loop, t);
 
     uv_check_invoke(loop);
+    t = uv__metrics_phase(loop, UV_METRICS_CHECK, t);
     uv_process_endgames(loop);
+    t = uv__metrics_phase(loop, UV_METRICS_CLOSING, t);
 
     if (mode == UV_RUN_ONCE) {
       /* UV_RUN_ONCE implies forward progess: at least one callback must have
@@ -420,6 +451,7 @@ int uv_run(uv_loop_t *loop, uv_run_mode mode) {
        * the check.
        */
       uv_process_timers(loop);
+      uv__metrics_phase(loop, UV_METRICS_TIMERS, t);
     }
 
     r = uv__loop_alive(loop);
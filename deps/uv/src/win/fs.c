@@ -49,7 +49,11 @@ static const int uv__fs_dirent_slide = 0x20;
 #define QUEUE_FS_TP_JOB(loop, req)                                          \
   do {                                                                      \
     uv__req_register(loop, req);                                            \
-    uv__work_submit((loop), &(req)->work_req, uv__fs_work, uv__fs_done);    \
+    uv__work_submit((loop),                                                 \
+                    &(req)->work_req,                                       \
+                    UV_WORK_FAST_IO,                                        \
+                    uv__fs_work,                                            \
+                    uv__fs_done);                                           \
   } while (0)
 
 #define SET_REQ_RESULT(req, result_value)                                   \
@@ -342,6 +342,7 @@ int uv_getaddrinfo(uv_loop_t* loop,
 
   uv__work_submit(loop,
                   &req->work_req,
+                  UV_WORK_SLOW_IO,
                   uv__getaddrinfo_work,
                   uv__getaddrinfo_done);
 
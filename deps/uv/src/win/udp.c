@@ -751,6 +751,11 @@ int uv_udp_set_broadcast(uv_udp_t* handle, int value) {
 }
 
 
+int uv_udp_set_recvmmsg(uv_udp_t* handle, int on) {
+  return UV_ENOTSUP;
+}
+
+
 int uv_udp_open(uv_udp_t* handle, uv_os_sock_t sock) {
   WSAPROTOCOL_INFOW protocol_info;
   int opt_len;
@@ -888,3 +893,11 @@ int uv__udp_try_send(uv_udp_t* handle,
                      unsigned int addrlen) {
   return UV_ENOSYS;
 }
+
+
+int uv__udp_try_send_multi(uv_udp_t* handle,
+                           const uv_buf_t bufs[],
+                           const struct sockaddr* const addrs[],
+                           unsigned int nmsgs) {
+  return UV_ENOSYS;
+}
@@ -0,0 +1,171 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+
+#define TEST_FILE "test_file_io_uring"
+
+/* Runs a chain of asynchronous file system requests on a loop that opted in
+ * to io_uring. The results must be indistinguishable from the thread pool
+ * implementation, which is what runs when the kernel doesn't do io_uring.
+ */
+static uv_loop_t loop;
+static uv_fs_t req;
+static uv_file file;
+static char buf[32];
+static uv_buf_t iov;
+static int step;
+
+
+static void next(uv_fs_t* req);
+
+
+static void check_stat(uv_fs_t* req) {
+  uv_stat_t* s;
+  uv_fs_t sync_req;
+
+  s = req->ptr;
+  ASSERT(s == &req->statbuf);
+  ASSERT(s->st_size == 5);
+
+  ASSERT(0 == uv_fs_stat(&loop, &sync_req, TEST_FILE, NULL));
+  ASSERT(0 == memcmp(s, &sync_req.statbuf, sizeof(*s)));
+  uv_fs_req_cleanup(&sync_req);
+}
+
+
+static void next(uv_fs_t* r) {
+  ASSERT(r == &req);
+
+  switch (step++) {
+    case 0:
+      ASSERT(req.result >= 0);
+      file = req.result;
+      uv_fs_req_cleanup(&req);
+      iov = uv_buf_init("hello", 5);
+      ASSERT(0 == uv_fs_write(&loop, &req, file, &iov, 1, -1, next));
+      break;
+
+    case 1:
+      ASSERT(req.result == 5);
+      uv_fs_req_cleanup(&req);
+      ASSERT(0 == uv_fs_fsync(&loop, &req, file, next));
+      break;
+
+    case 2:
+      ASSERT(req.result == 0);
+      uv_fs_req_cleanup(&req);
+      ASSERT(0 == uv_fs_fdatasync(&loop, &req, file, next));
+      break;
+
+    case 3:
+      ASSERT(req.result == 0);
+      uv_fs_req_cleanup(&req);
+      ASSERT(0 == uv_fs_fstat(&loop, &req, file, next));
+      break;
+
+    case 4:
+      ASSERT(req.result == 0);
+      check_stat(&req);
+      uv_fs_req_cleanup(&req);
+      ASSERT(0 == uv_fs_stat(&loop, &req, TEST_FILE, next));
+      break;
+
+    case 5:
+      ASSERT(req.result == 0);
+      check_stat(&req);
+      uv_fs_req_cleanup(&req);
+      ASSERT(0 == uv_fs_lstat(&loop, &req, TEST_FILE, next));
+      break;
+
+    case 6:
+      ASSERT(req.result == 0);
+      check_stat(&req);
+      uv_fs_req_cleanup(&req);
+      memset(buf, 0, sizeof(buf));
+      iov = uv_buf_init(buf, sizeof(buf));
+      ASSERT(0 == uv_fs_read(&loop, &req, file, &iov, 1, 1, next));
+      break;
+
+    case 7:
+      ASSERT(req.result == 4);
+      ASSERT(0 == memcmp(buf, "ello", 4));
+      uv_fs_req_cleanup(&req);
+      ASSERT(0 == uv_fs_close(&loop, &req, file, next));
+      break;
+
+    case 8:
+      ASSERT(req.result == 0);
+      uv_fs_req_cleanup(&req);
+      ASSERT(0 == uv_fs_stat(&loop, &req, TEST_FILE "_missing", next));
+      break;
+
+    case 9:
+      ASSERT(req.result == UV_ENOENT);
+      ASSERT(req.ptr == NULL);
+      uv_fs_req_cleanup(&req);
+      break;
+
+    default:
+      ASSERT(0 && "unreachable");
+  }
+}
+
+
+TEST_IMPL(fs_io_uring) {
+  uv_threadpool_stats_t before;
+  uv_threadpool_stats_t after;
+  uv_fs_t unlink_req;
+
+  unlink(TEST_FILE);
+  ASSERT(0 == uv_threadpool_stats(UV_WORK_FAST_IO, &before));
+
+  ASSERT(0 == setenv("UV_USE_IO_URING", "1", 1));
+  ASSERT(0 == uv_loop_init(&loop));
+
+  ASSERT(0 == uv_fs_open(&loop,
+                         &req,
+                         TEST_FILE,
+                         O_RDWR | O_CREAT,
+                         S_IWUSR | S_IRUSR,
+                         next));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(step == 10);
+
+  /* Requests count toward the thread pool statistics either way. */
+  ASSERT(0 == uv_threadpool_stats(UV_WORK_FAST_IO, &after));
+  ASSERT(after.submitted - before.submitted == 10);
+  ASSERT(after.completed - before.completed == 10);
+  ASSERT(after.queued == 0);
+
+  ASSERT(0 == uv_loop_close(&loop));
+  ASSERT(0 == unsetenv("UV_USE_IO_URING"));
+
+  ASSERT(0 == uv_fs_unlink(uv_default_loop(), &unlink_req, TEST_FILE, NULL));
+  uv_fs_req_cleanup(&unlink_req);
+
+  return 0;
+}
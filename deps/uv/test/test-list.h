@@ -27,6 +27,7 @@ TEST_DECLARE   (run_nowait)
 TEST_DECLARE   (loop_alive)
 TEST_DECLARE   (loop_close)
 TEST_DECLARE   (loop_stop)
+TEST_DECLARE   (loop_metrics)
 TEST_DECLARE   (loop_update_time)
 TEST_DECLARE   (loop_backend_timeout)
 TEST_DECLARE   (default_loop_close)
@@ -106,6 +107,8 @@ TEST_DECLARE   (udp_options)
 TEST_DECLARE   (udp_no_autobind)
 TEST_DECLARE   (udp_open)
 TEST_DECLARE   (udp_try_send)
+TEST_DECLARE   (udp_try_send_multi)
+TEST_DECLARE   (udp_mmsg)
 TEST_DECLARE   (pipe_bind_error_addrinuse)
 TEST_DECLARE   (pipe_bind_error_addrnotavail)
 TEST_DECLARE   (pipe_bind_error_inval)
@@ -249,6 +252,8 @@ TEST_DECLARE   (fs_rename_to_existing_file)
 TEST_DECLARE   (fs_write_multiple_bufs)
 TEST_DECLARE   (threadpool_queue_work_simple)
 TEST_DECLARE   (threadpool_queue_work_einval)
+TEST_DECLARE   (threadpool_queue_work_classes)
+TEST_DECLARE   (threadpool_stats)
 TEST_DECLARE   (threadpool_multiple_event_loops)
 TEST_DECLARE   (threadpool_cancel_getaddrinfo)
 TEST_DECLARE   (threadpool_cancel_getnameinfo)
@@ -264,6 +269,11 @@ TEST_DECLARE   (dlerror)
 TEST_DECLARE   (poll_duplex)
 TEST_DECLARE   (poll_unidirectional)
 TEST_DECLARE   (poll_close)
+#ifndef _WIN32
+TEST_DECLARE   (poll_io_uring)
+TEST_DECLARE   (poll_squelch_events)
+TEST_DECLARE   (fs_io_uring)
+#endif
 
 TEST_DECLARE   (ip4_addr)
 TEST_DECLARE   (ip6_addr_link_local)
@@ -292,6 +302,9 @@ TEST_DECLARE   (closed_fd_events)
 TEST_DECLARE   (osx_select)
 TEST_DECLARE   (osx_select_many_fds)
 #endif
+#ifdef __linux__
+TEST_DECLARE   (stream_pause_resume)
+#endif
 HELPER_DECLARE (tcp4_echo_server)
 HELPER_DECLARE (tcp6_echo_server)
 HELPER_DECLARE (udp4_echo_server)
@@ -310,6 +323,7 @@ TASK_LIST_START
   TEST_ENTRY  (loop_alive)
   TEST_ENTRY  (loop_close)
   TEST_ENTRY  (loop_stop)
+  TEST_ENTRY  (loop_metrics)
   TEST_ENTRY  (loop_update_time)
   TEST_ENTRY  (loop_backend_timeout)
   TEST_ENTRY  (default_loop_close)
@@ -417,6 +431,8 @@ TASK_LIST_START
   TEST_ENTRY  (udp_multicast_join6)
   TEST_ENTRY  (udp_multicast_ttl)
   TEST_ENTRY  (udp_try_send)
+  TEST_ENTRY  (udp_try_send_multi)
+  TEST_ENTRY  (udp_mmsg)
 
   TEST_ENTRY  (udp_open)
   TEST_HELPER (udp_open, udp4_echo_server)
@@ -532,6 +548,11 @@ TASK_LIST_START
   TEST_ENTRY  (poll_duplex)
   TEST_ENTRY  (poll_unidirectional)
   TEST_ENTRY  (poll_close)
+#ifndef _WIN32
+  TEST_ENTRY  (poll_io_uring)
+  TEST_ENTRY  (poll_squelch_events)
+  TEST_ENTRY  (fs_io_uring)
+#endif
 
   TEST_ENTRY  (socket_buffer_size)
 
@@ -583,6 +604,10 @@ TASK_LIST_START
   TEST_ENTRY (osx_select_many_fds)
 #endif
 
+#ifdef __linux__
+  TEST_ENTRY  (stream_pause_resume)
+#endif
+
   TEST_ENTRY  (fs_file_noent)
   TEST_ENTRY  (fs_file_nametoolong)
   TEST_ENTRY  (fs_file_loop)
@@ -623,6 +648,8 @@ TASK_LIST_START
   TEST_ENTRY  (fs_write_multiple_bufs)
   TEST_ENTRY  (threadpool_queue_work_simple)
   TEST_ENTRY  (threadpool_queue_work_einval)
+  TEST_ENTRY  (threadpool_queue_work_classes)
+  TEST_ENTRY  (threadpool_stats)
   TEST_ENTRY  (threadpool_multiple_event_loops)
   TEST_ENTRY  (threadpool_cancel_getaddrinfo)
   TEST_ENTRY  (threadpool_cancel_getnameinfo)
@@ -0,0 +1,92 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+static uv_timer_t timer_handle;
+static uv_async_t async_handle;
+static int timer_cb_called;
+static int async_cb_called;
+
+
+static void timer_cb(uv_timer_t* handle) {
+  timer_cb_called++;
+  uv_close((uv_handle_t*) handle, NULL);
+}
+
+
+static void async_cb(uv_async_t* handle) {
+  async_cb_called++;
+  uv_close((uv_handle_t*) handle, NULL);
+}
+
+
+TEST_IMPL(loop_metrics) {
+  uv_metrics_t metrics;
+  uv_metrics_t after;
+  uv_loop_t loop;
+  int i;
+
+  ASSERT(0 == uv_loop_init(&loop));
+
+  /* Nothing is recorded until metrics are enabled. */
+  ASSERT(0 == uv_timer_init(&loop, &timer_handle));
+  ASSERT(0 == uv_timer_start(&timer_handle, timer_cb, 1, 0));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(1 == timer_cb_called);
+  uv_metrics_info(&loop, &metrics);
+  ASSERT(0 == metrics.loop_count);
+  ASSERT(0 == metrics.events);
+  for (i = 0; i < UV_METRICS_PHASE_MAX; i++)
+    ASSERT(0 == metrics.phase_time[i]);
+
+  uv_metrics_enable(&loop, 1);
+  ASSERT(0 == uv_timer_init(&loop, &timer_handle));
+  ASSERT(0 == uv_timer_start(&timer_handle, timer_cb, 50, 0));
+  ASSERT(0 == uv_async_init(&loop, &async_handle, async_cb));
+  ASSERT(0 == uv_async_send(&async_handle));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(2 == timer_cb_called);
+  ASSERT(1 == async_cb_called);
+
+  uv_metrics_info(&loop, &metrics);
+  ASSERT(metrics.loop_count >= 2);
+  ASSERT(metrics.events >= 1);
+  /* Most of the 50 ms should have been spent waiting for the timer. */
+  ASSERT(metrics.phase_time[UV_METRICS_POLL_WAIT] >= 30 * 1000 * 1000);
+  ASSERT(metrics.phase_time[UV_METRICS_POLL_WAIT] <
+         (uint64_t) 5000 * 1000 * 1000);
+
+  /* Counters stay put when metrics are disabled again. */
+  uv_metrics_enable(&loop, 0);
+  ASSERT(0 == uv_timer_init(&loop, &timer_handle));
+  ASSERT(0 == uv_timer_start(&timer_handle, timer_cb, 1, 0));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  uv_metrics_info(&loop, &after);
+  ASSERT(after.loop_count == metrics.loop_count);
+  ASSERT(after.events == metrics.events);
+
+  ASSERT(0 == uv_loop_close(&loop));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
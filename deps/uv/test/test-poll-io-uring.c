@@ -0,0 +1,136 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* More than fit in a single io_uring submission, forces intermediate
+ * flushes of the epoll_ctl ring.
+ */
+#define NUM_PAIRS 300
+
+typedef struct {
+  uv_poll_t poll[2];
+  int fds[2];
+  int nclosed;
+} pair_t;
+
+static pair_t pairs[NUM_PAIRS];
+static int ping_cb_called;
+static int pong_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  pair_t* pair;
+
+  pair = handle->data;
+  if (++pair->nclosed == 2) {
+    close(pair->fds[0]);
+    close(pair->fds[1]);
+  }
+  close_cb_called++;
+}
+
+
+static void pong_cb(uv_poll_t* handle, int status, int events) {
+  pair_t* pair;
+  char c;
+
+  ASSERT(status == 0);
+  ASSERT(events & UV_READABLE);
+  pair = handle->data;
+  ASSERT(handle == &pair->poll[1]);
+
+  ASSERT(1 == read(pair->fds[1], &c, 1));
+  ASSERT(c == 'P');
+  ASSERT(1 == write(pair->fds[1], "p", 1));
+  ASSERT(0 == uv_poll_stop(handle));
+  pong_cb_called++;
+}
+
+
+static void ping_cb(uv_poll_t* handle, int status, int events) {
+  pair_t* pair;
+  char c;
+
+  ASSERT(status == 0);
+  pair = handle->data;
+  ASSERT(handle == &pair->poll[0]);
+
+  if (events & UV_WRITABLE) {
+    /* Switch from write to read interest, that's an EPOLL_CTL_MOD. */
+    ASSERT(1 == write(pair->fds[0], "P", 1));
+    ASSERT(0 == uv_poll_start(handle, UV_READABLE, ping_cb));
+    return;
+  }
+
+  ASSERT(events & UV_READABLE);
+  ASSERT(1 == read(pair->fds[0], &c, 1));
+  ASSERT(c == 'p');
+  ping_cb_called++;
+
+  uv_close((uv_handle_t*) &pair->poll[0], close_cb);
+  uv_close((uv_handle_t*) &pair->poll[1], close_cb);
+}
+
+
+TEST_IMPL(poll_io_uring) {
+  uv_loop_t loop;
+  pair_t* pair;
+  int i;
+
+  /* Opt in before the loop is created. When the kernel doesn't support
+   * io_uring, the loop silently falls back to plain epoll_ctl().
+   */
+  ASSERT(0 == setenv("UV_USE_IO_URING", "1", 1));
+  ASSERT(0 == uv_loop_init(&loop));
+
+  for (i = 0; i < NUM_PAIRS; i++) {
+    pair = pairs + i;
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair->fds)) {
+      ASSERT(errno == EMFILE);
+      RETURN_SKIP("File descriptor limit too low.");
+    }
+    ASSERT(0 == uv_poll_init(&loop, &pair->poll[0], pair->fds[0]));
+    ASSERT(0 == uv_poll_init(&loop, &pair->poll[1], pair->fds[1]));
+    pair->poll[0].data = pair;
+    pair->poll[1].data = pair;
+    ASSERT(0 == uv_poll_start(&pair->poll[0], UV_WRITABLE, ping_cb));
+    ASSERT(0 == uv_poll_start(&pair->poll[1], UV_READABLE, pong_cb));
+  }
+
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+
+  ASSERT(ping_cb_called == NUM_PAIRS);
+  ASSERT(pong_cb_called == NUM_PAIRS);
+  ASSERT(close_cb_called == 2 * NUM_PAIRS);
+
+  ASSERT(0 == uv_loop_close(&loop));
+  ASSERT(0 == unsetenv("UV_USE_IO_URING"));
+
+  return 0;
+}
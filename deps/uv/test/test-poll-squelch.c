@@ -0,0 +1,99 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* The loop doesn't tell the kernel right away when a watcher loses
+ * interest in an event, it squelches the event when it fires. Check that
+ * callbacks don't see events they are no longer interested in.
+ */
+static uv_poll_t poll_handle;
+static uv_timer_t timer_handle;
+static int fds[2];
+static int writable_cb_called;
+static int readable_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+}
+
+
+static void poll_cb(uv_poll_t* handle, int status, int events) {
+  char c;
+
+  ASSERT(handle == &poll_handle);
+  ASSERT(status == 0);
+
+  if (events & UV_WRITABLE) {
+    /* The socket stays writable but we only want to know about readability
+     * from now on.
+     */
+    ASSERT(writable_cb_called == 0);
+    writable_cb_called++;
+    ASSERT(0 == uv_poll_start(handle, UV_READABLE, poll_cb));
+    return;
+  }
+
+  ASSERT(events == UV_READABLE);
+  ASSERT(writable_cb_called == 1);
+  ASSERT(1 == read(fds[0], &c, 1));
+  readable_cb_called++;
+
+  uv_close((uv_handle_t*) handle, close_cb);
+}
+
+
+static void timer_cb(uv_timer_t* handle) {
+  /* Give the loop a few iterations with a writable socket first. */
+  ASSERT(1 == write(fds[1], "x", 1));
+  uv_close((uv_handle_t*) handle, close_cb);
+}
+
+
+TEST_IMPL(poll_squelch_events) {
+  uv_loop_t* loop;
+
+  loop = uv_default_loop();
+  ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+  ASSERT(0 == uv_poll_init(loop, &poll_handle, fds[0]));
+  ASSERT(0 == uv_poll_start(&poll_handle,
+                            UV_READABLE | UV_WRITABLE,
+                            poll_cb));
+
+  ASSERT(0 == uv_timer_init(loop, &timer_handle));
+  ASSERT(0 == uv_timer_start(&timer_handle, timer_cb, 50, 0));
+
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT(writable_cb_called == 1);
+  ASSERT(readable_cb_called == 1);
+
+  close(fds[0]);
+  close(fds[1]);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -0,0 +1,158 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifdef __linux__
+
+/* RTLD_NEXT */
+#define _GNU_SOURCE
+
+#include "uv.h"
+#include "task.h"
+
+#include <dlfcn.h>
+#include <stdarg.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* A stream that pauses and resumes reading shouldn't cost epoll_ctl() calls
+ * when nothing comes in while it's paused, the watcher stays registered.
+ * When something does come in, the read callback mustn't see it before the
+ * stream resumes.
+ */
+#define NUM_CYCLES 100
+
+static uv_pipe_t pipe_handle;
+static uv_check_t check_handle;
+static uv_timer_t timer_handle;
+static int fds[2];
+static int cycles;
+static int paused;
+static int read_cb_called;
+static unsigned long epoll_ctl_calls;
+static unsigned long epoll_ctl_calls_before;
+
+
+/* libuv does its epoll_ctl() calls with syscall(), count them on the way
+ * through.
+ */
+long syscall(long number, ...) {
+  static long (*real_syscall)(long, ...);
+  va_list ap;
+  long a[6];
+  int i;
+
+  if (real_syscall == NULL)
+    real_syscall = (long (*)(long, ...)) dlsym(RTLD_NEXT, "syscall");
+
+  va_start(ap, number);
+  for (i = 0; i < 6; i++)
+    a[i] = va_arg(ap, long);
+  va_end(ap);
+
+  if (number == SYS_epoll_ctl)
+    epoll_ctl_calls++;
+
+  return real_syscall(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+}
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  static char slab[64];
+  *buf = uv_buf_init(slab, sizeof(slab));
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+  ASSERT(stream == (uv_stream_t*) &pipe_handle);
+  ASSERT(paused == 0);
+  ASSERT(nread == 1);
+  read_cb_called++;
+
+  /* Registered now. */
+  if (read_cb_called == 1)
+    epoll_ctl_calls_before = epoll_ctl_calls;
+
+  ASSERT(0 == uv_read_stop(stream));
+  paused = 1;
+}
+
+
+static void timer_cb(uv_timer_t* handle) {
+  /* The byte has been waiting for a few loop iterations, unnoticed. */
+  ASSERT(read_cb_called == NUM_CYCLES + 1);
+  paused = 0;
+  ASSERT(0 == uv_read_start((uv_stream_t*) &pipe_handle, alloc_cb, read_cb));
+}
+
+
+static void check_cb(uv_check_t* handle) {
+  if (paused == 0)
+    return;
+
+  if (cycles++ == NUM_CYCLES) {
+    /* Then let one come in while the stream is paused. */
+    ASSERT(epoll_ctl_calls == epoll_ctl_calls_before);
+    ASSERT(1 == write(fds[1], "x", 1));
+    ASSERT(0 == uv_timer_start(&timer_handle, timer_cb, 50, 0));
+    uv_close((uv_handle_t*) handle, close_cb);
+    return;
+  }
+
+  paused = 0;
+  ASSERT(0 == uv_read_start((uv_stream_t*) &pipe_handle, alloc_cb, read_cb));
+  ASSERT(1 == write(fds[1], "x", 1));
+}
+
+
+TEST_IMPL(stream_pause_resume) {
+  uv_loop_t* loop;
+
+  loop = uv_default_loop();
+  ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+  ASSERT(0 == uv_pipe_init(loop, &pipe_handle, 0));
+  ASSERT(0 == uv_pipe_open(&pipe_handle, fds[0]));
+  ASSERT(0 == uv_check_init(loop, &check_handle));
+  ASSERT(0 == uv_check_start(&check_handle, check_cb));
+  ASSERT(0 == uv_timer_init(loop, &timer_handle));
+
+  ASSERT(0 == uv_read_start((uv_stream_t*) &pipe_handle, alloc_cb, read_cb));
+  ASSERT(1 == write(fds[1], "x", 1));
+
+  /* Runs until the stream pauses after the last byte. */
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT(read_cb_called == NUM_CYCLES + 2);
+
+  uv_close((uv_handle_t*) &pipe_handle, close_cb);
+  uv_close((uv_handle_t*) &timer_handle, close_cb);
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  close(fds[1]);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+#endif  /* __linux__ */
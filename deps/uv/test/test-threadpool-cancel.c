@@ -68,6 +68,7 @@ static void done_cb(uv_work_t* req, int status) {
 
 static void saturate_threadpool(void) {
   uv_work_t* req;
+  int kind;
 
   ASSERT(0 == uv_cond_init(&signal_cond));
   ASSERT(0 == uv_mutex_init(&signal_mutex));
@@ -76,20 +77,28 @@ static void saturate_threadpool(void) {
   uv_mutex_lock(&signal_mutex);
   uv_mutex_lock(&wait_mutex);
 
-  for (num_threads = 0; /* empty */; num_threads++) {
-    req = malloc(sizeof(*req));
-    ASSERT(req != NULL);
-    ASSERT(0 == uv_queue_work(uv_default_loop(), req, work_cb, done_cb));
-
-    /* Expect to get signalled within 350 ms, otherwise assume that
-     * the thread pool is saturated. As with any timing dependent test,
-     * this is obviously not ideal.
-     */
-    if (uv_cond_timedwait(&signal_cond,
-                          &signal_mutex,
-                          (uint64_t) (350 * 1e6))) {
-      ASSERT(0 == uv_cancel((uv_req_t*) req));
-      break;
+  /* Every class of work has threads of its own, block all of them. */
+  num_threads = 0;
+  for (kind = 0; kind < UV_WORK_CLASS_MAX; kind++) {
+    for (;; num_threads++) {
+      req = malloc(sizeof(*req));
+      ASSERT(req != NULL);
+      ASSERT(0 == uv_queue_work_ex(uv_default_loop(),
+                                   req,
+                                   (uv_work_class) kind,
+                                   work_cb,
+                                   done_cb));
+
+      /* Expect to get signalled within 350 ms, otherwise assume that
+       * the thread pool is saturated. As with any timing dependent test,
+       * this is obviously not ideal.
+       */
+      if (uv_cond_timedwait(&signal_cond,
+                            &signal_mutex,
+                            (uint64_t) (350 * 1e6))) {
+        ASSERT(0 == uv_cancel((uv_req_t*) req));
+        break;
+      }
     }
   }
 }
@@ -102,7 +111,8 @@ static void unblock_threadpool(void) {
 
 
 static void cleanup_threadpool(void) {
-  ASSERT(done_cb_called == num_threads + 1);  /* +1 == cancelled work req. */
+  /* One cancelled work req per class of work. */
+  ASSERT(done_cb_called == num_threads + UV_WORK_CLASS_MAX);
   ASSERT(work_cb_called == num_threads);
 
   uv_cond_destroy(&signal_cond);
@@ -280,6 +290,13 @@ TEST_IMPL(threadpool_cancel_fs) {
   uv_loop_t* loop;
   unsigned n;
 
+#ifndef _WIN32
+  /* Requests that run on io_uring can't be cancelled, keep them in the
+   * thread pool.
+   */
+  ASSERT(0 == unsetenv("UV_USE_IO_URING"));
+#endif
+
   INIT_CANCEL_INFO(&ci, reqs);
   loop = uv_default_loop();
   saturate_threadpool();
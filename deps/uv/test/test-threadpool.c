@@ -74,3 +74,112 @@ TEST_IMPL(threadpool_queue_work_einval) {
   MAKE_VALGRIND_HAPPY();
   return 0;
 }
+
+
+static uv_mutex_t blocker;
+static int blocked_work_cb_count;
+static int fs_cb_count;
+
+
+static void blocked_work_cb(uv_work_t* req) {
+  uv_mutex_lock(&blocker);
+  blocked_work_cb_count++;
+  uv_mutex_unlock(&blocker);
+}
+
+
+static void blocked_after_work_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  free(req);
+}
+
+
+static void stat_cb(uv_fs_t* req) {
+  ASSERT(req->result == 0);
+  uv_fs_req_cleanup(req);
+  fs_cb_count++;
+  /* File system work completed while the CPU threads were stuck. */
+  ASSERT(blocked_work_cb_count == 0);
+  uv_mutex_unlock(&blocker);
+}
+
+
+TEST_IMPL(threadpool_queue_work_classes) {
+  uv_work_t* req;
+  uv_fs_t fs_req;
+  int i;
+
+  ASSERT(UV_EINVAL == uv_queue_work_ex(uv_default_loop(),
+                                       &work_req,
+                                       UV_WORK_CLASS_MAX,
+                                       work_cb,
+                                       after_work_cb));
+
+  ASSERT(0 == uv_mutex_init(&blocker));
+  uv_mutex_lock(&blocker);
+
+  /* More than enough to tie up every CPU thread. */
+  for (i = 0; i < 128; i++) {
+    req = malloc(sizeof(*req));
+    ASSERT(req != NULL);
+    ASSERT(0 == uv_queue_work_ex(uv_default_loop(),
+                                 req,
+                                 UV_WORK_CPU,
+                                 blocked_work_cb,
+                                 blocked_after_work_cb));
+  }
+
+  ASSERT(0 == uv_fs_stat(uv_default_loop(), &fs_req, ".", stat_cb));
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+  ASSERT(fs_cb_count == 1);
+  ASSERT(blocked_work_cb_count == 128);
+
+  uv_mutex_destroy(&blocker);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+static uint64_t histogram_sum(const uint64_t* histogram) {
+  uint64_t sum;
+  int i;
+
+  sum = 0;
+  for (i = 0; i < UV_THREADPOOL_HISTOGRAM_SIZE; i++)
+    sum += histogram[i];
+
+  return sum;
+}
+
+
+TEST_IMPL(threadpool_stats) {
+  uv_threadpool_stats_t before;
+  uv_threadpool_stats_t after;
+
+  ASSERT(UV_EINVAL == uv_threadpool_stats(UV_WORK_CLASS_MAX, &before));
+  ASSERT(0 == uv_threadpool_stats(UV_WORK_CPU, &before));
+
+  work_req.data = &data;
+  ASSERT(0 == uv_queue_work_ex(uv_default_loop(),
+                               &work_req,
+                               UV_WORK_CPU,
+                               work_cb,
+                               after_work_cb));
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+  ASSERT(after_work_cb_count == 1);
+
+  ASSERT(0 == uv_threadpool_stats(UV_WORK_CPU, &after));
+  ASSERT(after.threads > 0);
+  ASSERT(after.queued == 0);
+  ASSERT(after.submitted == before.submitted + 1);
+  ASSERT(after.completed == before.completed + 1);
+  ASSERT(after.wait_time >= before.wait_time);
+  ASSERT(after.run_time >= before.run_time);
+  ASSERT(histogram_sum(after.wait_histogram) == after.completed);
+  ASSERT(histogram_sum(after.run_histogram) == after.completed);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
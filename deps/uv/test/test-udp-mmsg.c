@@ -0,0 +1,149 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK_HANDLE(handle) \
+  ASSERT((uv_udp_t*)(handle) == &server || (uv_udp_t*)(handle) == &client)
+
+#define NUM_SENDS 8
+
+static uv_udp_t server;
+static uv_udp_t client;
+
+static int recv_cb_called;
+static int free_cb_called;
+static int close_cb_called;
+static char* slab;
+static size_t slab_size;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  CHECK_HANDLE(handle);
+  if (slab == NULL) {
+    slab = malloc(suggested_size);
+    slab_size = suggested_size;
+  }
+  ASSERT(slab != NULL);
+  ASSERT(suggested_size == slab_size);
+  buf->base = slab;
+  buf->len = slab_size;
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  CHECK_HANDLE(handle);
+  close_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* rcvbuf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  ASSERT(nread >= 0);
+
+  if (flags & UV_UDP_MMSG_FREE) {
+    ASSERT(nread == 0);
+    ASSERT(addr == NULL);
+    ASSERT(rcvbuf->base == slab);
+    free_cb_called++;
+    return;
+  }
+
+  if (nread == 0) {
+    ASSERT(addr == NULL);
+    return;
+  }
+
+  ASSERT(flags & UV_UDP_MMSG_CHUNK);
+  ASSERT(addr != NULL);
+  ASSERT(nread == 4);
+  ASSERT(rcvbuf->base >= slab && rcvbuf->base < slab + slab_size);
+  ASSERT(memcmp("PING", rcvbuf->base, nread) == 0);
+
+  if (++recv_cb_called == NUM_SENDS) {
+    uv_close((uv_handle_t*) &server, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+  }
+}
+
+
+TEST_IMPL(udp_mmsg) {
+  struct sockaddr_in addr;
+  uv_buf_t buf;
+  int i;
+  int r;
+
+  ASSERT(0 == uv_ip4_addr("0.0.0.0", TEST_PORT, &addr));
+
+  r = uv_udp_init(uv_default_loop(), &server);
+  ASSERT(r == 0);
+
+  r = uv_udp_set_recvmmsg(&server, 1);
+#if defined(__linux__)
+  ASSERT(r == 0);
+#else
+  ASSERT(r == UV_ENOTSUP);
+  uv_close((uv_handle_t*) &server, NULL);
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#endif
+
+  r = uv_udp_bind(&server, (const struct sockaddr*) &addr, 0);
+  ASSERT(r == 0);
+
+  r = uv_udp_recv_start(&server, alloc_cb, recv_cb);
+  ASSERT(r == 0);
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  r = uv_udp_init(uv_default_loop(), &client);
+  ASSERT(r == 0);
+
+  /* Queue up the datagrams before the server gets to read any of them. */
+  buf = uv_buf_init("PING", 4);
+  for (i = 0; i < NUM_SENDS; i++) {
+    r = uv_udp_try_send(&client, &buf, 1, (const struct sockaddr*) &addr);
+    ASSERT(r == 4);
+  }
+
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+  ASSERT(close_cb_called == 2);
+  ASSERT(recv_cb_called == NUM_SENDS);
+  /* All datagrams were in the socket buffer, a single batch suffices. */
+  ASSERT(free_cb_called == 1);
+
+  free(slab);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
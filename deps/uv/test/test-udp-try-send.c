@@ -34,6 +34,12 @@ TEST_IMPL(udp_try_send) {
   return 0;
 }
 
+TEST_IMPL(udp_try_send_multi) {
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
 #else  /* !_WIN32 */
 
 #define CHECK_HANDLE(handle) \
@@ -130,4 +136,69 @@ TEST_IMPL(udp_try_send) {
   return 0;
 }
 
+
+static int multi_recv_cb_called;
+
+
+static void multi_recv_cb(uv_udp_t* handle,
+                          ssize_t nread,
+                          const uv_buf_t* rcvbuf,
+                          const struct sockaddr* addr,
+                          unsigned flags) {
+  if (nread == 0) {
+    ASSERT(addr == NULL);
+    return;
+  }
+
+  ASSERT(nread == 4);
+  ASSERT(addr != NULL);
+  ASSERT(memcmp("PING", rcvbuf->base, nread) == 0);
+
+  if (++multi_recv_cb_called == 5) {
+    uv_close((uv_handle_t*) handle, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+  }
+}
+
+
+TEST_IMPL(udp_try_send_multi) {
+  const struct sockaddr* addrs[5];
+  struct sockaddr_in addr;
+  uv_buf_t bufs[5];
+  int i;
+  int r;
+
+  ASSERT(0 == uv_ip4_addr("0.0.0.0", TEST_PORT, &addr));
+
+  r = uv_udp_init(uv_default_loop(), &server);
+  ASSERT(r == 0);
+
+  r = uv_udp_bind(&server, (const struct sockaddr*) &addr, 0);
+  ASSERT(r == 0);
+
+  r = uv_udp_recv_start(&server, alloc_cb, multi_recv_cb);
+  ASSERT(r == 0);
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  r = uv_udp_init(uv_default_loop(), &client);
+  ASSERT(r == 0);
+
+  for (i = 0; i < 5; i++) {
+    bufs[i] = uv_buf_init("PING", 4);
+    addrs[i] = (const struct sockaddr*) &addr;
+  }
+
+  r = uv_udp_try_send_multi(&client, bufs, addrs, 5);
+  ASSERT(r == 5);
+
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+  ASSERT(close_cb_called == 2);
+  ASSERT(multi_recv_cb_called == 5);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
 #endif  /* !_WIN32 */
@@ -317,6 +317,7 @@
         'test/test-emfile.c',
         'test/test-fail-always.c',
         'test/test-fs.c',
+        'test/test-fs-io-uring.c',
         'test/test-fs-event.c',
         'test/test-get-currentexe.c',
         'test/test-get-memory.c',
@@ -334,6 +335,7 @@
         'test/test-loop-alive.c',
         'test/test-loop-close.c',
         'test/test-loop-stop.c',
+        'test/test-loop-metrics.c',
         'test/test-loop-time.c',
         'test/test-walk-handles.c',
         'test/test-watcher-cross-stop.c',
@@ -351,6 +353,8 @@
         'test/test-poll.c',
         'test/test-poll-close.c',
         'test/test-poll-closesocket.c',
+        'test/test-poll-io-uring.c',
+        'test/test-poll-squelch.c',
         'test/test-process-title.c',
         'test/test-ref.c',
         'test/test-run-nowait.c',
@@ -365,6 +369,7 @@
         'test/test-spawn.c',
         'test/test-fs-poll.c',
         'test/test-stdio-over-pipes.c',
+        'test/test-stream-pause.c',
         'test/test-tcp-bind-error.c',
         'test/test-tcp-bind6-error.c',
         'test/test-tcp-close.c',
@@ -412,6 +417,7 @@
         'test/test-udp-multicast-interface.c',
         'test/test-udp-multicast-interface6.c',
         'test/test-udp-try-send.c',
+        'test/test-udp-mmsg.c',
       ],
       'conditions': [
         [ 'OS=="win"', {
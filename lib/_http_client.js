@@ -478,6 +478,7 @@ function tickOnSocket(req, socket) {
     // Set default value because parser may be reused from FreeList
     parser.maxHeaderPairs = 2000;
   }
+  parser.setHeadersObject(parser.maxHeaderPairs);
 
   parser.onIncoming = parserOnIncomingClient;
   socket.on('error', socketErrorListener);
@@ -42,6 +42,7 @@ var kOnHeaders = HTTPParser.kOnHeaders | 0;
 var kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
 var kOnBody = HTTPParser.kOnBody | 0;
 var kOnMessageComplete = HTTPParser.kOnMessageComplete | 0;
+var kOnMessages = HTTPParser.kOnMessages | 0;
 
 // Only called in the slow case where slow means
 // that the request headers were either fragmented
@@ -58,7 +59,8 @@ function parserOnHeaders(headers, url) {
 }
 
 // info.headers and info.url are set only if .onHeaders()
-// has not been called for this request.
+// has not been called for this request. info.headers is an
+// object rather than an array if info.rawHeaders is set.
 //
 // info.url is not set for response parsers but that's not
 // applicable here since all our parsers are request parsers.
@@ -84,14 +86,20 @@ function parserOnHeadersComplete(info) {
   parser.incoming.httpVersion = info.versionMajor + '.' + info.versionMinor;
   parser.incoming.url = url;
 
-  var n = headers.length;
+  if (info.rawHeaders) {
+    // The parser built the headers object, see parser.setHeadersObject().
+    parser.incoming.headers = headers;
+    parser.incoming.rawHeaders = info.rawHeaders;
+  } else {
+    var n = headers.length;
 
-  // If parser.maxHeaderPairs <= 0 - assume that there're no limit
-  if (parser.maxHeaderPairs > 0) {
-    n = Math.min(n, parser.maxHeaderPairs);
-  }
+    // If parser.maxHeaderPairs <= 0 - assume that there're no limit
+    if (parser.maxHeaderPairs > 0) {
+      n = Math.min(n, parser.maxHeaderPairs);
+    }
 
-  parser.incoming._addHeaderLines(headers, n);
+    parser.incoming._addHeaderLines(headers, n);
+  }
 
   if (isNumber(info.method)) {
     // server only
@@ -165,6 +173,23 @@ function parserOnMessageComplete() {
   readStart(parser.socket);
 }
 
+// Called once per parser.execute() in batch mode, see parser.setBatchMode().
+// events is a flat list of [callback, arg, arg] triples. All onBody offsets
+// are into b, the buffer that was passed to parser.execute().
+function parserOnMessages(events, b) {
+  for (var i = 0; i < events.length; i += 3) {
+    var callback = events[i];
+    if (callback === kOnHeadersComplete)
+      parserOnHeadersComplete.call(this, events[i + 1]);
+    else if (callback === kOnBody)
+      parserOnBody.call(this, b, events[i + 1], events[i + 2]);
+    else if (callback === kOnMessageComplete)
+      parserOnMessageComplete.call(this);
+    else if (callback === kOnHeaders)
+      parserOnHeaders.call(this, events[i + 1], events[i + 2]);
+  }
+}
+
 
 var parsers = new FreeList('parsers', 1000, function() {
   var parser = new HTTPParser(HTTPParser.REQUEST);
@@ -181,6 +206,7 @@ var parsers = new FreeList('parsers', 1000, function() {
   parser[kOnHeadersComplete] = parserOnHeadersComplete;
   parser[kOnBody] = parserOnBody;
   parser[kOnMessageComplete] = parserOnMessageComplete;
+  parser[kOnMessages] = parserOnMessages;
 
   return parser;
 });
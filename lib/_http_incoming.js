@@ -23,6 +23,15 @@
 
 var util = require('util');
 var Stream = require('stream');
+var headerNames = process.binding('http_parser').HTTPParser.headerNames;
+
+// Maps the interned header names that the parser hands out to the lowercase
+// names that are the keys of IncomingMessage#headers.
+var lowerCaseHeaderNames = Object.create(null);
+for (var i = 0; i < headerNames.length; i += 2) {
+  lowerCaseHeaderNames[headerNames[i]] = headerNames[i];
+  lowerCaseHeaderNames[headerNames[i + 1]] = headerNames[i];
+}
 
 function readStart(socket) {
   if (socket && !socket._paused && socket.readable)
@@ -147,7 +156,8 @@ IncomingMessage.prototype._addHeaderLines = function(headers, n) {
 // and drop the second. Extended header fields (those beginning with 'x-') are
 // always joined.
 IncomingMessage.prototype._addHeaderLine = function(field, value, dest) {
-  field = field.toLowerCase();
+  var name = lowerCaseHeaderNames[field];
+  field = name !== undefined ? name : field.toLowerCase();
   switch (field) {
     // Array headers:
     case 'set-cookie':
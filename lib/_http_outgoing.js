@@ -27,6 +27,8 @@ var timers = require('timers');
 var util = require('util');
 
 var common = require('_http_common');
+var binding = process.binding('http_outgoing');
+var serializeResponseHead = binding.serializeResponseHead;
 
 var CRLF = common.CRLF;
 var chunkExpression = common.chunkExpression;
@@ -40,6 +42,19 @@ var contentLengthExpression = /Content-Length/i;
 var dateExpression = /Date/i;
 var expectExpression = /Expect/i;
 
+var kSendDate = binding.kSendDate | 0;
+var kShouldKeepAlive = binding.kShouldKeepAlive | 0;
+var kChunkedByDefault = binding.kChunkedByDefault | 0;
+var kHasBody = binding.kHasBody | 0;
+var kRemovedConnection = binding.kRemovedConnection | 0;
+var kRemovedTransferEncoding = binding.kRemovedTransferEncoding | 0;
+var kChunkedEncoding = binding.kChunkedEncoding | 0;
+var kHasAgent = binding.kHasAgent | 0;
+var kOutputLast = binding.kOutputLast | 0;
+var kOutputShouldKeepAlive = binding.kOutputShouldKeepAlive | 0;
+var kOutputChunkedEncoding = binding.kOutputChunkedEncoding | 0;
+var kOutputSentExpect = binding.kOutputSentExpect | 0;
+
 var automaticHeaders = {
   connection: true,
   'content-length': true,
@@ -137,6 +152,20 @@ OutgoingMessage.prototype._send = function(data, encoding, callback) {
       this.output.unshift(this._header);
       this.outputEncodings.unshift('binary');
       this.outputCallbacks.unshift(null);
+
+      // Cork the socket so the head and the first chunk go out in a single
+      // writev() rather than two writes.
+      var conn = this.connection;
+      if (data.length > 0 &&
+          conn &&
+          conn._httpMessage === this &&
+          !conn._writableState.corked) {
+        this._headerSent = true;
+        conn.cork();
+        var ret = this._writeRaw(data, encoding, callback);
+        conn.uncork();
+        return ret;
+      }
     }
     this._headerSent = true;
   }
@@ -298,6 +327,52 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
   if (state.sentExpect) this._send('');
 };
 
+// Does what _storeHeader() does for a response but builds the head in C++,
+// that is a lot faster than string concatenation and regular expressions.
+var headState = new Buffer(1);
+OutgoingMessage.prototype._storeResponseHead = function(statusCode,
+                                                         reason,
+                                                         headers) {
+  if (!util.isNumber(statusCode))
+    return this._storeHeader(statusLine(statusCode, reason), headers);
+
+  var flags = 0;
+  if (this.sendDate === true) flags |= kSendDate;
+  if (this.shouldKeepAlive) flags |= kShouldKeepAlive;
+  if (this.useChunkedEncodingByDefault) flags |= kChunkedByDefault;
+  if (this.agent) flags |= kHasAgent;
+  if (this._hasBody) flags |= kHasBody;
+  if (this._removedHeader.connection) flags |= kRemovedConnection;
+  if (this._removedHeader['transfer-encoding'])
+    flags |= kRemovedTransferEncoding;
+  if (this.chunkedEncoding) flags |= kChunkedEncoding;
+
+  var date = this.sendDate === true ? utcDate() : '';
+  var head = serializeResponseHead(headState, statusCode, reason, headers,
+                                   flags, date);
+
+  if (head === undefined) {
+    // A name or value with characters that don't fit in a byte.
+    return this._storeHeader(statusLine(statusCode, reason), headers);
+  }
+
+  var result = headState[0];
+  if (result & kOutputLast) this._last = true;
+  this.shouldKeepAlive = (result & kOutputShouldKeepAlive) !== 0;
+  this.chunkedEncoding = (result & kOutputChunkedEncoding) !== 0;
+
+  this._header = head;
+  this._headerSent = false;
+
+  // wait until the first body chunk, or close(), is sent to flush,
+  // UNLESS we're sending Expect: 100-continue.
+  if (result & kOutputSentExpect) this._send('');
+};
+
+function statusLine(statusCode, reason) {
+  return 'HTTP/1.1 ' + statusCode.toString() + ' ' + reason + CRLF;
+}
+
 function storeHeader(self, state, field, value) {
   // Protect against response splitting. The if statement is there to
   // minimize the performance impact in the common case.
@@ -204,9 +204,6 @@ ServerResponse.prototype.writeHead = function(statusCode, reason, obj) {
     headers = obj;
   }
 
-  var statusLine = 'HTTP/1.1 ' + statusCode.toString() + ' ' +
-                   this.statusMessage + CRLF;
-
   if (statusCode === 204 || statusCode === 304 ||
       (100 <= statusCode && statusCode <= 199)) {
     // RFC 2616, 10.2.5:
@@ -228,7 +225,7 @@ ServerResponse.prototype.writeHead = function(statusCode, reason, obj) {
     this.shouldKeepAlive = false;
   }
 
-  this._storeHeader(statusLine, headers);
+  this._storeResponseHead(statusCode, this.statusMessage, headers);
 };
 
 ServerResponse.prototype.writeHeader = function() {
@@ -256,6 +253,7 @@ function Server(requestListener) {
   });
 
   this.timeout = 2 * 60 * 1000;
+  this.timeoutSlack = 0;
 }
 util.inherits(Server, net.Server);
 
@@ -301,8 +299,11 @@ function connectionListener(socket) {
   // If the user has added a listener to the server,
   // request, or response, then it's their responsibility.
   // otherwise, destroy on timeout by default
-  if (self.timeout)
+  if (self.timeout) {
+    if (self.timeoutSlack)
+      socket.setTimeoutSlack(self.timeoutSlack);
     socket.setTimeout(self.timeout);
+  }
   socket.on('timeout', function() {
     var req = socket.parser && socket.parser.incoming;
     var reqTimeout = req && !req.complete && req.emit('timeout', socket);
@@ -327,6 +328,9 @@ function connectionListener(socket) {
     // Set default value because parser may be reused from FreeList
     parser.maxHeaderPairs = 2000;
   }
+  parser.setHeadersObject(parser.maxHeaderPairs);
+  // Pipelined requests that arrive in one read are delivered in one go.
+  parser.setBatchMode(true);
 
   socket.addListener('error', socketOnError);
   socket.addListener('close', serverSocketCloseListener);
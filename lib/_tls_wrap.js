@@ -322,6 +322,9 @@ TLSSocket.prototype._init = function(socket) {
          listenerCount(this.server, 'OCSPRequest') > 0)) {
       this.ssl.enableSessionCallbacks();
     }
+
+    if (options.offloadHandshake)
+      this.ssl.enableHandshakeOffload();
   } else {
     this.ssl.onhandshakestart = function() {};
     this.ssl.onhandshakedone = this._finishInit.bind(this);
@@ -331,6 +334,9 @@ TLSSocket.prototype._init = function(socket) {
       this.ssl.setSession(options.session);
   }
 
+  if (options.kernelTLS)
+    this.ssl.enableKernelTLS();
+
   this.ssl.onerror = function(err) {
     if (self._writableState.errorEmitted)
       return;
@@ -393,7 +399,8 @@ TLSSocket.prototype.renegotiate = function(options, callback) {
     this._requestCert = requestCert;
     this._rejectUnauthorized = rejectUnauthorized;
   }
-  if (!this.ssl.renegotiate()) {
+  // The kernel has the keys, OpenSSL can't do a handshake behind its back.
+  if (this.ssl.isKernelTLS() || !this.ssl.renegotiate()) {
     if (callback) {
       process.nextTick(function() {
         callback(new Error('Failed to renegotiate'));
@@ -418,6 +425,10 @@ TLSSocket.prototype.setMaxSendFragment = function setMaxSendFragment(size) {
   return this.ssl.setMaxSendFragment(size) == 1;
 };
 
+TLSSocket.prototype.isKernelTLS = function isKernelTLS() {
+  return this.ssl !== null && this.ssl.isKernelTLS();
+};
+
 TLSSocket.prototype.getTLSTicket = function getTLSTicket() {
   return this.ssl.getTLSTicket();
 };
@@ -637,6 +648,8 @@ function Server(/* [options], listener */) {
       requestCert: self.requestCert,
       rejectUnauthorized: self.rejectUnauthorized,
       handshakeTimeout: timeout,
+      offloadHandshake: self.offloadHandshake,
+      kernelTLS: self.kernelTLS,
       NPNProtocols: self.NPNProtocols,
       SNICallback: options.SNICallback || SNICallback
     });
@@ -733,6 +746,14 @@ Server.prototype.setOptions = function(options) {
   else
     this.honorCipherOrder = false;
   if (secureOptions) this.secureOptions = secureOptions;
+  if (options.offloadHandshake)
+    this.offloadHandshake = true;
+  else
+    this.offloadHandshake = false;
+  if (options.kernelTLS)
+    this.kernelTLS = true;
+  else
+    this.kernelTLS = false;
   if (options.NPNProtocols) tls.convertNPNProtocols(options.NPNProtocols, this);
   if (options.sessionIdContext) {
     this.sessionIdContext = options.sessionIdContext;
@@ -861,7 +882,8 @@ exports.connect = function(/* [port, host], options, cb */) {
       rejectUnauthorized: options.rejectUnauthorized,
       session: options.session,
       NPNProtocols: NPN.NPNProtocols,
-      requestOCSP: options.requestOCSP
+      requestOCSP: options.requestOCSP,
+      kernelTLS: options.kernelTLS
     });
     result = socket;
   }
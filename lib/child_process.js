@@ -573,8 +573,13 @@ exports.fork = function(modulePath /*, args, options*/) {
 
   // Leave stdin open for the IPC channel. stdout and stderr should be the
   // same as the parent's if silent isn't set.
-  options.stdio = options.silent ? ['pipe', 'pipe', 'pipe', 'ipc'] :
-      [0, 1, 2, 'ipc'];
+  if (util.isArray(options.stdio)) {
+    if (options.stdio.indexOf('ipc') === -1)
+      throw new TypeError('Forked processes must have an IPC channel');
+  } else {
+    options.stdio = options.silent ? ['pipe', 'pipe', 'pipe', 'ipc'] :
+        [0, 1, 2, 'ipc'];
+  }
 
   options.execPath = options.execPath || process.execPath;
 
@@ -27,8 +27,10 @@ var dgram = require('dgram');
 var fork = require('child_process').fork;
 var net = require('net');
 var util = require('util');
+var uv = process.binding('uv');
 var SCHED_NONE = 1;
 var SCHED_RR = 2;
+var SCHED_REUSEPORT = 3;
 
 var cluster = new EventEmitter;
 module.exports = cluster;
@@ -112,6 +114,46 @@ SharedHandle.prototype.remove = function(worker) {
 };
 
 
+// SO_REUSEPORT. The master binds a socket to reserve the address and to
+// resolve port 0 but it never listens on it. Every worker binds and listens
+// on a socket of its own and the kernel balances connections across them.
+function ReusePortHandle(key, address, port, addressType, backlog, fd) {
+  this.key = key;
+  this.workers = [];
+  this.handle = null;
+  this.errno = 0;
+
+  var rval = net._createServerHandle(address, port, addressType, fd, true);
+  if (util.isNumber(rval))
+    this.errno = rval;
+  else
+    this.handle = rval;
+}
+
+ReusePortHandle.prototype.add = function(worker, send) {
+  assert(this.workers.indexOf(worker) === -1);
+  this.workers.push(worker);
+  var reply = { reuseport: true, sockname: null };
+  if (this.handle) {
+    var out = {};
+    this.handle.getsockname(out);
+    reply.sockname = out;
+  }
+  send(this.errno, reply, null);
+};
+
+ReusePortHandle.prototype.remove = function(worker) {
+  // The worker may have closed its server before it exited.
+  var index = this.workers.indexOf(worker);
+  if (index === -1) return false;
+  this.workers.splice(index, 1);
+  if (this.workers.length !== 0) return false;
+  if (this.handle) this.handle.close();
+  this.handle = null;
+  return true;
+};
+
+
 // Start a round-robin server. Master accepts connections and distributes
 // them over the workers.
 function RoundRobinHandle(key, address, port, addressType, backlog, fd) {
@@ -221,7 +263,8 @@ function masterInit() {
   // XXX(bnoordhuis) Fold cluster.schedulingPolicy into cluster.settings?
   var schedulingPolicy = {
     'none': SCHED_NONE,
-    'rr': SCHED_RR
+    'rr': SCHED_RR,
+    'reuseport': SCHED_REUSEPORT
   }[process.env.NODE_CLUSTER_SCHED_POLICY];
 
   if (util.isUndefined(schedulingPolicy)) {
@@ -233,6 +276,7 @@ function masterInit() {
   cluster.schedulingPolicy = schedulingPolicy;
   cluster.SCHED_NONE = SCHED_NONE;  // Leave it to the operating system.
   cluster.SCHED_RR = SCHED_RR;      // Master distributes connections.
+  cluster.SCHED_REUSEPORT = SCHED_REUSEPORT;  // Kernel distributes them.
 
   // Keyed on address:port:etc. When a worker dies, we walk over the handles
   // and remove() the worker from each one. remove() may do a linear scan
@@ -245,7 +289,8 @@ function masterInit() {
       args: process.argv.slice(2),
       exec: process.argv[1],
       execArgv: process.execArgv,
-      silent: false
+      silent: false,
+      tlsSessionCacheSize: 0
     };
     settings = util._extend(settings, cluster.settings);
     settings = util._extend(settings, options || {});
@@ -265,7 +310,9 @@ function masterInit() {
       });
     initialized = true;
     schedulingPolicy = cluster.schedulingPolicy;  // Freeze policy.
-    assert(schedulingPolicy === SCHED_NONE || schedulingPolicy === SCHED_RR,
+    assert(schedulingPolicy === SCHED_NONE ||
+           schedulingPolicy === SCHED_RR ||
+           schedulingPolicy === SCHED_REUSEPORT,
            'Bad cluster.schedulingPolicy: ' + schedulingPolicy);
 
     var hasDebugArg = process.execArgv.some(function(argv) {
@@ -298,15 +345,35 @@ function masterInit() {
     });
   };
 
+  // TLS servers in the workers share a session cache, it is created with the
+  // first worker and lives as long as the master.
+  var sessionCacheFd = null;
+
+  function createSessionCache() {
+    var size = cluster.settings.tlsSessionCacheSize;
+    if (!process.versions.openssl || !size)
+      return -1;
+    return process.binding('crypto').createSessionCache(size);
+  }
+
   function createWorkerProcess(id, env) {
     var workerEnv = util._extend({}, process.env);
     var execArgv = cluster.settings.execArgv.slice();
     var debugPort = process.debugPort + id;
     var hasDebugArg = false;
+    var stdio = cluster.settings.silent ? ['pipe', 'pipe', 'pipe', 'ipc'] :
+                                          [0, 1, 2, 'ipc'];
 
     workerEnv = util._extend(workerEnv, env);
     workerEnv.NODE_UNIQUE_ID = '' + id;
 
+    if (sessionCacheFd === null)
+      sessionCacheFd = createSessionCache();
+    if (sessionCacheFd !== -1) {
+      workerEnv.NODE_TLS_SESSION_CACHE_FD = '' + stdio.length;
+      stdio.push(sessionCacheFd);
+    }
+
     for (var i = 0; i < execArgv.length; i++) {
       var match = execArgv[i].match(/^(--debug|--debug-brk)(=\d+)?$/);
 
@@ -321,7 +388,7 @@ function masterInit() {
 
     return fork(cluster.settings.exec, cluster.settings.args, {
       env: workerEnv,
-      silent: cluster.settings.silent,
+      stdio: stdio,
       execArgv: execArgv,
       gid: cluster.settings.gid,
       uid: cluster.settings.uid
@@ -460,20 +527,37 @@ function masterInit() {
     var handle = handles[key];
     if (util.isUndefined(handle)) {
       var constructor = RoundRobinHandle;
-      // UDP is exempt from round-robin connection balancing for what should
-      // be obvious reasons: it's connectionless. There is nothing to send to
-      // the workers except raw datagrams and that's pointless.
-      if (schedulingPolicy !== SCHED_RR ||
-          message.addressType === 'udp4' ||
-          message.addressType === 'udp6') {
+      var isTCP = message.addressType === 4 || message.addressType === 6;
+      if (schedulingPolicy === SCHED_REUSEPORT) {
+        // Only TCP sockets that the workers can bind themselves qualify.
+        if (isTCP && !(message.fd >= 0))
+          constructor = ReusePortHandle;
+        else
+          constructor = SharedHandle;
+      } else if (schedulingPolicy !== SCHED_RR ||
+                 message.addressType === 'udp4' ||
+                 message.addressType === 'udp6') {
+        // UDP is exempt from round-robin connection balancing for what should
+        // be obvious reasons: it's connectionless. There is nothing to send
+        // to the workers except raw datagrams and that's pointless.
         constructor = SharedHandle;
       }
-      handles[key] = handle = new constructor(key,
-                                              message.address,
-                                              message.port,
-                                              message.addressType,
-                                              message.backlog,
-                                              message.fd);
+      handle = new constructor(key,
+                               message.address,
+                               message.port,
+                               message.addressType,
+                               message.backlog,
+                               message.fd);
+      // No SO_REUSEPORT on this platform, let the workers share the socket.
+      if (constructor === ReusePortHandle && handle.errno === uv.UV_ENOTSUP) {
+        handle = new SharedHandle(key,
+                                  message.address,
+                                  message.port,
+                                  message.addressType,
+                                  message.backlog,
+                                  message.fd);
+      }
+      handles[key] = handle;
     }
     if (!handle.data) handle.data = message.data;
 
@@ -502,7 +586,8 @@ function masterInit() {
     cluster.emit('listening', worker, info);
   }
 
-  // Round-robin only. Server in worker is closing, remove from list.
+  // Round-robin and SO_REUSEPORT only. Server in worker is closing, remove
+  // from list.
   function close(worker, message) {
     var key = message.key;
     var handle = handles[key];
@@ -520,6 +605,13 @@ function workerInit() {
 
   // Called from src/node.js
   cluster._setupWorker = function() {
+    // See createWorkerProcess().
+    if (process.env.NODE_TLS_SESSION_CACHE_FD) {
+      var fd = parseInt(process.env.NODE_TLS_SESSION_CACHE_FD, 10);
+      delete process.env.NODE_TLS_SESSION_CACHE_FD;
+      process.binding('crypto').openSessionCache(fd);
+    }
+
     var worker = new Worker({
       id: +process.env.NODE_UNIQUE_ID | 0,
       process: process,
@@ -559,9 +651,11 @@ function workerInit() {
       if (obj._setServerData) obj._setServerData(reply.data);
 
       if (handle)
-        shared(reply, handle, cb);  // Shared listen socket.
+        shared(reply, handle, cb);    // Shared listen socket.
+      else if (reply.reuseport)
+        reuseport(reply, message, cb);  // Listen socket of our own.
       else
-        rr(reply, cb);              // Round-robin.
+        rr(reply, cb);                // Round-robin.
     });
     obj.once('listening', function() {
       cluster.worker.state = 'listening';
@@ -587,6 +681,36 @@ function workerInit() {
     cb(message.errno, handle);
   }
 
+  // SO_REUSEPORT. The worker binds and listens on its own socket, the master
+  // only tells it what port to use.
+  function reuseport(reply, message, cb) {
+    if (reply.errno)
+      return cb(reply.errno, null);
+
+    var key = reply.key;
+    var port = reply.sockname ? reply.sockname.port : message.port;
+    var rval = net._createServerHandle(message.address,
+                                       port,
+                                       message.addressType,
+                                       message.fd,
+                                       true);
+    if (util.isNumber(rval)) {
+      send({ act: 'close', key: key });
+      return cb(rval, null);
+    }
+
+    var handle = rval;
+    var close = handle.close;
+    handle.close = function() {
+      send({ act: 'close', key: key });
+      delete handles[key];
+      return close.apply(this, arguments);
+    };
+    assert(util.isUndefined(handles[key]));
+    handles[key] = handle;
+    cb(0, handle);
+  }
+
   // Round-robin. Master distributes handles across workers.
   function rr(message, cb) {
     if (message.errno)
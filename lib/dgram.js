@@ -69,6 +69,7 @@ function newHandle(type) {
     handle.lookup = lookup6;
     handle.bind = handle.bind6;
     handle.send = handle.send6;
+    handle.sendBatch = handle.sendBatch6;
     return handle;
   }
 
@@ -117,6 +118,9 @@ function Socket(type, listener) {
   // If true - UV_UDP_REUSEADDR flag will be set
   this._reuseAddr = options && options.reuseAddr;
 
+  // If true - read datagrams in batches with recvmmsg(2) where available
+  this._recvmmsg = !!(options && options.recvmmsg);
+
   if (util.isFunction(listener))
     this.on('message', listener);
 }
@@ -131,6 +135,10 @@ exports.createSocket = function(type, listener) {
 
 function startListening(socket) {
   socket._handle.onmessage = onMessage;
+  socket._handle.onmessages = onMessages;
+  // Not supported everywhere, the handle keeps calling onmessage then.
+  if (socket._recvmmsg)
+    socket._handle.setRecvmmsg(true);
   // Todo: handle errors
   socket._handle.recvStart();
   socket._receiving = true;
@@ -146,6 +154,7 @@ function replaceHandle(self, newHandle) {
   newHandle.lookup = self._handle.lookup;
   newHandle.bind = self._handle.bind;
   newHandle.send = self._handle.send;
+  newHandle.sendBatch = self._handle.sendBatch;
   newHandle.owner = self;
 
   // Replace the existing handle by the handle we got from master.
@@ -350,6 +359,146 @@ function afterSend(err) {
 }
 
 
+// Datagrams passed to sendBatch() in the same loop iteration are flushed
+// together with a single sendBatch call into the binding.
+Socket.prototype.sendBatch = function(messages, callback) {
+  var self = this;
+
+  if (!util.isArray(messages))
+    throw new TypeError('First argument must be an array.');
+
+  var batch = new Array(messages.length);
+  for (var i = 0; i < messages.length; i++) {
+    var buf = messages[i].buf;
+    if (util.isString(buf))
+      buf = new Buffer(buf);
+
+    if (!util.isBuffer(buf))
+      throw new TypeError('Message buf must be a buffer or string.');
+
+    var port = messages[i].port | 0;
+    if (port <= 0 || port > 65535)
+      throw new RangeError('Port should be > 0 and < 65536');
+
+    batch[i] = { buf: buf, port: port, address: messages[i].address };
+  }
+
+  if (!util.isFunction(callback))
+    callback = undefined;
+
+  self._healthCheck();
+
+  if (batch.length === 0) {
+    if (callback)
+      process.nextTick(function() { callback(null); });
+    return;
+  }
+
+  if (self._bindState == BIND_STATE_UNBOUND)
+    self.bind(0, null);
+
+  if (self._bindState != BIND_STATE_BOUND) {
+    self.once('listening', function() {
+      lookupBatch(self, batch, callback);
+    });
+    return;
+  }
+
+  lookupBatch(self, batch, callback);
+};
+
+
+function lookupBatch(self, batch, callback) {
+  // Resolve each distinct address only once.
+  var ips = Object.create(null);
+  var addresses = [];
+  for (var i = 0; i < batch.length; i++) {
+    var address = batch[i].address;
+    if (!(address in ips)) {
+      ips[address] = null;
+      addresses.push(address);
+    }
+  }
+
+  var pending = addresses.length;
+  var failed = false;
+
+  addresses.forEach(function(address) {
+    self._handle.lookup(address, function(ex, ip) {
+      if (failed)
+        return;
+      if (ex) {
+        failed = true;
+        if (callback) callback(ex);
+        self.emit('error', ex);
+        return;
+      }
+      ips[address] = ip;
+      if (--pending === 0)
+        enqueueBatch(self, batch, ips, callback);
+    });
+  });
+}
+
+
+function enqueueBatch(self, batch, ips, callback) {
+  if (!self._handle)
+    return;
+
+  var queue = self._batchQueue;
+  if (!queue) {
+    queue = self._batchQueue = {
+      buffers: [],
+      ports: [],
+      addresses: [],
+      callbacks: []
+    };
+    setImmediate(flushBatch, self);
+  }
+
+  for (var i = 0; i < batch.length; i++) {
+    queue.buffers.push(batch[i].buf);
+    queue.ports.push(batch[i].port);
+    queue.addresses.push(ips[batch[i].address]);
+  }
+
+  if (callback)
+    queue.callbacks.push(callback);
+}
+
+
+function flushBatch(self) {
+  var queue = self._batchQueue;
+  self._batchQueue = null;
+
+  if (!self._handle)
+    return;
+
+  var req = new SendWrap();
+  req.buffers = queue.buffers;  // Keep references alive.
+  req.callbacks = queue.callbacks;
+  req.oncomplete = afterSendBatch;
+
+  var err = self._handle.sendBatch(req,
+                                   queue.buffers,
+                                   queue.ports,
+                                   queue.addresses);
+  if (err || !req.async) {
+    process.nextTick(function() {
+      afterSendBatch.call(req, err);
+    });
+  }
+}
+
+
+function afterSendBatch(err) {
+  // Don't emit as error, same as send().
+  var ex = err ? errnoException(err, 'send') : null;
+  for (var i = 0; i < this.callbacks.length; i++)
+    this.callbacks[i](ex);
+}
+
+
 Socket.prototype.close = function() {
   this._healthCheck();
   this._stopReceiving();
@@ -474,6 +623,23 @@ function onMessage(nread, handle, buf, rinfo) {
 }
 
 
+// A batch of datagrams from recvmmsg(2). They share a single buffer,
+// ranges holds an offset and a length for each of them.
+function onMessages(count, handle, buf, ranges, addresses) {
+  var self = handle.owner;
+  for (var i = 0; i < count; i += 1) {
+    // Stop delivering if a listener closed the socket.
+    if (self._handle !== handle)
+      break;
+    var start = ranges[2 * i];
+    var end = start + ranges[2 * i + 1];
+    var rinfo = addresses[i];
+    rinfo.size = end - start; // compatibility
+    self.emit('message', buf.slice(start, end), rinfo);
+  }
+}
+
+
 Socket.prototype.ref = function() {
   if (this._handle)
     this._handle.ref();
@@ -48,6 +48,7 @@ function Server(opts, requestListener) {
   });
 
   this.timeout = 2 * 60 * 1000;
+  this.timeoutSlack = 0;
 }
 inherits(Server, tls.Server);
 exports.Server = Server;
@@ -28,12 +28,14 @@ var util = require('util');
 var assert = require('assert');
 var cares = process.binding('cares_wrap');
 var uv = process.binding('uv');
+var constants = process.binding('constants');
 var Pipe = process.binding('pipe_wrap').Pipe;
 
 var TCPConnectWrap = process.binding('tcp_wrap').TCPConnectWrap;
 var PipeConnectWrap = process.binding('pipe_wrap').PipeConnectWrap;
 var ShutdownWrap = process.binding('stream_wrap').ShutdownWrap;
 var WriteWrap = process.binding('stream_wrap').WriteWrap;
+var SendFileWrap = process.binding('stream_wrap').SendFileWrap;
 
 
 var cluster;
@@ -161,6 +163,8 @@ function Socket(options) {
   this._hadError = false;
   this._handle = null;
   this._host = null;
+  this._pendingSendFiles = 0;
+  this._timeoutSlack = 0;
 
   if (util.isNumber(options))
     options = { fd: options }; // Legacy interface.
@@ -341,7 +345,7 @@ Socket.prototype.listen = function() {
 
 Socket.prototype.setTimeout = function(msecs, callback) {
   if (msecs > 0 && isFinite(msecs)) {
-    timers.enroll(this, msecs);
+    timers.enroll(this, msecs, this._timeoutSlack);
     timers._unrefActive(this);
     if (callback) {
       this.once('timeout', callback);
@@ -355,6 +359,14 @@ Socket.prototype.setTimeout = function(msecs, callback) {
 };
 
 
+Socket.prototype.setTimeoutSlack = function(msecs) {
+  this._timeoutSlack = msecs > 0 && isFinite(msecs) ? msecs : 0;
+  // Takes effect the next time the idle timer is rearmed.
+  if (this._idleTimeout > 0)
+    this._idleSlack = this._timeoutSlack;
+};
+
+
 Socket.prototype._onTimeout = function() {
   debug('_onTimeout');
   this.emit('timeout');
@@ -711,14 +723,151 @@ Socket.prototype._writeGeneric = function(writev, data, encoding, cb) {
 
 
 Socket.prototype._writev = function(chunks, cb) {
-  this._writeGeneric(true, chunks, '', cb);
+  if (this._pendingSendFiles === 0)
+    return this._writeGeneric(true, chunks, '', cb);
+
+  // One of the chunks is a sendFile() request. Write them one at a time
+  // so the file contents end up between the right pieces of data.
+  var self = this;
+  var i = 0;
+  (function next(err) {
+    if (err || i === chunks.length)
+      return cb(err);
+    var entry = chunks[i++];
+    self._write(entry.chunk, entry.encoding, next);
+  })();
 };
 
 
 Socket.prototype._write = function(data, encoding, cb) {
-  this._writeGeneric(false, data, encoding, cb);
+  if (data._sendFile)
+    this._sendFile(data._sendFile, cb);
+  else
+    this._writeGeneric(false, data, encoding, cb);
+};
+
+
+// Queue the byte range [offset, offset + length) of file descriptor `fd`
+// for writing. It goes through the regular write queue so it stays ordered
+// with respect to write() calls, but the data itself is copied from the
+// page cache to the socket by the kernel and never enters JS land.
+Socket.prototype.sendFile = function(fd, offset, length, cb) {
+  if (!util.isNumber(fd) || fd < 0 || (fd | 0) !== fd)
+    throw new TypeError('fd must be a file descriptor');
+  if (!util.isNumber(offset) || offset < 0)
+    throw new TypeError('offset must be a non-negative number');
+  if (!util.isNumber(length) || length < 0)
+    throw new TypeError('length must be a non-negative number');
+
+  // The Writable machinery only knows about strings and buffers. Smuggle
+  // the request through as an empty buffer, _write() picks it up again.
+  var chunk = new Buffer(0);
+  chunk._sendFile = { fd: fd, offset: offset, length: length };
+  this._pendingSendFiles++;
+  return this.write(chunk, cb);
+};
+
+
+Socket.prototype._sendFile = function(file, cb) {
+  if (this._connecting) {
+    this.once('connect', function() {
+      this._sendFile(file, cb);
+    });
+    return;
+  }
+
+  timers._unrefActive(this);
+
+  if (!this._handle) {
+    this._pendingSendFiles--;
+    this._destroy(new Error('This socket is closed.'), cb);
+    return;
+  }
+
+  if (file.length === 0) {
+    this._pendingSendFiles--;
+    return cb();
+  }
+
+  if (this._handle.sendFile) {
+    var req = new SendFileWrap();
+    req.oncomplete = afterSendFile;
+    req.cb = cb;
+    var err = this._handle.sendFile(req, file.fd, file.offset, file.length);
+    if (err === 0)
+      return;
+    if (err !== uv.UV_ENOTSUP && err !== uv.UV_ENOSYS) {
+      this._pendingSendFiles--;
+      this._destroy(errnoException(err, 'sendfile'), cb);
+      return;
+    }
+  }
+
+  // TLS or some other stream that the kernel can't write to directly.
+  sendFileFallback(this, file, cb);
 };
 
+
+function afterSendFile(status, handle, req) {
+  // The handle is gone if the socket was destroyed mid-transfer.
+  if (util.isUndefined(handle))
+    return;
+
+  var self = handle.owner;
+  debug('afterSendFile', status, req.bytes);
+
+  self._pendingSendFiles--;
+  self._bytesDispatched += req.bytes;
+
+  if (self.destroyed)
+    return;
+
+  if (status < 0) {
+    self._destroy(errnoException(status, 'sendfile'), req.cb);
+    return;
+  }
+
+  timers._unrefActive(self);
+  req.cb.call(self);
+}
+
+
+var kSendFileChunkSize = 64 * 1024;
+
+function sendFileFallback(self, file, cb) {
+  var fs = require('fs');
+  var buffer = new Buffer(Math.min(file.length, kSendFileChunkSize));
+  var offset = file.offset;
+  var remaining = file.length;
+
+  function done(err) {
+    self._pendingSendFiles--;
+    if (err)
+      self._destroy(err, cb);
+    else
+      cb();
+  }
+
+  function read(err) {
+    if (err || remaining === 0)
+      return done(err);
+    var length = Math.min(remaining, buffer.length);
+    fs.read(file.fd, buffer, 0, length, offset, onread);
+  }
+
+  function onread(err, bytesRead) {
+    if (err || bytesRead === 0)  // Hit EOF before the end of the range.
+      return done(err);
+    offset += bytesRead;
+    remaining -= bytesRead;
+    // _writeGeneric() doesn't call back until the data has been handed off
+    // to the kernel so it's safe to reuse the buffer.
+    self._writeGeneric(false, buffer.slice(0, bytesRead), 'buffer', read);
+  }
+
+  read();
+}
+
 function createWriteReq(req, handle, data, encoding) {
   switch (encoding) {
     case 'binary':
@@ -1104,9 +1253,11 @@ function _listen(handle, backlog) {
   return handle.listen(backlog || 511);
 }
 
+// Set `reusePort` to bind with SO_REUSEPORT. Only meaningful for TCP.
 var createServerHandle = exports._createServerHandle =
-    function(address, port, addressType, fd) {
+    function(address, port, addressType, fd, reusePort) {
   var err = 0;
+  var flags = reusePort ? constants.UV_TCP_REUSEPORT : 0;
   // assign handle in listen, and clean up if bind or listen fails
   var handle;
 
@@ -1141,16 +1292,16 @@ var createServerHandle = exports._createServerHandle =
     debug('bind to ' + (address || 'anycast'));
     if (!address) {
       // Try binding to ipv6 first
-      err = handle.bind6('::', port);
+      err = handle.bind6('::', port, flags);
       if (err) {
         handle.close();
         // Fallback to ipv4
-        return createServerHandle('0.0.0.0', port);
+        return createServerHandle('0.0.0.0', port, 4, -1, reusePort);
       }
     } else if (addressType === 6) {
-      err = handle.bind6(address, port);
+      err = handle.bind6(address, port, flags);
     } else {
-      err = handle.bind(address, port);
+      err = handle.bind(address, port, flags);
     }
   }
 
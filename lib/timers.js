@@ -22,8 +22,8 @@
 'use strict';
 
 var Timer = process.binding('timer_wrap').Timer;
+var TimerWheel = process.binding('timer_wrap').TimerWheel;
 var L = require('_linklist');
-var assert = require('assert').ok;
 
 var kOnTimeout = Timer.kOnTimeout | 0;
 
@@ -35,127 +35,165 @@ var debug = require('util').debuglog('timer');
 
 // IDLE TIMEOUTS
 //
-// Because often many sockets will have the same idle timeout we will not
-// use one timeout watcher per item. It is too much overhead.  Instead
-// we'll use a single watcher for all sockets with the same timeout value
-// and a linked list. This technique is described in the libev manual:
-// http://pod.tst.eu/http://cvs.schmorp.de/libev/ev.pod#Be_smart_about_timeouts
-
-// Object containing all lists, timers
-// key = time in milliseconds
-// value = list
-var lists = {};
-
-// the main function - creates lists on demand and the watchers associated
-// with them.
-function insert(item, msecs) {
-  item._idleStart = Timer.now();
-  item._idleTimeout = msecs;
+// Every idle timeout is an entry in a hierarchical timing wheel that runs all
+// of them off a single uv_timer_t, see src/timer_wheel.h. Arming, rearming
+// and clearing a timeout takes constant time, no matter how many timeouts
+// there are or how different their durations are. There are two wheels, one
+// for the timeouts that keep the event loop alive and one for those that
+// don't (see _unrefActive() below.) Timeout.prototype.unref() and .ref()
+// move a timeout from one wheel to the other.
+//
+// The wheel knows timeouts by number. An item that is armed has its number
+// in ._timerId and its wheel in ._timerWheel.
 
-  if (msecs < 0) return;
+var kExpired = -2;
 
-  var list;
+var refWheel = null;
+var unrefWheel = null;
 
-  if (lists[msecs]) {
-    list = lists[msecs];
-  } else {
-    list = new Timer();
-    list.start(msecs, 0);
 
-    L.init(list);
+function TimeoutWheel(ref) {
+  this.handle = new TimerWheel();
+  this.handle.owner = this;
+  this.handle[kOnTimeout] = wheelOnTimeout;
+  if (!ref) this.handle.unref();
+  this.items = [];
+  this.freeIds = [];
+}
+
 
-    lists[msecs] = list;
-    list.msecs = msecs;
-    list[kOnTimeout] = listOnTimeout;
+// |start| is only passed by wheelMove(), see there.
+function wheelInsert(wheel, item, msecs, start) {
+  if (item._timerWheel !== wheel) {
+    wheelRemove(item);
+    var id = wheel.freeIds.length > 0 ? wheel.freeIds.pop() :
+                                        wheel.items.length;
+    wheel.items[id] = item;
+    item._timerWheel = wheel;
+    item._timerId = id;
   }
+  item._idleStart = wheel.handle.start(item._timerId,
+                                       msecs,
+                                       item._idleSlack,
+                                       start);
+}
 
-  L.append(list, item);
-  assert(!L.isEmpty(list)); // list is not empty
+
+// Moves an armed item to |wheel| without changing when it expires. The
+// expiry is computed from the original start time, with the same slack
+// rounding as when the item was armed.
+function wheelMove(wheel, item) {
+  if (!item._timerWheel || item._timerWheel === wheel) return;
+  wheelInsert(wheel, item, item._idleTimeout, item._idleStart);
 }
 
-function listOnTimeout() {
-  var msecs = this.msecs;
-  var list = this;
 
-  debug('timeout callback %d', msecs);
+function getRefWheel() {
+  if (refWheel === null)
+    refWheel = new TimeoutWheel(true);
+  return refWheel;
+}
 
-  var now = Timer.now();
-  debug('now: %s', now);
 
-  var diff, first, threw;
-  while (first = L.peek(list)) {
-    diff = now - first._idleStart;
-    if (diff < msecs) {
-      list.start(msecs - diff, 0);
-      debug('%d list wait because diff is %d', msecs, diff);
-      return;
-    } else {
-      L.remove(first);
-      assert(first !== L.peek(list));
-
-      if (!first._onTimeout) continue;
-
-      // v0.4 compatibility: if the timer callback throws and the
-      // domain or uncaughtException handler ignore the exception,
-      // other timers that expire on this tick should still run.
-      //
-      // https://github.com/joyent/node/issues/2631
-      var domain = first.domain;
-      if (domain && domain._disposed)
-        continue;
-
-      try {
-        if (domain)
-          domain.enter();
-        threw = true;
-        first._onTimeout();
-        if (domain)
-          domain.exit();
-        threw = false;
-      } finally {
-        if (threw) {
-          // We need to continue processing after domain error handling
-          // is complete, but not by using whatever domain was left over
-          // when the timeout threw its exception.
-          var oldDomain = process.domain;
-          process.domain = null;
-          process.nextTick(function() {
-            list[kOnTimeout]();
-          });
-          process.domain = oldDomain;
-        }
+function getUnrefWheel() {
+  if (unrefWheel === null) {
+    debug('unrefWheel initialized');
+    unrefWheel = new TimeoutWheel(false);
+  }
+  return unrefWheel;
+}
+
+
+function wheelRemove(item) {
+  var wheel = item._timerWheel;
+  if (wheel) {
+    wheel.handle.stop(item._timerId);
+    wheel.items[item._timerId] = null;
+    wheel.freeIds.push(item._timerId);
+  }
+  item._timerWheel = null;
+  item._timerId = -1;
+}
+
+
+function wheelOnTimeout(ids) {
+  var wheel = this.owner;
+  var items = new Array(ids.length);
+
+  debug('%d timeouts expired', ids.length);
+
+  for (var i = 0; i < ids.length; i++) {
+    var item = wheel.items[ids[i]];
+    wheel.items[ids[i]] = null;
+    wheel.freeIds.push(ids[i]);
+    item._timerWheel = null;
+    item._timerId = kExpired;
+    items[i] = item;
+  }
+
+  runTimeouts(items, 0);
+}
+
+
+function runTimeouts(items, start) {
+  var domain, item, threw;
+
+  for (var i = start; i < items.length; i++) {
+    item = items[i];
+
+    // Rearmed or cleared by one of the callbacks that ran before it.
+    if (item._timerId !== kExpired) continue;
+    item._timerId = -1;
+
+    if (!item._onTimeout) continue;
+
+    // v0.4 compatibility: if the timer callback throws and the
+    // domain or uncaughtException handler ignore the exception,
+    // other timers that expire on this tick should still run.
+    //
+    // https://github.com/joyent/node/issues/2631
+    domain = item.domain;
+    if (domain && domain._disposed)
+      continue;
+
+    try {
+      if (domain)
+        domain.enter();
+      threw = true;
+      item._onTimeout();
+      if (domain)
+        domain.exit();
+      threw = false;
+    } finally {
+      if (threw && i + 1 < items.length) {
+        // We need to continue processing after domain error handling
+        // is complete, but not by using whatever domain was left over
+        // when the timeout threw its exception.
+        var oldDomain = process.domain;
+        process.domain = null;
+        process.nextTick(runTimeouts.bind(null, items, i + 1));
+        process.domain = oldDomain;
       }
     }
   }
-
-  debug('%d list empty', msecs);
-  assert(L.isEmpty(list));
-  list.close();
-  delete lists[msecs];
 }
 
 
 var unenroll = exports.unenroll = function(item) {
-  L.remove(item);
-
-  var list = lists[item._idleTimeout];
-  // if empty then stop the watcher
   debug('unenroll');
-  if (list && L.isEmpty(list)) {
-    debug('unenroll: list empty');
-    list.close();
-    delete lists[item._idleTimeout];
-  }
+  wheelRemove(item);
   // if active is called later, then we want to make sure not to insert again
   item._idleTimeout = -1;
 };
 
 
 // Does not start the time, just sets up the members needed.
-exports.enroll = function(item, msecs) {
-  // if this item was already in a list somewhere
-  // then we should unenroll it from that
-  if (item._idleNext) unenroll(item);
+//
+// |slack| is how many milliseconds late the timeout may fire. Timeouts that
+// have slack are grouped into buckets of that size that expire all at once.
+exports.enroll = function(item, msecs, slack) {
+  // if this item was already armed then we should disarm it
+  wheelRemove(item);
 
   // Ensure that msecs fits into signed int32
   if (msecs > 0x7fffffff) {
@@ -163,7 +201,7 @@ exports.enroll = function(item, msecs) {
   }
 
   item._idleTimeout = msecs;
-  L.init(item);
+  item._idleSlack = slack > 0 ? slack : 0;
 };
 
 
@@ -171,15 +209,8 @@ exports.enroll = function(item, msecs) {
 // it will reset its timeout.
 exports.active = function(item) {
   var msecs = item._idleTimeout;
-  if (msecs >= 0) {
-    var list = lists[msecs];
-    if (!list || L.isEmpty(list)) {
-      insert(item, msecs);
-    } else {
-      item._idleStart = Timer.now();
-      L.append(list, item);
-    }
-  }
+  if (msecs >= 0)
+    wheelInsert(getRefWheel(), item, msecs);
 };
 
 
@@ -258,13 +289,11 @@ exports.setInterval = function(callback, repeat) {
     callback.apply(this, args);
     // If callback called clearInterval().
     if (timer._repeat === false) return;
-    // If timer is unref'd (or was - it's permanently removed from the list.)
-    if (this._handle) {
-      this._handle.start(repeat, 0);
-    } else {
-      timer._idleTimeout = repeat;
+    timer._idleTimeout = repeat;
+    if (timer._unrefed)
+      exports._unrefActive(timer);
+    else
       exports.active(timer);
-    }
   }
 };
 
@@ -279,43 +308,28 @@ exports.clearInterval = function(timer) {
 
 var Timeout = function(after) {
   this._idleTimeout = after;
-  this._idlePrev = this;
-  this._idleNext = this;
+  this._idleSlack = 0;
+  this._timerWheel = null;
+  this._timerId = -1;
   this._idleStart = null;
   this._onTimeout = null;
   this._repeat = false;
+  this._unrefed = false;
 };
 
 Timeout.prototype.unref = function() {
-  if (this._handle) {
-    this._handle.unref();
-  } else if (typeof(this._onTimeout) === 'function') {
-    var now = Timer.now();
-    if (!this._idleStart) this._idleStart = now;
-    var delay = this._idleStart + this._idleTimeout - now;
-    if (delay < 0) delay = 0;
-    exports.unenroll(this);
-    this._handle = new Timer();
-    this._handle[kOnTimeout] = this._onTimeout;
-    this._handle.start(delay, 0);
-    this._handle.domain = this.domain;
-    this._handle.unref();
-  }
+  this._unrefed = true;
+  wheelMove(getUnrefWheel(), this);
 };
 
 Timeout.prototype.ref = function() {
-  if (this._handle)
-    this._handle.ref();
+  this._unrefed = false;
+  wheelMove(getRefWheel(), this);
 };
 
 Timeout.prototype.close = function() {
   this._onTimeout = null;
-  if (this._handle) {
-    this._handle[kOnTimeout] = null;
-    this._handle.close();
-  } else {
-    exports.unenroll(this);
-  }
+  exports.unenroll(this);
 };
 
 
@@ -424,107 +438,9 @@ exports.clearImmediate = function(immediate) {
 // Internal APIs that need timeouts should use timers._unrefActive instead of
 // timers.active as internal timeouts shouldn't hold the loop open
 
-var unrefList, unrefTimer;
-
-
-function unrefTimeout() {
-  var now = Timer.now();
-
-  debug('unrefTimer fired');
-
-  var diff, domain, first, threw;
-  while (first = L.peek(unrefList)) {
-    diff = now - first._idleStart;
-
-    if (diff < first._idleTimeout) {
-      diff = first._idleTimeout - diff;
-      unrefTimer.start(diff, 0);
-      unrefTimer.when = now + diff;
-      debug('unrefTimer rescheudling for later');
-      return;
-    }
-
-    L.remove(first);
-
-    domain = first.domain;
-
-    if (!first._onTimeout) continue;
-    if (domain && domain._disposed) continue;
-
-    try {
-      if (domain) domain.enter();
-      threw = true;
-      debug('unreftimer firing timeout');
-      first._onTimeout();
-      threw = false;
-      if (domain)
-        domain.exit();
-    } finally {
-      if (threw) process.nextTick(unrefTimeout);
-    }
-  }
-
-  debug('unrefList is empty');
-  unrefTimer.when = -1;
-}
-
-
 exports._unrefActive = function(item) {
   var msecs = item._idleTimeout;
   if (!msecs || msecs < 0) return;
-  assert(msecs >= 0);
-
-  L.remove(item);
-
-  if (!unrefList) {
-    debug('unrefList initialized');
-    unrefList = {};
-    L.init(unrefList);
-
-    debug('unrefTimer initialized');
-    unrefTimer = new Timer();
-    unrefTimer.unref();
-    unrefTimer.when = -1;
-    unrefTimer[kOnTimeout] = unrefTimeout;
-  }
-
-  var now = Timer.now();
-  item._idleStart = now;
-
-  if (L.isEmpty(unrefList)) {
-    debug('unrefList empty');
-    L.append(unrefList, item);
-
-    unrefTimer.start(msecs, 0);
-    unrefTimer.when = now + msecs;
-    debug('unrefTimer scheduled');
-    return;
-  }
-
-  var when = now + msecs;
-
-  debug('unrefList find where we can insert');
-
-  var cur, them;
-
-  for (cur = unrefList._idlePrev; cur != unrefList; cur = cur._idlePrev) {
-    them = cur._idleStart + cur._idleTimeout;
-
-    if (when < them) {
-      debug('unrefList inserting into middle of list');
-
-      L.append(cur, item);
-
-      if (unrefTimer.when > when) {
-        debug('unrefTimer is scheduled to fire too late, reschedule');
-        unrefTimer.start(msecs, 0);
-        unrefTimer.when = when;
-      }
-
-      return;
-    }
-  }
 
-  debug('unrefList append to end');
-  L.append(unrefList, item);
+  wheelInsert(getUnrefWheel(), item, msecs);
 };
@@ -90,14 +90,17 @@
       'sources': [
         'src/debug-agent.cc',
         'src/async-wrap.cc',
+        'src/buffer_pool.cc',
         'src/fs_event_wrap.cc',
         'src/cares_wrap.cc',
         'src/handle_wrap.cc',
+        'src/latency_histogram.cc',
         'src/node.cc',
         'src/node_buffer.cc',
         'src/node_constants.cc',
         'src/node_contextify.cc',
         'src/node_file.cc',
+        'src/node_http_outgoing.cc',
         'src/node_http_parser.cc',
         'src/node_javascript.cc',
         'src/node_main.cc',
@@ -110,11 +113,13 @@
         'src/node_i18n.cc',
         'src/pipe_wrap.cc',
         'src/signal_wrap.cc',
+        'src/slab_allocator.cc',
         'src/smalloc.cc',
         'src/spawn_sync.cc',
         'src/string_bytes.cc',
         'src/stream_wrap.cc',
         'src/tcp_wrap.cc',
+        'src/timer_wheel.cc',
         'src/timer_wrap.cc',
         'src/tty_wrap.cc',
         'src/process_wrap.cc',
@@ -125,10 +130,12 @@
         'src/async-wrap-inl.h',
         'src/base-object.h',
         'src/base-object-inl.h',
+        'src/buffer_pool.h',
         'src/debug-agent.h',
         'src/env.h',
         'src/env-inl.h',
         'src/handle_wrap.h',
+        'src/latency_histogram.h',
         'src/node.h',
         'src/node_buffer.h',
         'src/node_constants.h',
@@ -143,9 +150,11 @@
         'src/node_i18n.h',
         'src/pipe_wrap.h',
         'src/queue.h',
+        'src/slab_allocator.h',
         'src/smalloc.h',
         'src/tty_wrap.h',
         'src/tcp_wrap.h',
+        'src/timer_wheel.h',
         'src/udp_wrap.h',
         'src/req_wrap.h',
         'src/string_bytes.h',
@@ -188,9 +197,11 @@
             'src/node_crypto.cc',
             'src/node_crypto_bio.cc',
             'src/node_crypto_clienthello.cc',
+            'src/node_crypto_session_cache.cc',
             'src/node_crypto.h',
             'src/node_crypto_bio.h',
             'src/node_crypto_clienthello.h',
+            'src/node_crypto_session_cache.h',
             'src/tls_wrap.cc',
             'src/tls_wrap.h'
           ],
@@ -215,6 +226,8 @@
                   ],
                 }],
               ],
+            }, {
+              'defines': [ 'NODE_SHARED_OPENSSL=1' ],
             }]]
         }, {
           'defines': [ 'HAVE_OPENSSL=0' ]
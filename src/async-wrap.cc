@@ -36,6 +36,7 @@ using v8::HandleScope;
 using v8::Integer;
 using v8::Isolate;
 using v8::Local;
+using v8::Number;
 using v8::Object;
 using v8::TryCatch;
 using v8::Value;
@@ -72,6 +73,88 @@ static void SetupHooks(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Percentiles reported by getCallbackHistogram().
+static const double kPercentiles[] = { 50, 90, 99, 99.9 };
+
+
+// Times AsyncWrap::MakeCallback() from construction to destruction and
+// records the result in the provider's histogram, if recording was on for
+// the whole call. The histograms are looked up again at the end because the
+// callback may have turned recording off and freed them.
+class CallbackTimer {
+ public:
+  CallbackTimer(Environment* env, uint32_t provider)
+      : env_(env),
+        provider_(provider),
+        start_(env->callback_histograms() == nullptr ? 0 : uv_hrtime()) {
+  }
+
+  ~CallbackTimer() {
+    LatencyHistogram* histograms = env_->callback_histograms();
+    if (start_ != 0 && histograms != nullptr)
+      histograms[provider_].Record(uv_hrtime() - start_);
+  }
+
+ private:
+  Environment* const env_;
+  const uint32_t provider_;
+  const uint64_t start_;
+
+  DISALLOW_COPY_AND_ASSIGN(CallbackTimer);
+};
+
+
+// setCallbackHistograms(on) turns recording of callback durations on or off.
+// Turning it on again discards the histograms recorded so far.
+static void SetCallbackHistograms(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  LatencyHistogram* histograms = nullptr;
+  if (args[0]->IsTrue())
+    histograms = new LatencyHistogram[AsyncWrap::PROVIDERS_LENGTH];
+  env->set_callback_histograms(histograms);
+}
+
+
+// getCallbackHistogram(provider, out) fills `out` with the number of
+// callbacks, their total, minimum and maximum duration and a selection of
+// percentiles, all in nanoseconds. Returns false when recording is off.
+static void GetCallbackHistogram(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  Isolate* isolate = env->isolate();
+
+  CHECK(args[0]->IsUint32());
+  CHECK(args[1]->IsObject());
+
+  uint32_t provider = args[0]->Uint32Value();
+  CHECK_LT(provider, AsyncWrap::PROVIDERS_LENGTH);
+
+  LatencyHistogram* histograms = env->callback_histograms();
+  if (histograms == nullptr)
+    return args.GetReturnValue().Set(false);
+
+  const LatencyHistogram& histogram = histograms[provider];
+  Local<Object> out = args[1].As<Object>();
+  out->Set(env->count_string(),
+           Number::New(isolate, static_cast<double>(histogram.count())));
+  out->Set(env->total_string(),
+           Number::New(isolate, static_cast<double>(histogram.total())));
+  out->Set(env->min_string(),
+           Number::New(isolate, static_cast<double>(histogram.min())));
+  out->Set(env->max_string(),
+           Number::New(isolate, static_cast<double>(histogram.max())));
+
+  Local<Object> percentiles = Object::New(isolate);
+  for (size_t i = 0; i < ARRAY_SIZE(kPercentiles); i += 1) {
+    uint64_t value = histogram.Percentile(kPercentiles[i]);
+    percentiles->Set(Number::New(isolate, kPercentiles[i]),
+                     Number::New(isolate, static_cast<double>(value)));
+  }
+  out->Set(env->percentiles_string(), percentiles);
+
+  args.GetReturnValue().Set(true);
+}
+
+
 static void Initialize(Handle<Object> target,
                 Handle<Value> unused,
                 Handle<Context> context) {
@@ -80,6 +163,8 @@ static void Initialize(Handle<Object> target,
   HandleScope scope(isolate);
 
   NODE_SET_METHOD(target, "setupHooks", SetupHooks);
+  NODE_SET_METHOD(target, "setCallbackHistograms", SetCallbackHistograms);
+  NODE_SET_METHOD(target, "getCallbackHistogram", GetCallbackHistogram);
 
   Local<Object> async_providers = Object::New(isolate);
 #define V(PROVIDER)                                                           \
@@ -96,6 +181,10 @@ Handle<Value> AsyncWrap::MakeCallback(const Handle<Function> cb,
                                       Handle<Value>* argv) {
   CHECK(env()->context() == env()->isolate()->GetCurrentContext());
 
+  // Includes the time spent in the domain and async hooks and in draining
+  // the nextTick queue. Nested calls are counted in the outer call, too.
+  CallbackTimer timer(env(), provider_type());
+
   Local<Object> context = object();
   Local<Object> process = env()->process_object();
   Local<Object> domain;
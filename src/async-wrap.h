@@ -59,6 +59,7 @@ class AsyncWrap : public BaseObject {
     PROVIDER_ ## PROVIDER,
     NODE_ASYNC_PROVIDER_TYPES(V)
 #undef V
+    PROVIDERS_LENGTH
   };
 
   inline AsyncWrap(Environment* env,
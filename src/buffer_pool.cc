@@ -0,0 +1,78 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "buffer_pool.h"
+#include "util.h"
+#include "util-inl.h"
+
+namespace node {
+
+BufferPool::BufferPool(size_t block_size, size_t max_free)
+    : block_size_(block_size),
+      max_free_(max_free),
+      free_list_(nullptr),
+      blocks_free_(0) {
+  CHECK_GE(block_size_, sizeof(FreeBlock));
+  CHECK_EQ(0, uv_mutex_init(&mutex_));
+}
+
+
+BufferPool::~BufferPool() {
+  while (free_list_ != nullptr) {
+    FreeBlock* block = free_list_;
+    free_list_ = block->next;
+    delete[] reinterpret_cast<char*>(block);
+  }
+  uv_mutex_destroy(&mutex_);
+}
+
+
+char* BufferPool::Allocate() {
+  uv_mutex_lock(&mutex_);
+  FreeBlock* block = free_list_;
+  if (block != nullptr) {
+    free_list_ = block->next;
+    blocks_free_ -= 1;
+  }
+  uv_mutex_unlock(&mutex_);
+
+  if (block == nullptr)
+    return new char[block_size_];
+  return reinterpret_cast<char*>(block);
+}
+
+
+void BufferPool::Free(char* data) {
+  uv_mutex_lock(&mutex_);
+  bool cache = blocks_free_ < max_free_;
+  if (cache) {
+    FreeBlock* block = reinterpret_cast<FreeBlock*>(data);
+    block->next = free_list_;
+    free_list_ = block;
+    blocks_free_ += 1;
+  }
+  uv_mutex_unlock(&mutex_);
+
+  if (!cache)
+    delete[] data;
+}
+
+}  // namespace node
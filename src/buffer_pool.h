@@ -0,0 +1,70 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_BUFFER_POOL_H_
+#define SRC_BUFFER_POOL_H_
+
+#include "util.h"
+#include "uv.h"
+
+#include <stddef.h>
+
+namespace node {
+
+// A free list of equally sized blocks. TLS connections draw the buffers of
+// their NodeBIOs from it and hand them back as soon as the BIO drains, so an
+// idle connection holds no buffer memory and a busy one doesn't pay for a
+// malloc() every time it wakes up. At most |max_free| blocks are cached, the
+// rest goes back to the system.
+//
+// The pool is thread-safe, handshakes that are offloaded to the threadpool
+// use it too.
+class BufferPool {
+ public:
+  static const size_t kDefaultBlockSize = 16 * 1024;
+  static const size_t kDefaultMaxFree = 128;
+
+  explicit BufferPool(size_t block_size = kDefaultBlockSize,
+                      size_t max_free = kDefaultMaxFree);
+  ~BufferPool();
+
+  char* Allocate();
+  void Free(char* block);
+
+  inline size_t block_size() const { return block_size_; }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  const size_t block_size_;
+  const size_t max_free_;
+  uv_mutex_t mutex_;
+  FreeBlock* free_list_;
+  size_t blocks_free_;
+
+  DISALLOW_COPY_AND_ASSIGN(BufferPool);
+};
+
+}  // namespace node
+
+#endif  // SRC_BUFFER_POOL_H_
@@ -184,6 +184,7 @@ inline Environment::Environment(v8::Local<v8::Context> context,
                                 uv_loop_t* loop)
     : isolate_(context->GetIsolate()),
       isolate_data_(IsolateData::GetOrCreate(context->GetIsolate(), loop)),
+      callback_histograms_(nullptr),
       using_smalloc_alloc_cb_(false),
       using_domains_(false),
       printed_error_(false),
@@ -209,6 +210,7 @@ inline Environment::~Environment() {
 #define V(PropertyName, TypeName) PropertyName ## _.Reset();
   ENVIRONMENT_STRONG_PERSISTENT_PROPERTIES(V)
 #undef V
+  delete[] callback_histograms_;
   isolate_data()->Put();
 }
 
@@ -348,6 +350,23 @@ inline ares_task_list* Environment::cares_task_list() {
   return &cares_task_list_;
 }
 
+inline SlabAllocator* Environment::read_slab_allocator() {
+  return &read_slab_allocator_;
+}
+
+inline BufferPool* Environment::tls_buffer_pool() {
+  return &tls_buffer_pool_;
+}
+
+inline LatencyHistogram* Environment::callback_histograms() const {
+  return callback_histograms_;
+}
+
+inline void Environment::set_callback_histograms(LatencyHistogram* value) {
+  delete[] callback_histograms_;
+  callback_histograms_ = value;
+}
+
 inline Environment::IsolateData* Environment::isolate_data() const {
   return isolate_data_;
 }
@@ -23,7 +23,10 @@
 #define SRC_ENV_H_
 
 #include "ares.h"
+#include "buffer_pool.h"
 #include "debug-agent.h"
+#include "latency_histogram.h"
+#include "slab_allocator.h"
 #include "tree.h"
 #include "util.h"
 #include "uv.h"
@@ -71,13 +74,18 @@ namespace node {
   V(blksize_string, "blksize")                                                \
   V(blocks_string, "blocks")                                                  \
   V(buffer_string, "buffer")                                                  \
+  V(buffers_string, "buffers")                                                \
   V(bytes_string, "bytes")                                                    \
   V(bytes_parsed_string, "bytesParsed")                                       \
   V(callback_string, "callback")                                              \
   V(change_string, "change")                                                  \
   V(close_string, "close")                                                    \
   V(code_string, "code")                                                      \
+  V(comma_space_string, ", ")                                                 \
   V(compare_string, "compare")                                                \
+  V(completed_string, "completed")                                            \
+  V(copies_string, "copies")                                                  \
+  V(count_string, "count")                                                    \
   V(ctime_string, "ctime")                                                    \
   V(cwd_string, "cwd")                                                        \
   V(debug_port_string, "debugPort")                                           \
@@ -133,9 +141,11 @@ namespace node {
   V(kill_signal_string, "killSignal")                                         \
   V(mac_string, "mac")                                                        \
   V(mark_sweep_compact_string, "mark-sweep-compact")                          \
+  V(max_string, "max")                                                        \
   V(max_buffer_string, "maxBuffer")                                           \
   V(message_string, "message")                                                \
   V(method_string, "method")                                                  \
+  V(min_string, "min")                                                        \
   V(minttl_string, "minttl")                                                  \
   V(mode_string, "mode")                                                      \
   V(model_string, "model")                                                    \
@@ -159,6 +169,7 @@ namespace node {
   V(onhandshakedone_string, "onhandshakedone")                                \
   V(onhandshakestart_string, "onhandshakestart")                              \
   V(onmessage_string, "onmessage")                                            \
+  V(onmessages_string, "onmessages")                                          \
   V(onnewsession_string, "onnewsession")                                      \
   V(onnewsessiondone_string, "onnewsessiondone")                              \
   V(onocspresponse_string, "onocspresponse")                                  \
@@ -172,6 +183,7 @@ namespace node {
   V(parse_error_string, "Parse Error")                                        \
   V(path_string, "path")                                                      \
   V(pbkdf2_error_string, "PBKDF2 Error")                                      \
+  V(percentiles_string, "percentiles")                                        \
   V(pid_string, "pid")                                                        \
   V(pipe_string, "pipe")                                                      \
   V(port_string, "port")                                                      \
@@ -179,6 +191,8 @@ namespace node {
   V(priority_string, "priority")                                              \
   V(processed_string, "processed")                                            \
   V(prototype_string, "prototype")                                            \
+  V(queued_string, "queued")                                                  \
+  V(raw_headers_string, "rawHeaders")                                         \
   V(raw_string, "raw")                                                        \
   V(rdev_string, "rdev")                                                      \
   V(readable_string, "readable")                                              \
@@ -189,6 +203,8 @@ namespace node {
   V(replacement_string, "replacement")                                        \
   V(retry_string, "retry")                                                    \
   V(rss_string, "rss")                                                        \
+  V(run_histogram_string, "runHistogram")                                     \
+  V(run_time_string, "runTime")                                               \
   V(serial_string, "serial")                                                  \
   V(scavenge_string, "scavenge")                                              \
   V(scopeid_string, "scopeid")                                                \
@@ -200,6 +216,7 @@ namespace node {
   V(should_keep_alive_string, "shouldKeepAlive")                              \
   V(signal_string, "signal")                                                  \
   V(size_string, "size")                                                      \
+  V(slabs_string, "slabs")                                                    \
   V(smalloc_p_string, "_smalloc_p")                                           \
   V(sni_context_err_string, "Invalid SNI context")                            \
   V(sni_context_string, "sni_context")                                        \
@@ -211,8 +228,10 @@ namespace node {
   V(stdio_string, "stdio")                                                    \
   V(subject_string, "subject")                                                \
   V(subjectaltname_string, "subjectaltname")                                  \
+  V(submitted_string, "submitted")                                            \
   V(sys_string, "sys")                                                        \
   V(syscall_string, "syscall")                                                \
+  V(threads_string, "threads")                                                \
   V(tick_callback_string, "_tickCallback")                                    \
   V(tick_domain_cb_string, "_tickDomainCallback")                             \
   V(timeout_string, "timeout")                                                \
@@ -224,6 +243,7 @@ namespace node {
   V(tls_sni_string, "tls_sni")                                                \
   V(tls_string, "tls")                                                        \
   V(tls_ticket_string, "tlsTicket")                                           \
+  V(total_string, "total")                                                    \
   V(total_heap_size_executable_string, "total_heap_size_executable")          \
   V(total_heap_size_string, "total_heap_size")                                \
   V(total_physical_size_string, "total_physical_size")                        \
@@ -241,6 +261,8 @@ namespace node {
   V(version_major_string, "versionMajor")                                     \
   V(version_minor_string, "versionMinor")                                     \
   V(version_string, "version")                                                \
+  V(wait_histogram_string, "waitHistogram")                                   \
+  V(wait_time_string, "waitTime")                                             \
   V(weight_string, "weight")                                                  \
   V(windows_verbatim_arguments_string, "windowsVerbatimArguments")            \
   V(wrap_string, "wrap")                                                      \
@@ -258,6 +280,7 @@ namespace node {
   V(context, v8::Context)                                                     \
   V(domain_array, v8::Array)                                                  \
   V(fs_stats_constructor_function, v8::Function)                              \
+  V(http_header_names_array, v8::Array)                                       \
   V(module_load_list_array, v8::Array)                                        \
   V(pipe_constructor_template, v8::FunctionTemplate)                          \
   V(process_object, v8::Object)                                               \
@@ -423,6 +446,14 @@ class Environment {
   inline ares_channel* cares_channel_ptr();
   inline ares_task_list* cares_task_list();
 
+  inline SlabAllocator* read_slab_allocator();
+  inline BufferPool* tls_buffer_pool();
+
+  // Callback durations recorded by AsyncWrap::MakeCallback(), one histogram
+  // per provider type. nullptr while recording is off.
+  inline LatencyHistogram* callback_histograms() const;
+  inline void set_callback_histograms(LatencyHistogram* value);
+
   inline bool using_smalloc_alloc_cb() const;
   inline void set_using_smalloc_alloc_cb(bool value);
 
@@ -510,6 +541,9 @@ class Environment {
   uv_timer_t cares_timer_handle_;
   ares_channel cares_channel_;
   ares_task_list cares_task_list_;
+  SlabAllocator read_slab_allocator_;
+  BufferPool tls_buffer_pool_;
+  LatencyHistogram* callback_histograms_;
   bool using_smalloc_alloc_cb_;
   bool using_domains_;
   bool printed_error_;
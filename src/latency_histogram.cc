@@ -0,0 +1,118 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "latency_histogram.h"
+
+#include <string.h>
+
+namespace node {
+
+static inline unsigned HighestBit(uint64_t value) {
+#if defined(__GNUC__)
+  return 63 - __builtin_clzll(value);
+#else
+  unsigned bit = 0;
+  while (value >>= 1)
+    bit += 1;
+  return bit;
+#endif
+}
+
+
+LatencyHistogram::LatencyHistogram() {
+  Reset();
+}
+
+
+void LatencyHistogram::Record(uint64_t value) {
+  counts_[IndexOf(value)] += 1;
+  count_ += 1;
+  total_ += value;
+  if (value < min_)
+    min_ = value;
+  if (value > max_)
+    max_ = value;
+}
+
+
+void LatencyHistogram::Reset() {
+  memset(counts_, 0, sizeof(counts_));
+  count_ = 0;
+  total_ = 0;
+  min_ = static_cast<uint64_t>(-1);
+  max_ = 0;
+}
+
+
+uint64_t LatencyHistogram::Percentile(double percentile) const {
+  if (count_ == 0)
+    return 0;
+  if (percentile <= 0)
+    return min();
+
+  uint64_t rank = static_cast<uint64_t>(percentile / 100 * count_ + 0.5);
+  if (rank < 1)
+    rank = 1;
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; i += 1) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      uint64_t value = UpperBound(i);
+      return value < max_ ? value : max_;
+    }
+  }
+
+  return max_;
+}
+
+
+size_t LatencyHistogram::IndexOf(uint64_t value) {
+  if (value < kSubBuckets)
+    return static_cast<size_t>(value);
+
+  unsigned bit = HighestBit(value);
+  if (bit >= kMaxBits)
+    return kBuckets - 1;
+
+  size_t base = (bit - kSubBucketBits + 1) * kSubBuckets;
+  size_t sub = (value >> (bit - kSubBucketBits)) & (kSubBuckets - 1);
+  return base + sub;
+}
+
+
+uint64_t LatencyHistogram::LowerBound(size_t index) {
+  if (index < kSubBuckets)
+    return index;
+
+  unsigned bit = index / kSubBuckets + kSubBucketBits - 1;
+  uint64_t sub = index % kSubBuckets;
+  return (kSubBuckets + sub) << (bit - kSubBucketBits);
+}
+
+
+uint64_t LatencyHistogram::UpperBound(size_t index) {
+  if (index + 1 >= kBuckets)
+    return static_cast<uint64_t>(-1);
+  return LowerBound(index + 1) - 1;
+}
+
+}  // namespace node
@@ -0,0 +1,76 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_LATENCY_HISTOGRAM_H_
+#define SRC_LATENCY_HISTOGRAM_H_
+
+#include "util.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+
+// Log-linear histogram in the style of HdrHistogram. Values below
+// kSubBuckets are counted exactly; larger values are counted in one of
+// kSubBuckets linear sub-buckets per power of two, which bounds the relative
+// error to 1 / kSubBuckets. Recording is a couple of shifts and an increment,
+// cheap enough for hot paths. Values of 2^kMaxBits and up are counted in the
+// last bucket.
+class LatencyHistogram {
+ public:
+  static const unsigned kSubBucketBits = 3;
+  static const unsigned kSubBuckets = 1 << kSubBucketBits;
+  static const unsigned kMaxBits = 40;
+  static const size_t kBuckets = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+  LatencyHistogram();
+
+  void Record(uint64_t value);
+  void Reset();
+
+  // The smallest recorded value that is larger than or equal to |percentile|
+  // percent of all recorded values, rounded up to the bucket's upper bound.
+  uint64_t Percentile(double percentile) const;
+
+  static size_t IndexOf(uint64_t value);
+  static uint64_t LowerBound(size_t index);
+  static uint64_t UpperBound(size_t index);
+
+  inline uint64_t bucket(size_t index) const { return counts_[index]; }
+  inline uint64_t count() const { return count_; }
+  inline uint64_t total() const { return total_; }
+  inline uint64_t min() const { return count_ == 0 ? 0 : min_; }
+  inline uint64_t max() const { return max_; }
+
+ private:
+  uint64_t counts_[kBuckets];
+  uint64_t count_;
+  uint64_t total_;
+  uint64_t min_;
+  uint64_t max_;
+
+  DISALLOW_COPY_AND_ASSIGN(LatencyHistogram);
+};
+
+}  // namespace node
+
+#endif  // SRC_LATENCY_HISTOGRAM_H_
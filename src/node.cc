@@ -3681,6 +3681,10 @@ int Start(int argc, char** argv) {
     if (use_debug_agent)
       EnableDebug(env);
 
+    // Two clock reads per loop phase, cheap enough to leave on for
+    // process.eventLoopUsage().
+    uv_metrics_enable(env->event_loop(), 1);
+
     bool more;
     do {
       more = uv_run(env->event_loop(), UV_RUN_ONCE);
@@ -55,6 +55,8 @@
     startup.processStdio();
     startup.processKillAndExit();
     startup.processSignalHandlers();
+    startup.processThreadpoolUsage();
+    startup.processEventLoopUsage();
 
     // Do not initialize channel in debugger agent, it deletes env variable
     // and the main thread won't see it.
@@ -700,6 +702,53 @@
   };
 
 
+  startup.processThreadpoolUsage = function() {
+    process.threadpoolUsage = function() {
+      var uv = process.binding('uv');
+      var classes = {
+        fastIO: uv.UV_WORK_FAST_IO,
+        slowIO: uv.UV_WORK_SLOW_IO,
+        cpu: uv.UV_WORK_CPU
+      };
+      var usage = {};
+      Object.keys(classes).forEach(function(name) {
+        var stats = {};
+        var err = uv.getThreadpoolStats(classes[name], stats);
+        if (err) {
+          var errnoException = NativeModule.require('util')._errnoException;
+          throw errnoException(err, 'uv_threadpool_stats');
+        }
+        usage[name] = stats;
+      });
+      return usage;
+    };
+  };
+
+
+  startup.processEventLoopUsage = function() {
+    var phases = ['timers', 'pending', 'idlePrepare', 'pollWait', 'pollIO',
+                  'check', 'closing'];
+    var metrics = new Array(2 + phases.length);
+
+    process.eventLoopUsage = function() {
+      process.binding('uv').getLoopMetrics(metrics);
+      var usage = {
+        iterations: metrics[0],
+        events: metrics[1],
+        idle: metrics[2 + phases.indexOf('pollWait')],
+        active: 0,
+        phases: {}
+      };
+      for (var i = 0; i < phases.length; i += 1) {
+        usage.phases[phases[i]] = metrics[2 + i];
+        if (phases[i] !== 'pollWait')
+          usage.active += metrics[2 + i];
+      }
+      return usage;
+    };
+  };
+
+
   startup.processChannel = function() {
     // If we were spawned with env NODE_CHANNEL_FD then load that up and
     // start parsing data from that stream.
@@ -1127,6 +1127,7 @@ void DefineSystemConstants(Handle<Object> target) {
 
 void DefineUVConstants(Handle<Object> target) {
   NODE_DEFINE_CONSTANT(target, UV_UDP_REUSEADDR);
+  NODE_DEFINE_CONSTANT(target, UV_TCP_REUSEPORT);
 }
 
 void DefineConstants(Handle<Object> target) {
@@ -24,6 +24,7 @@
 #include "node_crypto.h"
 #include "node_crypto_bio.h"
 #include "node_crypto_groups.h"
+#include "node_crypto_session_cache.h"
 #include "tls_wrap.h"  // TLSCallbacks
 
 #include "async-wrap.h"
@@ -116,6 +117,9 @@ const char* const root_certs[] = {
 
 X509_STORE* root_cert_store;
 
+// Shared with the other cluster workers, see OpenSessionCache().
+static SessionCache* session_cache;
+
 // Just to generate static methods
 template class SSLWrap<TLSCallbacks>;
 template void SSLWrap<TLSCallbacks>::AddMethods(Environment* env,
@@ -1047,9 +1051,22 @@ SSL_SESSION* SSLWrap<Base>::GetSessionCallback(SSL* s,
                                                int* copy) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
 
+  // |w| is nullptr while the handshake runs on the threadpool, such
+  // connections have neither a session to load nor session callbacks. See
+  // TLSCallbacks::OffloadHandshake().
   *copy = 0;
-  SSL_SESSION* sess = w->next_sess_;
-  w->next_sess_ = nullptr;
+  SSL_SESSION* sess = nullptr;
+  if (w != nullptr) {
+    sess = w->next_sess_;
+    w->next_sess_ = nullptr;
+  }
+
+  // The session cache stands in for the 'resumeSession' event.
+  if (sess == nullptr &&
+      (w == nullptr || !w->session_callbacks_) &&
+      session_cache != nullptr) {
+    sess = session_cache->Get(s, key, len);
+  }
 
   return sess;
 }
@@ -1058,13 +1075,19 @@ SSL_SESSION* SSLWrap<Base>::GetSessionCallback(SSL* s,
 template <class Base>
 int SSLWrap<Base>::NewSessionCallback(SSL* s, SSL_SESSION* sess) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
+
+  // Checked before touching V8, the callback can run on the threadpool when
+  // the handshake is offloaded. |w| is nullptr then, see GetSessionCallback().
+  if (w == nullptr || !w->session_callbacks_) {
+    if (session_cache != nullptr)
+      session_cache->Add(s, sess);
+    return 0;
+  }
+
   Environment* env = w->ssl_env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
-  if (!w->session_callbacks_)
-    return 0;
-
   // Check if session is small enough to be stored
   int size = i2d_SSL_SESSION(sess, nullptr);
   if (size > SecureContext::kMaxSessionSize)
@@ -1617,6 +1640,8 @@ void SSLWrap<Base>::SetMaxSendFragment(
   Base* w = Unwrap<Base>(args.Holder());
 
   int rv = SSL_set_max_send_fragment(w->ssl_, args[0]->Int32Value());
+  if (rv == 1)
+    w->max_send_fragment_set_ = true;
   args.GetReturnValue().Set(rv);
 }
 #endif  // SSL_set_max_send_fragment
@@ -1719,20 +1744,23 @@ int SSLWrap<Base>::AdvertiseNextProtoCallback(SSL* s,
                                               unsigned int* len,
                                               void* arg) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
-  Environment* env = w->env();
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
 
-  if (w->npn_protos_.IsEmpty()) {
+  // |w| is nullptr on the threadpool, see GetSessionCallback().
+  if (w == nullptr || w->npn_protos_.IsEmpty()) {
     // No initialization - no NPN protocols
     *data = reinterpret_cast<const unsigned char*>("");
     *len = 0;
-  } else {
-    Local<Object> obj = PersistentToLocal(env->isolate(), w->npn_protos_);
-    *data = reinterpret_cast<const unsigned char*>(Buffer::Data(obj));
-    *len = Buffer::Length(obj);
+    return SSL_TLSEXT_ERR_OK;
   }
 
+  Environment* env = w->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  Local<Object> obj = PersistentToLocal(env->isolate(), w->npn_protos_);
+  *data = reinterpret_cast<const unsigned char*>(Buffer::Data(obj));
+  *len = Buffer::Length(obj);
+
   return SSL_TLSEXT_ERR_OK;
 }
 
@@ -1833,6 +1861,11 @@ void SSLWrap<Base>::SetNPNProtocols(const FunctionCallbackInfo<Value>& args) {
 template <class Base>
 int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
+
+  // Server without a response, don't touch V8. See NewSessionCallback().
+  if (w == nullptr || (w->is_server() && w->ocsp_response_.IsEmpty()))
+    return SSL_TLSEXT_ERR_NOACK;
+
   Environment* env = w->env();
   HandleScope handle_scope(env->isolate());
 
@@ -1856,9 +1889,6 @@ int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
     return 1;
   } else {
     // Outgoing response
-    if (w->ocsp_response_.IsEmpty())
-      return SSL_TLSEXT_ERR_NOACK;
-
     Local<Object> obj = PersistentToLocal(env->isolate(), w->ocsp_response_);
     char* resp = Buffer::Data(obj);
     size_t len = Buffer::Length(obj);
@@ -4533,10 +4563,11 @@ void PBKDF2(const FunctionCallbackInfo<Value>& args) {
     // XXX(trevnorris): This will need to go with the rest of domains.
     if (env->in_domain())
       obj->Set(env->domain_string(), env->domain_array()->Get(0));
-    uv_queue_work(env->event_loop(),
-                  req->work_req(),
-                  EIO_PBKDF2,
-                  EIO_PBKDF2After);
+    uv_queue_work_ex(env->event_loop(),
+                     req->work_req(),
+                     UV_WORK_CPU,
+                     EIO_PBKDF2,
+                     EIO_PBKDF2After);
   } else {
     Local<Value> argv[2];
     EIO_PBKDF2(req);
@@ -4696,10 +4727,11 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
     // XXX(trevnorris): This will need to go with the rest of domains.
     if (env->in_domain())
       obj->Set(env->domain_string(), env->domain_array()->Get(0));
-    uv_queue_work(env->event_loop(),
-                  req->work_req(),
-                  RandomBytesWork<pseudoRandom>,
-                  RandomBytesAfter);
+    uv_queue_work_ex(env->event_loop(),
+                     req->work_req(),
+                     UV_WORK_CPU,
+                     RandomBytesWork<pseudoRandom>,
+                     RandomBytesAfter);
     args.GetReturnValue().Set(obj);
   } else {
     Local<Value> argv[2];
@@ -5040,6 +5072,27 @@ void SetEngine(const FunctionCallbackInfo<Value>& args) {
 #endif  // !OPENSSL_NO_ENGINE
 
 
+// Returns the file descriptor of a new session cache or -1.
+void CreateSessionCache(const FunctionCallbackInfo<Value>& args) {
+  uint32_t entries = args[0]->Uint32Value();
+  args.GetReturnValue().Set(SessionCache::Create(entries));
+}
+
+
+// Process-wide, all TLS servers without 'newSession' and 'resumeSession'
+// listeners store their sessions in it from then on. Returns false if the
+// cache can't be mapped or another one is open already.
+void OpenSessionCache(const FunctionCallbackInfo<Value>& args) {
+  SessionCache* cache = SessionCache::Map(args[0]->Int32Value());
+  if (session_cache != nullptr) {
+    delete cache;
+    return args.GetReturnValue().Set(false);
+  }
+  session_cache = cache;
+  args.GetReturnValue().Set(cache != nullptr);
+}
+
+
 // FIXME(bnoordhuis) Handle global init correctly.
 void InitCrypto(Handle<Object> target,
                 Handle<Value> unused,
@@ -5064,6 +5117,8 @@ void InitCrypto(Handle<Object> target,
   env->SetMethod(target, "setEngine", SetEngine);
 #endif  // !OPENSSL_NO_ENGINE
   env->SetMethod(target, "PBKDF2", PBKDF2);
+  env->SetMethod(target, "createSessionCache", CreateSessionCache);
+  env->SetMethod(target, "openSessionCache", OpenSessionCache);
   env->SetMethod(target, "randomBytes", RandomBytes<false>);
   env->SetMethod(target, "pseudoRandomBytes", RandomBytes<true>);
   env->SetMethod(target, "getSSLCiphers", GetSSLCiphers);
@@ -159,7 +159,8 @@ class SSLWrap {
         kind_(kind),
         next_sess_(nullptr),
         session_callbacks_(false),
-        new_session_wait_(false) {
+        new_session_wait_(false),
+        max_send_fragment_set_(false) {
     ssl_ = SSL_new(sc->ctx_);
     CHECK_NE(ssl_, nullptr);
   }
@@ -252,6 +253,8 @@ class SSLWrap {
   SSL* ssl_;
   bool session_callbacks_;
   bool new_session_wait_;
+  // Set once the application picked a record size with setMaxSendFragment().
+  bool max_send_fragment_set_;
   ClientHelloParser hello_parser_;
 
 #ifdef NODE__HAVE_TLSEXT_STATUS_CB
@@ -93,6 +93,10 @@ int NodeBIO::Read(BIO* bio, char* out, int len) {
 
 
 char* NodeBIO::Peek(size_t* size) {
+  if (read_head_ == nullptr) {
+    *size = 0;
+    return nullptr;
+  }
   *size = read_head_->write_pos_ - read_head_->read_pos_;
   return read_head_->data_ + read_head_->read_pos_;
 }
@@ -103,6 +107,11 @@ size_t NodeBIO::PeekMultiple(char** out, size_t* size, size_t* count) {
   size_t max = *count;
   size_t total = 0;
 
+  if (pos == nullptr) {
+    *count = 0;
+    return 0;
+  }
+
   size_t i;
   for (i = 0; i < max; i++) {
     size[i] = pos->write_pos_ - pos->read_pos_;
@@ -266,6 +275,12 @@ size_t NodeBIO::Read(char* out, size_t size) {
   CHECK_EQ(expected, bytes_read);
   length_ -= bytes_read;
 
+  // Pooled BIOs give back everything once drained.
+  if (length_ == 0 && pool_ != nullptr) {
+    ReleaseBuffers();
+    return bytes_read;
+  }
+
   // Free all empty buffers, but write_head's child
   FreeEmpty();
 
@@ -420,7 +435,7 @@ void NodeBIO::TryAllocateForWrite(size_t hint) {
                              kThroughputBufferLength;
     if (len < hint)
       len = hint;
-    Buffer* next = new Buffer(len);
+    Buffer* next = new Buffer(len, pool_);
 
     if (w == nullptr) {
       next->next_ = next;
@@ -449,10 +464,13 @@ void NodeBIO::Reset() {
   }
   write_head_ = read_head_;
   CHECK_EQ(length_, 0);
+
+  if (pool_ != nullptr)
+    ReleaseBuffers();
 }
 
 
-NodeBIO::~NodeBIO() {
+void NodeBIO::ReleaseBuffers() {
   if (read_head_ == nullptr)
     return;
 
@@ -465,6 +483,17 @@ NodeBIO::~NodeBIO() {
 
   read_head_ = nullptr;
   write_head_ = nullptr;
+
+  // The small initial buffer is only meant for the first flight of the
+  // handshake. Once a connection has drained, the next burst of data is as
+  // likely to be bulk data as not, use buffers from the pool for it.
+  if (pool_ != nullptr)
+    initial_ = pool_->block_size();
+}
+
+
+NodeBIO::~NodeBIO() {
+  ReleaseBuffers();
 }
 
 }  // namespace node
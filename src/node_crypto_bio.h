@@ -22,6 +22,7 @@
 #ifndef SRC_NODE_CRYPTO_BIO_H_
 #define SRC_NODE_CRYPTO_BIO_H_
 
+#include "buffer_pool.h"
 #include "openssl/bio.h"
 #include "util.h"
 #include "util-inl.h"
@@ -33,7 +34,8 @@ class NodeBIO {
   NodeBIO() : initial_(kInitialBufferLength),
               length_(0),
               read_head_(nullptr),
-              write_head_(nullptr) {
+              write_head_(nullptr),
+              pool_(nullptr) {
   }
 
   ~NodeBIO();
@@ -88,6 +90,13 @@ class NodeBIO {
     initial_ = initial;
   }
 
+  // Draw buffers from |pool| and give them all back whenever the BIO drains.
+  // Buffers of other sizes than the pool's block size are not pooled but are
+  // still released.
+  inline void set_pool(BufferPool* pool) {
+    pool_ = pool;
+  }
+
   static inline NodeBIO* FromBIO(BIO* bio) {
     CHECK_NE(bio->ptr, nullptr);
     return static_cast<NodeBIO*>(bio->ptr);
@@ -110,15 +119,22 @@ class NodeBIO {
 
   class Buffer {
    public:
-    explicit Buffer(size_t len) : read_pos_(0),
-                                  write_pos_(0),
-                                  len_(len),
-                                  next_(nullptr) {
-      data_ = new char[len];
+    Buffer(size_t len, BufferPool* pool) : read_pos_(0),
+                                           write_pos_(0),
+                                           len_(len),
+                                           next_(nullptr) {
+      if (pool != nullptr && pool->block_size() == len)
+        pool_ = pool;
+      else
+        pool_ = nullptr;
+      data_ = pool_ != nullptr ? pool_->Allocate() : new char[len];
     }
 
     ~Buffer() {
-      delete[] data_;
+      if (pool_ != nullptr)
+        pool_->Free(data_);
+      else
+        delete[] data_;
     }
 
     size_t read_pos_;
@@ -126,12 +142,17 @@ class NodeBIO {
     size_t len_;
     Buffer* next_;
     char* data_;
+    BufferPool* pool_;
   };
 
+  // Free all buffers, the BIO must be empty.
+  void ReleaseBuffers();
+
   size_t initial_;
   size_t length_;
   Buffer* read_head_;
   Buffer* write_head_;
+  BufferPool* pool_;
 };
 
 }  // namespace node
@@ -0,0 +1,338 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "node_crypto_session_cache.h"
+#include "util.h"
+#include "util-inl.h"
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !_WIN32
+
+namespace node {
+
+#ifndef _WIN32
+
+static const uint32_t kMagic = 0x6e747363;  // 'ntsc'
+
+struct SessionCache::Header {
+  uint32_t magic;
+  uint32_t entry_size;
+  uint32_t sets;
+  pthread_mutex_t mutex;
+};
+
+
+// |expires| is zero for a free entry. It is cleared before and set after the
+// rest of the entry is written.
+struct SessionCache::Entry {
+  int64_t expires;
+  uint32_t id_length;
+  uint32_t length;
+  unsigned char scope[kScopeSize];
+  unsigned char id[SSL_MAX_SSL_SESSION_ID_LENGTH];
+  unsigned char data[kMaxSessionSize];
+};
+
+
+int SessionCache::Create(uint32_t entries) {
+  uint32_t sets = (entries + kWays - 1) / kWays;
+  if (sets == 0)
+    return -1;
+  size_t size = sizeof(Header) + sets * kWays * sizeof(Entry);
+
+  // The name is only needed until the segment is unlinked again.
+  char name[32];
+  snprintf(name, sizeof(name), "/node.%d.tls", static_cast<int>(getpid()));
+  int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd == -1)
+    return -1;
+  shm_unlink(name);
+
+  void* p = MAP_FAILED;
+  if (ftruncate(fd, size) == 0)
+    p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (p == MAP_FAILED) {
+    close(fd);
+    return -1;
+  }
+
+  // ftruncate() zero-filled the entries, they are all free.
+  Header* header = static_cast<Header*>(p);
+  header->entry_size = sizeof(Entry);
+  header->sets = sets;
+
+  pthread_mutexattr_t attr;
+  CHECK_EQ(0, pthread_mutexattr_init(&attr));
+  CHECK_EQ(0, pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED));
+#ifdef __linux__
+  // Don't let a worker that dies while holding the lock take the others
+  // down with it.
+  CHECK_EQ(0, pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST));
+#endif  // __linux__
+  CHECK_EQ(0, pthread_mutex_init(&header->mutex, &attr));
+  pthread_mutexattr_destroy(&attr);
+
+  header->magic = kMagic;
+  munmap(p, size);
+
+  return fd;
+}
+
+
+SessionCache* SessionCache::Map(int fd) {
+  struct stat s;
+  void* p = MAP_FAILED;
+  if (fstat(fd, &s) == 0 && static_cast<size_t>(s.st_size) >= sizeof(Header))
+    p = mmap(nullptr, s.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED)
+    return nullptr;
+
+  // Not a cache or created by a different version of node?
+  Header* header = static_cast<Header*>(p);
+  size_t size = s.st_size;
+  if (header->magic != kMagic ||
+      header->entry_size != sizeof(Entry) ||
+      header->sets == 0 ||
+      size < sizeof(Header) + header->sets * kWays * sizeof(Entry)) {
+    munmap(p, size);
+    return nullptr;
+  }
+
+  return new SessionCache(header, size);
+}
+
+
+SessionCache::SessionCache(Header* header, size_t size)
+    : header_(header),
+      size_(size) {
+}
+
+
+SessionCache::~SessionCache() {
+  munmap(header_, size_);
+}
+
+
+void SessionCache::Lock() {
+  int err = pthread_mutex_lock(&header_->mutex);
+#ifdef __linux__
+  // The previous owner died, at worst it left an entry half written.
+  if (err == EOWNERDEAD)
+    err = pthread_mutex_consistent(&header_->mutex);
+#endif  // __linux__
+  CHECK_EQ(err, 0);
+}
+
+
+void SessionCache::Unlock() {
+  CHECK_EQ(0, pthread_mutex_unlock(&header_->mutex));
+}
+
+
+// OpenSSL refuses sessions from a different session id context but all
+// servers in a process get the same one unless they set sessionIdContext,
+// so the certificate and the client verification settings go into the key
+// as well. A session must not skip client verification on a server that
+// trusts other CAs than the server that verified the client.
+void SessionCache::GetScope(SSL* ssl, unsigned char* scope) {
+  const EVP_MD* md = EVP_sha256();
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int digest_length;
+  int verify_mode = SSL_get_verify_mode(ssl);
+  int verify_depth = SSL_get_verify_depth(ssl);
+
+  EVP_MD_CTX ctx;
+  EVP_MD_CTX_init(&ctx);
+  EVP_DigestInit_ex(&ctx, md, nullptr);
+  EVP_DigestUpdate(&ctx, ssl->sid_ctx, ssl->sid_ctx_length);
+  EVP_DigestUpdate(&ctx, &verify_mode, sizeof(verify_mode));
+  EVP_DigestUpdate(&ctx, &verify_depth, sizeof(verify_depth));
+
+  X509* cert = SSL_get_certificate(ssl);
+  if (cert != nullptr && X509_digest(cert, md, digest, &digest_length))
+    EVP_DigestUpdate(&ctx, digest, digest_length);
+
+  if (verify_mode & SSL_VERIFY_PEER) {
+    STACK_OF(X509_NAME)* names = SSL_get_client_CA_list(ssl);
+    for (int i = 0; i < sk_X509_NAME_num(names); i++) {
+      X509_NAME* name = sk_X509_NAME_value(names, i);
+      if (X509_NAME_digest(name, md, digest, &digest_length))
+        EVP_DigestUpdate(&ctx, digest, digest_length);
+    }
+  }
+
+  EVP_DigestFinal_ex(&ctx, scope, nullptr);
+  EVP_MD_CTX_cleanup(&ctx);
+}
+
+
+SessionCache::Entry* SessionCache::Set(const unsigned char* scope,
+                                       const unsigned char* id,
+                                       unsigned int len) {
+  // FNV-1a, session ids are random but not necessarily of a fixed length.
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < kScopeSize; i++)
+    hash = (hash ^ scope[i]) * 16777619u;
+  for (unsigned int i = 0; i < len; i++)
+    hash = (hash ^ id[i]) * 16777619u;
+  Entry* entries = reinterpret_cast<Entry*>(header_ + 1);
+  return entries + (hash % header_->sets) * kWays;
+}
+
+
+void SessionCache::Add(SSL* ssl, SSL_SESSION* sess) {
+  unsigned int id_length = sess->session_id_length;
+  if (id_length == 0 || id_length > SSL_MAX_SSL_SESSION_ID_LENGTH)
+    return;
+
+  int length = i2d_SSL_SESSION(sess, nullptr);
+  if (length <= 0 || static_cast<size_t>(length) > kMaxSessionSize)
+    return;
+
+  // Serialize outside the lock.
+  unsigned char scope[kScopeSize];
+  GetScope(ssl, scope);
+  unsigned char data[kMaxSessionSize];
+  unsigned char* p = data;
+  i2d_SSL_SESSION(sess, &p);
+  int64_t expires = static_cast<int64_t>(SSL_SESSION_get_time(sess)) +
+                    SSL_SESSION_get_timeout(sess);
+
+  Lock();
+
+  // Replace the same session or evict the entry that expires first, free
+  // entries have |expires| == 0.
+  Entry* set = Set(scope, sess->session_id, id_length);
+  Entry* entry = &set[0];
+  for (uint32_t i = 0; i < kWays; i++) {
+    if (set[i].expires != 0 &&
+        set[i].id_length == id_length &&
+        memcmp(set[i].id, sess->session_id, id_length) == 0 &&
+        memcmp(set[i].scope, scope, kScopeSize) == 0) {
+      entry = &set[i];
+      break;
+    }
+    if (set[i].expires < entry->expires)
+      entry = &set[i];
+  }
+
+  entry->expires = 0;
+  memcpy(entry->scope, scope, kScopeSize);
+  entry->id_length = id_length;
+  memcpy(entry->id, sess->session_id, id_length);
+  entry->length = length;
+  memcpy(entry->data, data, length);
+  entry->expires = expires;
+
+  Unlock();
+}
+
+
+SSL_SESSION* SessionCache::Get(SSL* ssl, const unsigned char* id, int len) {
+  if (len <= 0 || len > SSL_MAX_SSL_SESSION_ID_LENGTH)
+    return nullptr;
+
+  unsigned char scope[kScopeSize];
+  GetScope(ssl, scope);
+  unsigned char data[kMaxSessionSize];
+  size_t length = 0;
+  int64_t now = time(nullptr);
+
+  Lock();
+
+  Entry* set = Set(scope, id, len);
+  for (uint32_t i = 0; i < kWays; i++) {
+    Entry* entry = &set[i];
+    if (entry->expires == 0 ||
+        entry->id_length != static_cast<uint32_t>(len) ||
+        memcmp(entry->id, id, len) != 0 ||
+        memcmp(entry->scope, scope, kScopeSize) != 0) {
+      continue;
+    }
+    if (entry->expires < now) {
+      entry->expires = 0;
+    } else if (entry->length <= kMaxSessionSize) {
+      length = entry->length;
+      memcpy(data, entry->data, length);
+    }
+    break;
+  }
+
+  Unlock();
+
+  if (length == 0)
+    return nullptr;
+
+  const unsigned char* p = data;
+  SSL_SESSION* sess = d2i_SSL_SESSION(nullptr, &p, length);
+  if (sess == nullptr)
+    return nullptr;
+
+  // Don't trust what a dead worker may have left behind.
+  if (sess->session_id_length != static_cast<unsigned int>(len) ||
+      memcmp(sess->session_id, id, len) != 0) {
+    SSL_SESSION_free(sess);
+    return nullptr;
+  }
+
+  return sess;
+}
+
+#else  // _WIN32
+
+int SessionCache::Create(uint32_t entries) {
+  return -1;
+}
+
+
+SessionCache* SessionCache::Map(int fd) {
+  return nullptr;
+}
+
+
+SessionCache::~SessionCache() {
+}
+
+
+void SessionCache::Add(SSL* ssl, SSL_SESSION* sess) {
+}
+
+
+SSL_SESSION* SessionCache::Get(SSL* ssl, const unsigned char* id, int len) {
+  return nullptr;
+}
+
+#endif  // _WIN32
+
+}  // namespace node
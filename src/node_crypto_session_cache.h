@@ -0,0 +1,84 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_NODE_CRYPTO_SESSION_CACHE_H_
+#define SRC_NODE_CRYPTO_SESSION_CACHE_H_
+
+#include "util.h"
+
+#include <openssl/ssl.h>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+
+// A TLS server session cache in shared memory. The cluster master creates it
+// and hands the file descriptor to the workers, which map it and store and
+// look up sessions directly from OpenSSL's session callbacks, so a client can
+// resume its session no matter which worker it lands on. The segment has no
+// name, it goes away with the last process that has it open or mapped.
+//
+// The cache is a set-associative table of fixed size entries. A full set
+// evicts the entry that expires first. Sessions that don't fit in an entry
+// are not cached. A session is only found again by a server that has the
+// same session id context, certificate and client verification settings as
+// the one that added it. Add() and Get() don't touch V8 and may be called
+// from any thread.
+class SessionCache {
+ public:
+  static const size_t kMaxSessionSize = 2048;
+
+  // Returns a file descriptor for a new cache with room for |entries|
+  // sessions, or -1 if shared memory is not available.
+  static int Create(uint32_t entries);
+
+  // Maps the cache behind |fd| and closes |fd|. Returns nullptr on failure.
+  static SessionCache* Map(int fd);
+  ~SessionCache();
+
+  void Add(SSL* ssl, SSL_SESSION* sess);
+  SSL_SESSION* Get(SSL* ssl, const unsigned char* id, int len);
+
+ private:
+  struct Header;
+  struct Entry;
+
+  static const uint32_t kWays = 4;
+  static const size_t kScopeSize = 32;  // SHA-256
+
+  SessionCache(Header* header, size_t size);
+
+  void Lock();
+  void Unlock();
+  static void GetScope(SSL* ssl, unsigned char* scope);
+  Entry* Set(const unsigned char* scope,
+             const unsigned char* id,
+             unsigned int len);
+
+  Header* const header_;
+  const size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(SessionCache);
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_CRYPTO_SESSION_CACHE_H_
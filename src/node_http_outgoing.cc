@@ -0,0 +1,431 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "node.h"
+#include "node_buffer.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace node {
+namespace http_outgoing {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Handle;
+using v8::Integer;
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+// Inputs of SerializeResponseHead(), from the ServerResponse.
+enum HeadInputFlags {
+  kSendDate = 1,
+  kShouldKeepAlive = 2,
+  kChunkedByDefault = 4,  // useChunkedEncodingByDefault
+  kHasBody = 8,
+  kRemovedConnection = 16,
+  kRemovedTransferEncoding = 32,
+  kChunkedEncoding = 64,
+  kHasAgent = 128
+};
+
+// Outputs of SerializeResponseHead(). kOutputShouldKeepAlive and
+// kOutputChunkedEncoding are the new values of the properties of the same
+// name. kOutputLast means _last should be set, it is never cleared.
+enum HeadOutputFlags {
+  kOutputLast = 1,
+  kOutputShouldKeepAlive = 2,
+  kOutputChunkedEncoding = 4,
+  kOutputSentExpect = 8
+};
+
+
+// Collects the head in a stack buffer, moving to the heap when it outgrows
+// that.
+class HeadWriter {
+ public:
+  HeadWriter() : data_(stack_storage_), length_(0),
+                 capacity_(sizeof(stack_storage_)) {
+  }
+
+  ~HeadWriter() {
+    if (data_ != stack_storage_)
+      free(data_);
+  }
+
+  void Append(const char* data, size_t length) {
+    Reserve(length);
+    memcpy(data_ + length_, data, length);
+    length_ += length;
+  }
+
+  void Append(Local<String> string) {
+    size_t length = string->Length();
+    Reserve(length);
+    string->WriteOneByte(reinterpret_cast<uint8_t*>(data_ + length_),
+                         0,
+                         length,
+                         String::NO_NULL_TERMINATION);
+    length_ += length;
+  }
+
+  // Protects against response splitting like storeHeader() in
+  // lib/_http_outgoing.js: removes runs of CR and LF characters and the
+  // spaces and tabs that follow them, starting at |offset|.
+  void StripNewlines(size_t offset) {
+    size_t out = offset;
+    size_t i = offset;
+    while (i < length_) {
+      if (data_[i] != '\r' && data_[i] != '\n') {
+        data_[out++] = data_[i++];
+        continue;
+      }
+      while (i < length_ && (data_[i] == '\r' || data_[i] == '\n'))
+        i += 1;
+      while (i < length_ && (data_[i] == ' ' || data_[i] == '\t'))
+        i += 1;
+    }
+    length_ = out;
+  }
+
+  // Case-insensitive search for |needle|, which must be lowercase, in the
+  // bytes from |offset| to |offset + length|.
+  bool Contains(size_t offset, size_t length, const char* needle) const {
+    size_t needle_length = strlen(needle);
+    if (length < needle_length)
+      return false;
+    for (size_t i = offset; i + needle_length <= offset + length; i += 1) {
+      size_t k = 0;
+      while (k < needle_length && ToLower(data_[i + k]) == needle[k])
+        k += 1;
+      if (k == needle_length)
+        return true;
+    }
+    return false;
+  }
+
+  Local<String> ToString(Environment* env) const {
+    return OneByteString(env->isolate(), data_, length_);
+  }
+
+  size_t length() const { return length_; }
+
+ private:
+  static char ToLower(char c) {
+    return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+  }
+
+  void Reserve(size_t length) {
+    if (capacity_ - length_ >= length)
+      return;
+    size_t capacity = 2 * (length_ + length);
+    char* data = static_cast<char*>(malloc(capacity));
+    CHECK_NE(data, nullptr);
+    memcpy(data, data_, length_);
+    if (data_ != stack_storage_)
+      free(data_);
+    data_ = data;
+    capacity_ = capacity;
+  }
+
+  char stack_storage_[4096];
+  char* data_;
+  size_t length_;
+  size_t capacity_;
+};
+
+
+// Like value->ToString() but skips the call into V8 for strings.
+static Local<String> ToString(Local<Value> value) {
+  if (value->IsString())
+    return value.As<String>();
+  return value->ToString();
+}
+
+
+static bool IsOneByte(Local<String> string) {
+  return string->IsOneByte() || string->ContainsOnlyOneByte();
+}
+
+
+static bool IsStatus(Local<Value> status_code, double code) {
+  return status_code->IsNumber() && status_code->NumberValue() == code;
+}
+
+
+// The state that storeHeader() in lib/_http_outgoing.js keeps in its |state|
+// object and in the properties of the OutgoingMessage.
+class ResponseHead {
+ public:
+  explicit ResponseHead(uint32_t flags)
+      : last_(false),
+        should_keep_alive_((flags & kShouldKeepAlive) != 0),
+        chunked_encoding_((flags & kChunkedEncoding) != 0),
+        sent_connection_(false),
+        sent_content_length_(false),
+        sent_transfer_encoding_(false),
+        sent_date_(false),
+        sent_expect_(false) {
+  }
+
+  // Adds the headers the way the loop in _storeHeader() does. |headers| is
+  // an object or an array of [name, value] pairs, a value can be an array.
+  // Returns false if a name or value doesn't fit in one byte per character,
+  // if |headers| is something else or if an exception was thrown.
+  bool AddHeaders(Local<Value> headers) {
+    if (!headers->BooleanValue())
+      return true;
+    if (!headers->IsObject())
+      return false;
+
+    Local<Object> object = headers.As<Object>();
+    if (headers->IsArray()) {
+      const uint32_t length = object.As<Array>()->Length();
+      for (uint32_t i = 0; i < length; i += 1) {
+        Local<Value> pair_value = object->Get(i);
+        if (!pair_value->IsObject())
+          return false;
+        Local<Object> pair = pair_value.As<Object>();
+        if (!AddHeader(pair->Get(0), pair->Get(1)))
+          return false;
+      }
+      return true;
+    }
+
+    Local<Array> keys = object->GetOwnPropertyNames();
+    if (keys.IsEmpty())
+      return false;
+    const uint32_t length = keys->Length();
+    for (uint32_t i = 0; i < length; i += 1) {
+      Local<Value> key = keys->Get(i);
+      if (!AddHeader(key, object->Get(key)))
+        return false;
+    }
+    return true;
+  }
+
+  bool AddHeader(Local<Value> field, Local<Value> value) {
+    if (value->IsArray()) {
+      Local<Array> values = value.As<Array>();
+      const uint32_t length = values->Length();
+      for (uint32_t i = 0; i < length; i += 1)
+        if (!AddLine(field, values->Get(i)))
+          return false;
+      return true;
+    }
+    return AddLine(field, value);
+  }
+
+  HeadWriter head_;
+  bool last_;
+  bool should_keep_alive_;
+  bool chunked_encoding_;
+  bool sent_connection_;
+  bool sent_content_length_;
+  bool sent_transfer_encoding_;
+  bool sent_date_;
+  bool sent_expect_;
+
+ private:
+  bool AddLine(Local<Value> field_value, Local<Value> value_value) {
+    Local<String> field = ToString(field_value);
+    if (field.IsEmpty() || !IsOneByte(field))
+      return false;
+    Local<String> value = ToString(value_value);
+    if (value.IsEmpty() || !IsOneByte(value))
+      return false;
+
+    size_t field_offset = head_.length();
+    head_.Append(field);
+    size_t field_length = head_.length() - field_offset;
+    head_.Append(": ", 2);
+    size_t value_offset = head_.length();
+    head_.Append(value);
+    head_.StripNewlines(value_offset);
+    size_t value_length = head_.length() - value_offset;
+    head_.Append("\r\n", 2);
+
+    // Substring matches, like the regular expressions in storeHeader().
+    if (head_.Contains(field_offset, field_length, "connection")) {
+      sent_connection_ = true;
+      if (head_.Contains(value_offset, value_length, "close"))
+        last_ = true;
+      else
+        should_keep_alive_ = true;
+    } else if (head_.Contains(field_offset, field_length,
+                              "transfer-encoding")) {
+      sent_transfer_encoding_ = true;
+      if (head_.Contains(value_offset, value_length, "chunk"))
+        chunked_encoding_ = true;
+    } else if (head_.Contains(field_offset, field_length, "content-length")) {
+      sent_content_length_ = true;
+    } else if (head_.Contains(field_offset, field_length, "date")) {
+      sent_date_ = true;
+    } else if (head_.Contains(field_offset, field_length, "expect")) {
+      sent_expect_ = true;
+    }
+
+    return true;
+  }
+};
+
+
+// var head = serializeResponseHead(out, statusCode, reason, headers, flags,
+//                                  date);
+//
+// Does what OutgoingMessage#_storeHeader() does for a ServerResponse. Returns
+// the head as a flat one-byte string and stores the HeadOutputFlags in
+// out[0], where |out| is a Buffer because that is much cheaper to write to
+// than an array. Returns undefined if a name or value has characters that
+// don't fit in one byte, the caller should take the JS path then.
+static void SerializeResponseHead(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(Buffer::HasInstance(args[0]));
+  CHECK_GE(Buffer::Length(args[0]), 1);
+  CHECK(args[1]->IsNumber());
+  CHECK(args[4]->IsUint32());
+
+  uint8_t* out = reinterpret_cast<uint8_t*>(Buffer::Data(args[0]));
+  Local<Value> status_code = args[1];
+  uint32_t flags = args[4]->Uint32Value();
+  ResponseHead state(flags);
+  HeadWriter& head = state.head_;
+
+  head.Append("HTTP/1.1 ", 9);
+  if (status_code->IsUint32() && status_code->Uint32Value() < 1000) {
+    char code[4];
+    snprintf(code, sizeof(code), "%u", status_code->Uint32Value());
+    head.Append(code, strlen(code));
+  } else {
+    Local<String> code = status_code->ToString();
+    if (code.IsEmpty())
+      return;  // Exception pending.
+    head.Append(code);
+  }
+  head.Append(" ", 1);
+  Local<String> reason = ToString(args[2]);
+  if (reason.IsEmpty() || !IsOneByte(reason))
+    return;
+  head.Append(reason);
+  head.Append("\r\n", 2);
+
+  if (!state.AddHeaders(args[3]))
+    return;
+
+  if ((flags & kSendDate) && !state.sent_date_) {
+    Local<String> date = ToString(args[5]);
+    if (date.IsEmpty() || !IsOneByte(date))
+      return;
+    head.Append("Date: ", 6);
+    head.Append(date);
+    head.Append("\r\n", 2);
+  }
+
+  // See _storeHeader() for why 204 and 304 responses don't get chunked.
+  if ((IsStatus(status_code, 204) || IsStatus(status_code, 304)) &&
+      state.chunked_encoding_) {
+    state.chunked_encoding_ = false;
+    state.should_keep_alive_ = false;
+  }
+
+  if (flags & kRemovedConnection) {
+    state.last_ = true;
+    state.should_keep_alive_ = false;
+  } else if (!state.sent_connection_) {
+    if (state.should_keep_alive_ &&
+        (state.sent_content_length_ ||
+         (flags & (kChunkedByDefault | kHasAgent)))) {
+      static const char keep_alive[] = "Connection: keep-alive\r\n";
+      head.Append(keep_alive, sizeof(keep_alive) - 1);
+    } else {
+      static const char close[] = "Connection: close\r\n";
+      head.Append(close, sizeof(close) - 1);
+      state.last_ = true;
+    }
+  }
+
+  if (!state.sent_content_length_ && !state.sent_transfer_encoding_) {
+    if ((flags & kHasBody) && !(flags & kRemovedTransferEncoding)) {
+      if (flags & kChunkedByDefault) {
+        static const char chunked[] = "Transfer-Encoding: chunked\r\n";
+        head.Append(chunked, sizeof(chunked) - 1);
+        state.chunked_encoding_ = true;
+      } else {
+        state.last_ = true;
+      }
+    } else {
+      state.chunked_encoding_ = false;
+    }
+  }
+
+  head.Append("\r\n", 2);
+
+  uint8_t result = 0;
+  if (state.last_)
+    result |= kOutputLast;
+  if (state.should_keep_alive_)
+    result |= kOutputShouldKeepAlive;
+  if (state.chunked_encoding_)
+    result |= kOutputChunkedEncoding;
+  if (state.sent_expect_)
+    result |= kOutputSentExpect;
+
+  out[0] = result;
+  args.GetReturnValue().Set(head.ToString(env));
+}
+
+
+void Initialize(Handle<Object> target,
+                Handle<Value> unused,
+                Handle<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "serializeResponseHead", SerializeResponseHead);
+
+  NODE_DEFINE_CONSTANT(target, kSendDate);
+  NODE_DEFINE_CONSTANT(target, kShouldKeepAlive);
+  NODE_DEFINE_CONSTANT(target, kChunkedByDefault);
+  NODE_DEFINE_CONSTANT(target, kHasBody);
+  NODE_DEFINE_CONSTANT(target, kRemovedConnection);
+  NODE_DEFINE_CONSTANT(target, kRemovedTransferEncoding);
+  NODE_DEFINE_CONSTANT(target, kChunkedEncoding);
+  NODE_DEFINE_CONSTANT(target, kHasAgent);
+  NODE_DEFINE_CONSTANT(target, kOutputLast);
+  NODE_DEFINE_CONSTANT(target, kOutputShouldKeepAlive);
+  NODE_DEFINE_CONSTANT(target, kOutputChunkedEncoding);
+  NODE_DEFINE_CONSTANT(target, kOutputSentExpect);
+}
+
+}  // namespace http_outgoing
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(http_outgoing,
+                                  node::http_outgoing::Initialize)
@@ -63,16 +63,149 @@ using v8::FunctionTemplate;
 using v8::Handle;
 using v8::HandleScope;
 using v8::Integer;
+using v8::Isolate;
 using v8::Local;
 using v8::Object;
 using v8::String;
 using v8::Uint32;
+using v8::Undefined;
 using v8::Value;
 
 const uint32_t kOnHeaders = 0;
 const uint32_t kOnHeadersComplete = 1;
 const uint32_t kOnBody = 2;
 const uint32_t kOnMessageComplete = 3;
+const uint32_t kOnMessages = 4;
+
+
+// Header names that are common enough to intern. When the peer spells one of
+// these names like below or all in lowercase, the parser hands JS a string
+// from a pre-built table instead of allocating a new one. The table's
+// lowercase entries double as the keys of IncomingMessage#headers.
+//
+// The second column says what to do with repeated headers when building the
+// headers object, see IncomingMessage#_addHeaderLine(): collect the values in
+// an array, keep the first value or join the values with ', '. Unknown
+// headers are joined.
+#define HTTP_KNOWN_HEADERS(V)                                                 \
+  V("Accept", JOIN)                                                           \
+  V("Accept-Charset", JOIN)                                                   \
+  V("Accept-Encoding", JOIN)                                                  \
+  V("Accept-Language", JOIN)                                                  \
+  V("Accept-Ranges", JOIN)                                                    \
+  V("Age", JOIN)                                                              \
+  V("Authorization", FIRST)                                                   \
+  V("Cache-Control", JOIN)                                                    \
+  V("Connection", JOIN)                                                       \
+  V("Content-Disposition", JOIN)                                              \
+  V("Content-Encoding", JOIN)                                                 \
+  V("Content-Language", JOIN)                                                 \
+  V("Content-Length", FIRST)                                                  \
+  V("Content-Type", FIRST)                                                    \
+  V("Cookie", JOIN)                                                           \
+  V("Date", JOIN)                                                             \
+  V("DNT", JOIN)                                                              \
+  V("ETag", JOIN)                                                             \
+  V("Expect", JOIN)                                                           \
+  V("Expires", JOIN)                                                          \
+  V("From", FIRST)                                                            \
+  V("Host", FIRST)                                                            \
+  V("If-Match", JOIN)                                                         \
+  V("If-Modified-Since", FIRST)                                               \
+  V("If-None-Match", JOIN)                                                    \
+  V("If-Range", JOIN)                                                         \
+  V("If-Unmodified-Since", FIRST)                                             \
+  V("Keep-Alive", JOIN)                                                       \
+  V("Last-Modified", JOIN)                                                    \
+  V("Location", FIRST)                                                        \
+  V("Max-Forwards", FIRST)                                                    \
+  V("Origin", JOIN)                                                           \
+  V("Pragma", JOIN)                                                           \
+  V("Proxy-Authorization", FIRST)                                             \
+  V("Range", JOIN)                                                            \
+  V("Referer", FIRST)                                                         \
+  V("Server", JOIN)                                                           \
+  V("Set-Cookie", ARRAY)                                                      \
+  V("TE", JOIN)                                                               \
+  V("Transfer-Encoding", JOIN)                                                \
+  V("Upgrade", JOIN)                                                          \
+  V("User-Agent", FIRST)                                                      \
+  V("Vary", JOIN)                                                             \
+  V("Via", JOIN)                                                              \
+  V("X-Forwarded-For", JOIN)                                                  \
+  V("X-Forwarded-Host", JOIN)                                                 \
+  V("X-Forwarded-Proto", JOIN)                                                \
+  V("X-Real-IP", JOIN)                                                        \
+  V("X-Requested-With", JOIN)                                                 \
+
+
+enum HeaderMergePolicy {
+  ARRAY,
+  FIRST,
+  JOIN
+};
+
+struct KnownHeader {
+  const char* name;
+  size_t length;
+  HeaderMergePolicy policy;
+};
+
+static const KnownHeader known_headers[] = {
+#define V(name, policy) { name, sizeof(name) - 1, policy },
+  HTTP_KNOWN_HEADERS(V)
+#undef V
+};
+
+// Index of a spelling in env->http_header_names_array(), relative to
+// 2 * <index into known_headers>.
+enum HeaderSpelling {
+  kLowerCase = 0,
+  kCanonical = 1,
+  kOtherSpelling = 2
+};
+
+
+static inline char ToLower(char c) {
+  return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+
+// Returns the index into known_headers of the header name |s|, or -1 if it is
+// not a known header. Matching is case-insensitive. |spelling| tells if |s|
+// is the canonical or the lowercase form of the name or something else.
+static int FindKnownHeader(const char* s, size_t n, HeaderSpelling* spelling) {
+  for (size_t i = 0; i < ARRAY_SIZE(known_headers); i += 1) {
+    const KnownHeader& header = known_headers[i];
+    if (header.length != n || ToLower(header.name[0]) != ToLower(s[0]))
+      continue;
+
+    bool canonical = true;
+    bool lower = true;
+    size_t k;
+    for (k = 0; k < n; k += 1) {
+      char c = header.name[k];
+      if (ToLower(c) != ToLower(s[k]))
+        break;
+      canonical = canonical && c == s[k];
+      lower = lower && ToLower(c) == s[k];
+    }
+
+    if (k < n)
+      continue;
+
+    if (canonical)
+      *spelling = kCanonical;
+    else if (lower)
+      *spelling = kLowerCase;
+    else
+      *spelling = kOtherSpelling;
+
+    return static_cast<int>(i);
+  }
+
+  return -1;
+}
 
 
 #define HTTP_CB(name)                                                         \
@@ -168,7 +301,8 @@ class Parser : public BaseObject {
   Parser(Environment* env, Local<Object> wrap, enum http_parser_type type)
       : BaseObject(env, wrap),
         current_buffer_len_(0),
-        current_buffer_data_(nullptr) {
+        current_buffer_data_(nullptr),
+        batch_length_(0) {
     Wrap(object(), this);
     Init(type);
   }
@@ -252,7 +386,20 @@ class Parser : public BaseObject {
       Flush();
     } else {
       // Fast case, pass headers and URL to JS land.
-      message_info->Set(env()->headers_string(), CreateHeaders());
+      if (headers_object_limit_ >= 0) {
+        // The limit counts names and values, like parser.maxHeaderPairs.
+        int pairs = num_values_;
+        int max_pairs = (headers_object_limit_ + 1) / 2;
+        if (headers_object_limit_ > 0 && pairs > max_pairs)
+          pairs = max_pairs;
+        Local<Object> headers;
+        Local<Array> raw_headers;
+        CreateHeadersObject(pairs, &headers, &raw_headers);
+        message_info->Set(env()->headers_string(), headers);
+        message_info->Set(env()->raw_headers_string(), raw_headers);
+      } else {
+        message_info->Set(env()->headers_string(), CreateHeaders());
+      }
       if (parser_.type == HTTP_REQUEST)
         message_info->Set(env()->url_string(), url_.ToString(env()));
     }
@@ -287,6 +434,12 @@ class Parser : public BaseObject {
                       parser_.upgrade ? True(env()->isolate())
                                       : False(env()->isolate()));
 
+    // Request parsers never skip the body so there is no return value to wait
+    // for, the callback can be deferred.
+    Local<Value> undefined = Undefined(env()->isolate());
+    if (Enqueue(kOnHeadersComplete, message_info, undefined))
+      return 0;
+
     Local<Value> argv[1] = { message_info };
     Local<Value> head_response =
         cb.As<Function>()->Call(obj, ARRAY_SIZE(argv), argv);
@@ -309,11 +462,14 @@ class Parser : public BaseObject {
     if (!cb->IsFunction())
       return 0;
 
-    Local<Value> argv[3] = {
-      current_buffer_,
-      Integer::NewFromUnsigned(env()->isolate(), at - current_buffer_data_),
-      Integer::NewFromUnsigned(env()->isolate(), length)
-    };
+    Local<Value> start =
+        Integer::NewFromUnsigned(env()->isolate(), at - current_buffer_data_);
+    Local<Value> len = Integer::NewFromUnsigned(env()->isolate(), length);
+
+    if (Enqueue(kOnBody, start, len))
+      return 0;
+
+    Local<Value> argv[3] = { current_buffer_, start, len };
 
     Local<Value> r = cb.As<Function>()->Call(obj, ARRAY_SIZE(argv), argv);
 
@@ -338,6 +494,10 @@ class Parser : public BaseObject {
     if (!cb->IsFunction())
       return 0;
 
+    Local<Value> undefined = Undefined(env()->isolate());
+    if (Enqueue(kOnMessageComplete, undefined, undefined))
+      return 0;
+
     Local<Value> r = cb.As<Function>()->Call(obj, 0, nullptr);
 
     if (r.IsEmpty()) {
@@ -400,11 +560,31 @@ class Parser : public BaseObject {
     parser->current_buffer_data_ = buffer_data;
     parser->got_exception_ = false;
 
+    Local<Value> cb = args.Holder()->Get(kOnMessages);
+    if (parser->batch_mode_ && cb->IsFunction()) {
+      parser->batch_ = Array::New(env->isolate());
+      parser->batch_length_ = 0;
+    }
+
     size_t nparsed =
       http_parser_execute(&parser->parser_, &settings, buffer_data, buffer_len);
 
     parser->Save();
 
+    if (!parser->batch_.IsEmpty()) {
+      Local<Array> batch = parser->batch_;
+      parser->batch_.Clear();
+      // The messages have been parsed in full by now. If a callback throws,
+      // the ones after it in the batch don't run.
+      if (parser->batch_length_ > 0) {
+        Local<Value> argv[2] = { batch, buffer_obj };
+        Local<Value> r =
+            cb.As<Function>()->Call(args.Holder(), ARRAY_SIZE(argv), argv);
+        if (r.IsEmpty())
+          parser->got_exception_ = true;
+      }
+    }
+
     // Unassign the 'buffer_' variable
     parser->current_buffer_.Clear();
     parser->current_buffer_len_ = 0;
@@ -474,6 +654,45 @@ class Parser : public BaseObject {
   }
 
 
+  // parser.setHeadersObject(maxHeaderPairs) makes the parser build the
+  // headers object itself and pass it to onHeadersComplete as info.headers,
+  // with the flat list of names and values in info.rawHeaders. It follows
+  // the rules of IncomingMessage#_addHeaderLines() and only looks at the first
+  // maxHeaderPairs names and values, unless that is zero or less. Passing
+  // false switches back to info.headers being the flat list. Trailers and
+  // headers that are flushed to onHeaders in pieces are always passed as flat
+  // lists. reinitialize() switches the headers object off.
+  static void SetHeadersObject(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    Parser* parser = Unwrap<Parser>(args.Holder());
+    // Should always be called from the same context.
+    CHECK_EQ(env, parser->env());
+    if (args[0]->IsNumber()) {
+      int32_t limit = args[0]->Int32Value();
+      parser->headers_object_limit_ = limit > 0 ? limit : 0;
+    } else {
+      parser->headers_object_limit_ = -1;
+    }
+  }
+
+
+  // parser.setBatchMode(true) makes execute() collect the onHeadersComplete,
+  // onBody, onMessageComplete and onHeaders callbacks for all the messages in
+  // the buffer and make a single call to kOnMessages with a flat list of
+  // [callback, arg, arg, ...] triples and the buffer, just before execute()
+  // returns. Only request parsers batch because a response parser needs the
+  // return value of onHeadersComplete before it can continue. reinitialize()
+  // switches batch mode off.
+  static void SetBatchMode(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    Parser* parser = Unwrap<Parser>(args.Holder());
+    // Should always be called from the same context.
+    CHECK_EQ(env, parser->env());
+    parser->batch_mode_ =
+        args[0]->IsTrue() && parser->parser_.type == HTTP_REQUEST;
+  }
+
+
   template <bool should_pause>
   static void Pause(const FunctionCallbackInfo<Value>& args) {
     Environment* env = Environment::GetCurrent(args);
@@ -490,9 +709,10 @@ class Parser : public BaseObject {
     // num_values_ is either -1 or the entry # of the last header
     // so num_values_ == 0 means there's a single header
     Local<Array> headers = Array::New(env()->isolate(), 2 * num_values_);
+    Local<Array> names = env()->http_header_names_array();
 
     for (int i = 0; i < num_values_; ++i) {
-      headers->Set(2 * i, fields_[i].ToString(env()));
+      headers->Set(2 * i, HeaderFieldToString(names, fields_[i]));
       headers->Set(2 * i + 1, values_[i].ToString(env()));
     }
 
@@ -500,6 +720,136 @@ class Parser : public BaseObject {
   }
 
 
+  // Builds the headers object from the first |pairs| fields and values, like
+  // IncomingMessage#_addHeaderLines() would from the array CreateHeaders()
+  // returns. The array is returned in |raw_headers|, it shares its strings
+  // with the object.
+  void CreateHeadersObject(int pairs,
+                           Local<Object>* headers_out,
+                           Local<Array>* raw_headers_out) {
+    Isolate* isolate = env()->isolate();
+    Local<Array> names = env()->http_header_names_array();
+    Local<Object> headers = Object::New(isolate);
+    Local<Array> raw_headers = Array::New(isolate, 2 * pairs);
+    Local<Value> keys[ARRAY_SIZE(fields_)];
+
+    for (int i = 0; i < pairs; i += 1) {
+      const StringPtr& field = fields_[i];
+      HeaderSpelling spelling;
+      int index = FindKnownHeader(field.str_, field.size_, &spelling);
+
+      Local<Value> name;
+      if (index != -1 && spelling != kOtherSpelling)
+        name = names->Get(2 * index + spelling);
+      else
+        name = field.ToString(env());
+
+      Local<String> value = values_[i].ToString(env());
+      raw_headers->Set(2 * i, name);
+      raw_headers->Set(2 * i + 1, value);
+
+      HeaderMergePolicy policy =
+          index == -1 ? JOIN : known_headers[index].policy;
+
+      int first = 0;
+      while (first < i && !SameHeaderName(fields_[first], field))
+        first += 1;
+
+      if (first == i) {
+        if (index != -1)
+          keys[i] = names->Get(2 * index + kLowerCase);
+        else if (IsLowerCase(field))
+          keys[i] = name;
+        else
+          keys[i] = LowerCaseString(field);
+
+        if (policy == ARRAY) {
+          Local<Array> values = Array::New(isolate, 1);
+          values->Set(0, value);
+          headers->Set(keys[i], values);
+        } else {
+          headers->Set(keys[i], value);
+        }
+        continue;
+      }
+
+      keys[i] = keys[first];
+      if (policy == FIRST)
+        continue;
+
+      Local<Value> existing = headers->Get(keys[i]);
+      if (policy == ARRAY && existing->IsArray()) {
+        Local<Array> values = existing.As<Array>();
+        values->Set(values->Length(), value);
+      } else if (policy == JOIN && existing->IsString()) {
+        Local<String> joined =
+            String::Concat(existing.As<String>(), env()->comma_space_string());
+        headers->Set(keys[i], String::Concat(joined, value));
+      }
+    }
+
+    *headers_out = headers;
+    *raw_headers_out = raw_headers;
+  }
+
+
+  static bool SameHeaderName(const StringPtr& a, const StringPtr& b) {
+    if (a.size_ != b.size_)
+      return false;
+    for (size_t i = 0; i < a.size_; i += 1)
+      if (ToLower(a.str_[i]) != ToLower(b.str_[i]))
+        return false;
+    return true;
+  }
+
+
+  static bool IsLowerCase(const StringPtr& field) {
+    for (size_t i = 0; i < field.size_; i += 1)
+      if (ToLower(field.str_[i]) != field.str_[i])
+        return false;
+    return true;
+  }
+
+
+  Local<String> LowerCaseString(const StringPtr& field) {
+    char stack_storage[256];
+    char* lower = stack_storage;
+    if (field.size_ > sizeof(stack_storage))
+      lower = new char[field.size_];
+    for (size_t i = 0; i < field.size_; i += 1)
+      lower[i] = ToLower(field.str_[i]);
+    Local<String> result = OneByteString(env()->isolate(), lower, field.size_);
+    if (lower != stack_storage)
+      delete[] lower;
+    return result;
+  }
+
+
+  // Uses the interned string from |names| for known header names.
+  Local<Value> HeaderFieldToString(Local<Array> names,
+                                   const StringPtr& field) {
+    HeaderSpelling spelling;
+    int index = FindKnownHeader(field.str_, field.size_, &spelling);
+    if (index == -1 || spelling == kOtherSpelling)
+      return field.ToString(env());
+    return names->Get(2 * index + spelling);
+  }
+
+
+  // Adds a callback to the list that Execute() passes to kOnMessages. Returns
+  // false if execute() isn't batching, in which case the caller should make
+  // the call itself.
+  bool Enqueue(uint32_t index, Local<Value> arg0, Local<Value> arg1) {
+    if (batch_.IsEmpty())
+      return false;
+    batch_->Set(batch_length_++, Integer::NewFromUnsigned(env()->isolate(),
+                                                          index));
+    batch_->Set(batch_length_++, arg0);
+    batch_->Set(batch_length_++, arg1);
+    return true;
+  }
+
+
   // spill headers and request path to JS land
   void Flush() {
     HandleScope scope(env()->isolate());
@@ -515,10 +865,12 @@ class Parser : public BaseObject {
       url_.ToString(env())
     };
 
-    Local<Value> r = cb.As<Function>()->Call(obj, ARRAY_SIZE(argv), argv);
+    if (!Enqueue(kOnHeaders, argv[0], argv[1])) {
+      Local<Value> r = cb.As<Function>()->Call(obj, ARRAY_SIZE(argv), argv);
 
-    if (r.IsEmpty())
-      got_exception_ = true;
+      if (r.IsEmpty())
+        got_exception_ = true;
+    }
 
     url_.Reset();
     have_flushed_ = true;
@@ -533,6 +885,8 @@ class Parser : public BaseObject {
     num_values_ = 0;
     have_flushed_ = false;
     got_exception_ = false;
+    headers_object_limit_ = -1;
+    batch_mode_ = false;
   }
 
 
@@ -545,9 +899,13 @@ class Parser : public BaseObject {
   int num_values_;
   bool have_flushed_;
   bool got_exception_;
+  int headers_object_limit_;  // -1 if off, 0 if unlimited.
   Local<Object> current_buffer_;
   size_t current_buffer_len_;
   char* current_buffer_data_;
+  bool batch_mode_;
+  Local<Array> batch_;  // Only set while execute() runs in batch mode.
+  uint32_t batch_length_;
   static const struct http_parser_settings settings;
 };
 
@@ -564,6 +922,16 @@ const struct http_parser_settings Parser::settings = {
 };
 
 
+static Local<String> InternalizedString(Environment* env,
+                                        const char* data,
+                                        size_t length) {
+  return String::NewFromOneByte(env->isolate(),
+                                reinterpret_cast<const uint8_t*>(data),
+                                String::kInternalizedString,
+                                length);
+}
+
+
 void InitHttpParser(Handle<Object> target,
                     Handle<Value> unused,
                     Handle<Context> context,
@@ -585,6 +953,32 @@ void InitHttpParser(Handle<Object> target,
          Integer::NewFromUnsigned(env->isolate(), kOnBody));
   t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnMessageComplete"),
          Integer::NewFromUnsigned(env->isolate(), kOnMessageComplete));
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnMessages"),
+         Integer::NewFromUnsigned(env->isolate(), kOnMessages));
+
+  if (env->http_header_names_array().IsEmpty()) {
+    Local<Array> names =
+        Array::New(env->isolate(), 2 * ARRAY_SIZE(known_headers));
+    for (size_t i = 0; i < ARRAY_SIZE(known_headers); i += 1) {
+      const KnownHeader& header = known_headers[i];
+      char lower[32];
+      CHECK_LT(header.length, sizeof(lower));
+      for (size_t k = 0; k < header.length; k += 1)
+        lower[k] = ToLower(header.name[k]);
+      names->Set(2 * i + kLowerCase, InternalizedString(env, lower,
+                                                        header.length));
+      names->Set(2 * i + kCanonical, InternalizedString(env, header.name,
+                                                        header.length));
+    }
+    env->set_http_header_names_array(names);
+  }
+  // Pairs of lowercase and canonical header names, see HTTP_KNOWN_HEADERS.
+  // A copy, the parser relies on the contents of its own array.
+  Local<Array> names = env->http_header_names_array();
+  Local<Array> names_copy = Array::New(env->isolate(), names->Length());
+  for (uint32_t i = 0; i < names->Length(); i += 1)
+    names_copy->Set(i, names->Get(i));
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "headerNames"), names_copy);
 
   Local<Array> methods = Array::New(env->isolate());
 #define V(num, name, string)                                                  \
@@ -597,6 +991,8 @@ void InitHttpParser(Handle<Object> target,
   env->SetProtoMethod(t, "execute", Parser::Execute);
   env->SetProtoMethod(t, "finish", Parser::Finish);
   env->SetProtoMethod(t, "reinitialize", Parser::Reinitialize);
+  env->SetProtoMethod(t, "setHeadersObject", Parser::SetHeadersObject);
+  env->SetProtoMethod(t, "setBatchMode", Parser::SetBatchMode);
   env->SetProtoMethod(t, "pause", Parser::Pause<true>);
   env->SetProtoMethod(t, "resume", Parser::Pause<false>);
 
@@ -214,10 +214,11 @@ class ZCtx : public AsyncWrap {
     }
 
     // async version
-    uv_queue_work(ctx->env()->event_loop(),
-                  work_req,
-                  ZCtx::Process,
-                  ZCtx::After);
+    uv_queue_work_ex(ctx->env()->event_loop(),
+                     work_req,
+                     UV_WORK_CPU,
+                     ZCtx::Process,
+                     ZCtx::After);
 
     args.GetReturnValue().Set(ctx->object());
   }
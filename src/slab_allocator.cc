@@ -0,0 +1,170 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "slab_allocator.h"
+#include "env.h"
+#include "env-inl.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "util.h"
+#include "util-inl.h"
+
+#include <stdlib.h>  // malloc(), free()
+
+namespace node {
+
+using v8::Local;
+using v8::Object;
+
+// Every allocation is preceded by a pointer to the slab it was carved from
+// so that it can be returned even when it's not the most recent one. That
+// happens on Windows where libuv allocates read buffers ahead of time.
+static const size_t kHeaderSize = 16;
+
+struct SlabAllocator::Slab {
+  unsigned int refs;
+  size_t size;
+  size_t offset;  // Start of the free space.
+
+  // Keep the slab data aligned the same way as the allocations in it.
+  static const size_t kDataOffset = ROUND_UP(sizeof(size_t) * 3, kHeaderSize);
+
+  inline char* data() {
+    return reinterpret_cast<char*>(this) + kDataOffset;
+  }
+};
+
+
+SlabAllocator::SlabAllocator(size_t slab_size)
+    : slab_size_(slab_size),
+      slab_(nullptr),
+      slabs_allocated_(0),
+      buffers_allocated_(0),
+      buffers_copied_(0) {
+}
+
+
+SlabAllocator::~SlabAllocator() {
+  if (slab_ != nullptr)
+    Unref(slab_);
+  slab_ = nullptr;
+}
+
+
+void SlabAllocator::Allocate(size_t suggested_size, uv_buf_t* buf) {
+  size_t min_size = suggested_size;
+  if (min_size > kMinAllocation)
+    min_size = kMinAllocation;
+  min_size += kHeaderSize;
+
+  if (slab_ == nullptr || slab_->size - slab_->offset < min_size) {
+    size_t size = slab_size_;
+    if (size < suggested_size + kHeaderSize)
+      size = suggested_size + kHeaderSize;
+
+    Slab* slab = static_cast<Slab*>(malloc(Slab::kDataOffset + size));
+    if (slab == nullptr) {
+      FatalError("node::SlabAllocator::Allocate(size_t, uv_buf_t*)",
+                 "Out Of Memory");
+    }
+
+    slab->refs = 1;
+    slab->size = size;
+    slab->offset = 0;
+    slabs_allocated_ += 1;
+
+    if (slab_ != nullptr)
+      Unref(slab_);
+    slab_ = slab;
+  }
+
+  char* header = slab_->data() + slab_->offset;
+  *reinterpret_cast<Slab**>(header) = slab_;
+  slab_->offset += kHeaderSize;
+
+  size_t avail = slab_->size - slab_->offset;
+  buf->base = header + kHeaderSize;
+  buf->len = suggested_size < avail ? suggested_size : avail;
+  slab_->offset += buf->len;
+  slab_->refs += 1;
+}
+
+
+Local<Object> SlabAllocator::Shrink(Environment* env,
+                                    const uv_buf_t* buf,
+                                    size_t length) {
+  CHECK_LE(length, buf->len);
+
+  if (length <= kMaxCopySize) {
+    Local<Object> buffer = Buffer::New(env, buf->base, length);
+    Release(buf);
+    buffers_allocated_ += 1;
+    buffers_copied_ += 1;
+    return buffer;
+  }
+
+  Slab* slab = SlabOf(buf);
+
+  if (IsLastAllocation(slab, buf)) {
+    // Keep the next allocation aligned.
+    size_t offset = ROUND_UP(buf->base - slab->data() + length, kHeaderSize);
+    if (offset > slab->size)
+      offset = slab->size;
+    slab->offset = offset;
+  }
+
+  // The reference that the allocation holds is handed over to the buffer.
+  buffers_allocated_ += 1;
+  return Buffer::New(env, buf->base, length, FreeCallback, slab);
+}
+
+
+void SlabAllocator::Release(const uv_buf_t* buf) {
+  Slab* slab = SlabOf(buf);
+  if (IsLastAllocation(slab, buf))
+    slab->offset = buf->base - kHeaderSize - slab->data();
+  Unref(slab);
+}
+
+
+SlabAllocator::Slab* SlabAllocator::SlabOf(const uv_buf_t* buf) {
+  return *reinterpret_cast<Slab**>(buf->base - kHeaderSize);
+}
+
+
+bool SlabAllocator::IsLastAllocation(Slab* slab, const uv_buf_t* buf) const {
+  return slab == slab_ &&
+         buf->base + buf->len == slab->data() + slab->offset;
+}
+
+
+void SlabAllocator::FreeCallback(char* data, void* hint) {
+  Unref(static_cast<Slab*>(hint));
+}
+
+
+void SlabAllocator::Unref(Slab* slab) {
+  CHECK_GT(slab->refs, 0);
+  if (--slab->refs == 0)
+    free(slab);
+}
+
+}  // namespace node
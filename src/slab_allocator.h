@@ -0,0 +1,92 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_SLAB_ALLOCATOR_H_
+#define SRC_SLAB_ALLOCATOR_H_
+
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stddef.h>
+
+namespace node {
+
+class Environment;
+
+// Carves read buffers out of large, shared slabs so small reads don't each
+// cost a malloc() and a realloc(). Slabs are reference counted: the current
+// slab holds a reference for the allocator, every pending allocation holds
+// one and so does every Buffer that has been sliced from the slab.
+//
+// On Unix, libuv always follows an alloc_cb with the read_cb for the same
+// buffer before making the next alloc_cb. That means the unused tail of an
+// allocation can nearly always be handed back to the slab.
+class SlabAllocator {
+ public:
+  static const size_t kSlabSize = 1024 * 1024;
+  // Start a new slab rather than hand out a buffer smaller than this.
+  static const size_t kMinAllocation = 16 * 1024;
+  // Reads up to this size are copied into a Buffer of their own and their
+  // allocation goes straight back to the slab. Small reads are the ones that
+  // tend to be retained (a partial message waiting for the rest, say) and a
+  // single retained Buffer would otherwise keep the entire slab alive.
+  static const size_t kMaxCopySize = 4 * 1024;
+
+  explicit SlabAllocator(size_t slab_size = kSlabSize);
+  ~SlabAllocator();
+
+  void Allocate(size_t suggested_size, uv_buf_t* buf);
+
+  // Turns the first |length| bytes of |buf| into a Buffer. Small reads are
+  // copied out, larger ones reference the slab. The unused part of the
+  // allocation is returned to the slab.
+  v8::Local<v8::Object> Shrink(Environment* env,
+                               const uv_buf_t* buf,
+                               size_t length);
+
+  // Gives back an allocation that didn't receive any data.
+  void Release(const uv_buf_t* buf);
+
+  inline size_t slabs_allocated() const { return slabs_allocated_; }
+  inline size_t buffers_allocated() const { return buffers_allocated_; }
+  inline size_t buffers_copied() const { return buffers_copied_; }
+
+ private:
+  struct Slab;
+
+  static void FreeCallback(char* data, void* hint);
+  static void Unref(Slab* slab);
+  static Slab* SlabOf(const uv_buf_t* buf);
+  bool IsLastAllocation(Slab* slab, const uv_buf_t* buf) const;
+
+  const size_t slab_size_;
+  Slab* slab_;
+  size_t slabs_allocated_;
+  size_t buffers_allocated_;
+  size_t buffers_copied_;
+
+  DISALLOW_COPY_AND_ASSIGN(SlabAllocator);
+};
+
+}  // namespace node
+
+#endif  // SRC_SLAB_ALLOCATOR_H_
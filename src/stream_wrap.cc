@@ -36,6 +36,11 @@
 #include <string.h>  // memcpy()
 #include <limits.h>  // INT_MAX
 
+#if !defined(_WIN32)
+#include <errno.h>  // errno
+#include <unistd.h>  // dup()
+#endif
+
 
 namespace node {
 
@@ -75,6 +80,29 @@ void StreamWrap::Initialize(Handle<Object> target,
   ww->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "WriteWrap"));
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "WriteWrap"),
               ww->GetFunction());
+
+  Local<FunctionTemplate> sfw =
+      FunctionTemplate::New(env->isolate(), SendFileWrap::NewSendFileWrap);
+  sfw->InstanceTemplate()->SetInternalFieldCount(1);
+  sfw->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "SendFileWrap"));
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "SendFileWrap"),
+              sfw->GetFunction());
+
+  env->SetMethod(target, "getReadSlabStats", GetReadSlabStats);
+}
+
+
+void StreamWrap::GetReadSlabStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SlabAllocator* allocator = env->read_slab_allocator();
+  Local<Object> stats = Object::New(env->isolate());
+  stats->Set(env->slabs_string(),
+             Number::New(env->isolate(), allocator->slabs_allocated()));
+  stats->Set(env->buffers_string(),
+             Number::New(env->isolate(), allocator->buffers_allocated()));
+  stats->Set(env->copies_string(),
+             Number::New(env->isolate(), allocator->buffers_copied()));
+  args.GetReturnValue().Set(stats);
 }
 
 
@@ -91,7 +119,8 @@ StreamWrap::StreamWrap(Environment* env,
       stream_(stream),
       default_callbacks_(this),
       callbacks_(&default_callbacks_),
-      callbacks_gc_(false) {
+      callbacks_gc_(false),
+      sendfile_req_(nullptr) {
 }
 
 
@@ -110,8 +139,11 @@ void StreamWrap::GetFD(Local<String>, const PropertyCallbackInfo<Value>& args) {
 
 void StreamWrap::UpdateWriteQueueSize() {
   HandleScope scope(env()->isolate());
+  size_t size = stream()->write_queue_size;
+  if (sendfile_req_ != nullptr)
+    size += sendfile_req_->remaining();
   Local<Integer> write_queue_size =
-      Integer::NewFromUnsigned(env()->isolate(), stream()->write_queue_size);
+      Integer::NewFromUnsigned(env()->isolate(), size);
   object()->Set(env()->write_queue_size_string(), write_queue_size);
 }
 
@@ -214,9 +246,43 @@ size_t StreamWrap::WriteBuffer(Handle<Value> val, uv_buf_t* buf) {
 }
 
 
-void StreamWrap::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
+// Points |buf| at the contents of |string| if they can go out on the wire
+// as-is in |encoding|, the same bytes that StringBytes::Write() would have
+// produced. Only external strings qualify, V8 can move the contents of other
+// strings around. The caller must keep |string| alive until the write is
+// done.
+static bool GetExternalString(Handle<String> string,
+                              enum encoding encoding,
+                              uv_buf_t* buf) {
+  if (string->IsExternalOneByte()) {
+    if (encoding != ASCII &&
+        encoding != BINARY &&
+        encoding != BUFFER &&
+        encoding != UTF8) {
+      return false;
+    }
+    const String::ExternalOneByteStringResource* ext =
+        string->GetExternalOneByteStringResource();
+    *buf = uv_buf_init(const_cast<char*>(ext->data()), ext->length());
+    return true;
+  }
+
+  if (string->IsExternal()) {
+    if (encoding != UCS2 || IsBigEndian())
+      return false;
+    const String::ExternalStringResource* ext =
+        string->GetExternalStringResource();
+    *buf = uv_buf_init(reinterpret_cast<char*>(
+                           const_cast<uint16_t*>(ext->data())),
+                       ext->length() * sizeof(*ext->data()));
+    return true;
+  }
 
+  return false;
+}
+
+
+void StreamWrap::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   StreamWrap* wrap = Unwrap<StreamWrap>(args.Holder());
   if (!IsAlive(wrap))
     return args.GetReturnValue().Set(UV_EINVAL);
@@ -224,15 +290,23 @@ void StreamWrap::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsObject());
   CHECK(Buffer::HasInstance(args[1]));
 
-  Local<Object> req_wrap_obj = args[0].As<Object>();
-  Local<Object> buf_obj = args[1].As<Object>();
+  uv_buf_t buf;
+  WriteBuffer(args[1], &buf);
+  WriteUnownedBuffer(args, wrap, buf);
+}
 
-  size_t length = Buffer::Length(buf_obj);
+
+// Writes memory that is owned by a JS object, the caller is responsible for
+// keeping that object alive until the write request completes.
+void StreamWrap::WriteUnownedBuffer(const FunctionCallbackInfo<Value>& args,
+                                    StreamWrap* wrap,
+                                    uv_buf_t buf) {
+  Environment* env = wrap->env();
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  size_t length = buf.len;
 
   char* storage;
   WriteWrap* req_wrap;
-  uv_buf_t buf;
-  WriteBuffer(buf_obj, &buf);
 
   // Try writing immediately without allocation
   uv_buf_t* bufs = &buf;
@@ -288,6 +362,15 @@ void StreamWrap::WriteStringImpl(const FunctionCallbackInfo<Value>& args) {
   Local<Object> req_wrap_obj = args[0].As<Object>();
   Local<String> string = args[1].As<String>();
 
+  // Large strings that Buffer#toString() created are external, write those
+  // from where they are instead of copying them first.
+  uv_buf_t external;
+  if (!wrap->is_named_pipe_ipc() &&
+      GetExternalString(string, encoding, &external)) {
+    req_wrap_obj->Set(env->buffer_string(), string);  // Keep reference alive.
+    return WriteUnownedBuffer(args, wrap, external);
+  }
+
   // Compute the size of the storage that the string will be flattened into.
   // For UTF8 strings that are very long, go ahead and take the hit for
   // computing their actual size, rather than tripling the storage.
@@ -423,19 +506,29 @@ void StreamWrap::Writev(const FunctionCallbackInfo<Value>& args) {
   uv_buf_t bufs_[16];
   uv_buf_t* bufs = bufs_;
 
-  // Determine storage size first
+  if (ARRAY_SIZE(bufs_) < count)
+    bufs = new uv_buf_t[count];
+
+  // Determine storage size first. Buffers and external strings are written
+  // from where they are, lib/net.js keeps the chunks alive until the write
+  // completes. Other strings are copied into storage.
   size_t storage_size = 0;
   for (size_t i = 0; i < count; i++) {
     Handle<Value> chunk = chunks->Get(i * 2);
 
-    if (Buffer::HasInstance(chunk))
+    if (Buffer::HasInstance(chunk)) {
+      WriteBuffer(chunk, &bufs[i]);
       continue;
-      // Buffer chunk, no additional storage required
+    }
 
     // String chunk
     Handle<String> string = chunk->ToString();
     enum encoding encoding = ParseEncoding(env->isolate(),
                                            chunks->Get(i * 2 + 1));
+    if (GetExternalString(string, encoding, &bufs[i]))
+      continue;
+
+    bufs[i].base = nullptr;
     size_t chunk_size;
     if (encoding == UTF8 && string->Length() > 65535)
       chunk_size = StringBytes::Size(env->isolate(), string, encoding);
@@ -446,13 +539,12 @@ void StreamWrap::Writev(const FunctionCallbackInfo<Value>& args) {
   }
 
   if (storage_size > INT_MAX) {
+    if (bufs != bufs_)
+      delete[] bufs;
     args.GetReturnValue().Set(UV_ENOBUFS);
     return;
   }
 
-  if (ARRAY_SIZE(bufs_) < count)
-    bufs = new uv_buf_t[count];
-
   storage_size += sizeof(WriteWrap);
   char* storage = new char[storage_size];
   WriteWrap* req_wrap =
@@ -463,10 +555,8 @@ void StreamWrap::Writev(const FunctionCallbackInfo<Value>& args) {
   for (size_t i = 0; i < count; i++) {
     Handle<Value> chunk = chunks->Get(i * 2);
 
-    // Write buffer
-    if (Buffer::HasInstance(chunk)) {
-      bufs[i].base = Buffer::Data(chunk);
-      bufs[i].len = Buffer::Length(chunk);
+    // Buffer or external string, see above.
+    if (Buffer::HasInstance(chunk) || bufs[i].base != nullptr) {
       bytes += bufs[i].len;
       continue;
     }
@@ -538,6 +628,65 @@ void StreamWrap::WriteBinaryString(const FunctionCallbackInfo<Value>& args) {
   WriteStringImpl<BINARY>(args);
 }
 
+void StreamWrap::SendFile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  StreamWrap* wrap = Unwrap<StreamWrap>(args.Holder());
+  if (!IsAlive(wrap))
+    return args.GetReturnValue().Set(UV_EINVAL);
+
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsInt32());
+  CHECK(args[2]->IsNumber());
+  CHECK(args[3]->IsNumber());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  uv_file in_fd = args[1]->Int32Value();
+  int64_t offset = args[2]->IntegerValue();
+  size_t length = args[3]->IntegerValue();
+
+#if defined(_WIN32)
+  return args.GetReturnValue().Set(UV_ENOSYS);
+#else
+  // TLS and friends transform the data on its way out, the kernel can't
+  // do that for us unless it is doing the TLS. Let the caller fall back to
+  // read() + write().
+  if (!wrap->callbacks()->CanSendFile())
+    return args.GetReturnValue().Set(UV_ENOTSUP);
+
+  if (wrap->sendfile_req_ != nullptr)
+    return args.GetReturnValue().Set(UV_EBUSY);
+
+  int out_fd = dup(wrap->stream()->io_watcher.fd);
+  if (out_fd == -1)
+    return args.GetReturnValue().Set(-errno);
+
+  SendFileWrap* req_wrap = new SendFileWrap(env,
+                                            req_wrap_obj,
+                                            wrap,
+                                            out_fd,
+                                            in_fd,
+                                            offset,
+                                            length);
+  req_wrap->Dispatched();
+  wrap->sendfile_req_ = req_wrap;
+
+  int err = req_wrap->Send();
+  if (err) {
+    wrap->sendfile_req_ = nullptr;
+    delete req_wrap;
+    uv_fs_t close_req;
+    uv_fs_close(env->event_loop(), &close_req, out_fd, nullptr);
+    uv_fs_req_cleanup(&close_req);
+  } else {
+    wrap->UpdateWriteQueueSize();
+  }
+
+  args.GetReturnValue().Set(err);
+#endif
+}
+
+
 void StreamWrap::SetBlocking(const FunctionCallbackInfo<Value>& args) {
   StreamWrap* wrap = Unwrap<StreamWrap>(args.Holder());
   if (!IsAlive(wrap))
@@ -628,6 +777,155 @@ void StreamWrap::AfterShutdown(uv_shutdown_t* req, int status) {
 }
 
 
+SendFileWrap::SendFileWrap(Environment* env,
+                           Local<Object> obj,
+                           StreamWrap* wrap,
+                           int out_fd,
+                           uv_file in_fd,
+                           int64_t offset,
+                           size_t length)
+    : ReqWrap(env, obj, AsyncWrap::PROVIDER_WRITEWRAP),
+      wrap_(wrap),
+      out_fd_(out_fd),
+      in_fd_(in_fd),
+      offset_(offset),
+      remaining_(length),
+      bytes_(0),
+      status_(0),
+      poll_initialized_(false) {
+  Wrap(obj, this);
+}
+
+
+int SendFileWrap::Send() {
+  return uv_fs_sendfile(env()->event_loop(),
+                        &req_,
+                        out_fd_,
+                        in_fd_,
+                        offset_,
+                        remaining_,
+                        AfterSend);
+}
+
+
+void SendFileWrap::Detach() {
+  wrap_ = nullptr;
+  // Nothing in flight in the thread pool means we're parked on the poll
+  // watcher, waiting for a peer that may never read. Give up now.
+  if (poll_initialized_ && uv_is_active(reinterpret_cast<uv_handle_t*>(&poll_)))
+    Finish(UV_ECANCELED);
+}
+
+
+void SendFileWrap::AfterSend(uv_fs_t* req) {
+  SendFileWrap* req_wrap = ContainerOf(&SendFileWrap::req_, req);
+  ssize_t result = req->result;
+  uv_fs_req_cleanup(req);
+
+  if (req_wrap->wrap_ == nullptr)
+    return req_wrap->Finish(UV_ECANCELED);
+
+  // Hit EOF before the end of the range.
+  if (result == 0)
+    return req_wrap->Finish(0);
+
+  if (result < 0 && result != UV_EAGAIN)
+    return req_wrap->Finish(result);
+
+  if (result > 0) {
+    Environment* env = req_wrap->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    NODE_COUNT_NET_BYTES_SENT(result);
+    req_wrap->offset_ += result;
+    req_wrap->remaining_ -= result;
+    req_wrap->bytes_ += result;
+    req_wrap->wrap_->UpdateWriteQueueSize();
+  }
+
+  if (req_wrap->remaining_ == 0)
+    return req_wrap->Finish(0);
+
+  // The socket buffer is full. Wait until the peer has drained it.
+  int err = req_wrap->WaitWritable();
+  if (err)
+    req_wrap->Finish(err);
+}
+
+
+int SendFileWrap::WaitWritable() {
+  if (!poll_initialized_) {
+    int err = uv_poll_init(env()->event_loop(), &poll_, out_fd_);
+    if (err)
+      return err;
+    poll_initialized_ = true;
+  }
+  return uv_poll_start(&poll_, UV_WRITABLE, OnWritable);
+}
+
+
+void SendFileWrap::OnWritable(uv_poll_t* handle, int status, int events) {
+  SendFileWrap* req_wrap = ContainerOf(&SendFileWrap::poll_, handle);
+  uv_poll_stop(handle);
+
+  if (status == 0)
+    status = req_wrap->Send();
+  if (status)
+    req_wrap->Finish(status);
+}
+
+
+void SendFileWrap::Finish(int status) {
+  status_ = status;
+  if (poll_initialized_) {
+    uv_close(reinterpret_cast<uv_handle_t*>(&poll_), OnPollClose);
+  } else {
+    Complete();
+  }
+}
+
+
+void SendFileWrap::OnPollClose(uv_handle_t* handle) {
+  SendFileWrap* req_wrap =
+      ContainerOf(&SendFileWrap::poll_, reinterpret_cast<uv_poll_t*>(handle));
+  req_wrap->Complete();
+}
+
+
+void SendFileWrap::Complete() {
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  uv_fs_t close_req;
+  uv_fs_close(env->event_loop(), &close_req, out_fd_, nullptr);
+  uv_fs_req_cleanup(&close_req);
+
+  Local<Value> handle = Undefined(env->isolate());
+  if (wrap_ != nullptr) {
+    CHECK_EQ(wrap_->sendfile_req_, this);
+    wrap_->sendfile_req_ = nullptr;
+    wrap_->UpdateWriteQueueSize();
+    handle = wrap_->object();
+  }
+
+  Local<Object> req_wrap_obj = object();
+  req_wrap_obj->Set(env->bytes_string(),
+                    Number::New(env->isolate(), bytes_));
+
+  Local<Value> argv[] = {
+    Integer::New(env->isolate(), status_),
+    handle,
+    req_wrap_obj
+  };
+
+  MakeCallback(env->oncomplete_string(), ARRAY_SIZE(argv), argv);
+
+  delete this;
+}
+
+
 const char* StreamWrapCallbacks::Error() const {
   return nullptr;
 }
@@ -714,14 +1012,7 @@ void StreamWrapCallbacks::AfterWrite(WriteWrap* w) {
 void StreamWrapCallbacks::DoAlloc(uv_handle_t* handle,
                                   size_t suggested_size,
                                   uv_buf_t* buf) {
-  buf->base = static_cast<char*>(malloc(suggested_size));
-  buf->len = suggested_size;
-
-  if (buf->base == nullptr && suggested_size > 0) {
-    FatalError(
-        "node::StreamWrapCallbacks::DoAlloc(uv_handle_t*, size_t, uv_buf_t*)",
-        "Out Of Memory");
-  }
+  wrap()->env()->read_slab_allocator()->Allocate(suggested_size, buf);
 }
 
 
@@ -739,22 +1030,23 @@ void StreamWrapCallbacks::DoRead(uv_stream_t* handle,
     Undefined(env->isolate())
   };
 
+  SlabAllocator* allocator = env->read_slab_allocator();
+
   if (nread < 0)  {
     if (buf->base != nullptr)
-      free(buf->base);
+      allocator->Release(buf);
     wrap()->MakeCallback(env->onread_string(), ARRAY_SIZE(argv), argv);
     return;
   }
 
   if (nread == 0) {
     if (buf->base != nullptr)
-      free(buf->base);
+      allocator->Release(buf);
     return;
   }
 
-  char* base = static_cast<char*>(realloc(buf->base, nread));
   CHECK_LE(static_cast<size_t>(nread), buf->len);
-  argv[1] = Buffer::Use(env, base, nread);
+  argv[1] = allocator->Shrink(env, buf, nread);
 
   Local<Object> pending_obj;
   if (pending == UV_TCP) {
@@ -779,6 +1071,11 @@ int StreamWrapCallbacks::DoShutdown(ShutdownWrap* req_wrap, uv_shutdown_cb cb) {
   return uv_shutdown(&req_wrap->req_, wrap()->stream(), cb);
 }
 
+
+bool StreamWrapCallbacks::CanSendFile() const {
+  return true;
+}
+
 }  // namespace node
 
 NODE_MODULE_CONTEXT_AWARE_BUILTIN(stream_wrap, node::StreamWrap::Initialize)
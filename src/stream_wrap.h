@@ -78,6 +78,53 @@ class WriteWrap: public ReqWrap<uv_write_t> {
   StreamWrap* const wrap_;
 };
 
+// Copies a byte range of a file straight to the socket with sendfile(2).
+// The transfer runs in the thread pool; when the socket buffer fills up,
+// a uv_poll_t watches a dup'ed copy of the socket until it is writable
+// again. The dup'ed descriptor keeps the socket alive for the duration of
+// the transfer, a closed-and-reused fd number can't end up with our data.
+class SendFileWrap : public ReqWrap<uv_fs_t> {
+ public:
+  SendFileWrap(Environment* env,
+               v8::Local<v8::Object> obj,
+               StreamWrap* wrap,
+               int out_fd,
+               uv_file in_fd,
+               int64_t offset,
+               size_t length);
+
+  int Send();
+  // Called when the StreamWrap goes away while the transfer is in flight.
+  void Detach();
+
+  inline size_t remaining() const {
+    return remaining_;
+  }
+
+  static void NewSendFileWrap(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    CHECK(args.IsConstructCall());
+  }
+
+ private:
+  static void AfterSend(uv_fs_t* req);
+  static void OnWritable(uv_poll_t* handle, int status, int events);
+  static void OnPollClose(uv_handle_t* handle);
+
+  int WaitWritable();
+  void Finish(int status);
+  void Complete();
+
+  StreamWrap* wrap_;
+  int out_fd_;
+  uv_file in_fd_;
+  int64_t offset_;
+  size_t remaining_;
+  size_t bytes_;
+  int status_;
+  bool poll_initialized_;
+  uv_poll_t poll_;
+};
+
 // Overridable callbacks' types
 class StreamWrapCallbacks {
  public:
@@ -109,6 +156,10 @@ class StreamWrapCallbacks {
                       uv_handle_type pending);
   virtual int DoShutdown(ShutdownWrap* req_wrap, uv_shutdown_cb cb);
 
+  // True if data written straight to the file descriptor, like sendfile()
+  // does, reaches the other end the same as data passed to DoWrite().
+  virtual bool CanSendFile() const;
+
  protected:
   inline StreamWrap* wrap() const {
     return wrap_;
@@ -134,6 +185,8 @@ class StreamWrap : public HandleWrap {
 
   static void GetFD(v8::Local<v8::String>,
                     const v8::PropertyCallbackInfo<v8::Value>&);
+  static void GetReadSlabStats(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
   // JavaScript functions
   static void ReadStart(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -147,6 +200,7 @@ class StreamWrap : public HandleWrap {
   static void WriteUcs2String(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void WriteBinaryString(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendFile(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void SetBlocking(const v8::FunctionCallbackInfo<v8::Value>& args);
 
@@ -181,6 +235,9 @@ class StreamWrap : public HandleWrap {
              AsyncWrap* parent = nullptr);
 
   ~StreamWrap() {
+    if (sendfile_req_ != nullptr) {
+      sendfile_req_->Detach();
+    }
     if (!callbacks_gc_ && callbacks_ != &default_callbacks_) {
       delete callbacks_;
     }
@@ -206,6 +263,10 @@ class StreamWrap : public HandleWrap {
                            const uv_buf_t* buf,
                            uv_handle_type pending);
 
+  static void WriteUnownedBuffer(
+      const v8::FunctionCallbackInfo<v8::Value>& args,
+      StreamWrap* wrap,
+      uv_buf_t buf);
   template <enum encoding encoding>
   static void WriteStringImpl(const v8::FunctionCallbackInfo<v8::Value>& args);
 
@@ -213,7 +274,9 @@ class StreamWrap : public HandleWrap {
   StreamWrapCallbacks default_callbacks_;
   StreamWrapCallbacks* callbacks_;  // Overridable callbacks
   bool callbacks_gc_;
+  SendFileWrap* sendfile_req_;  // At most one sendfile in flight.
 
+  friend class SendFileWrap;
   friend class StreamWrapCallbacks;
 };
 
@@ -128,6 +128,7 @@ void TCPWrap::Initialize(Handle<Object> target,
   env->SetProtoMethod(t, "writeUcs2String", StreamWrap::WriteUcs2String);
   env->SetProtoMethod(t, "writeBinaryString", StreamWrap::WriteBinaryString);
   env->SetProtoMethod(t, "writev", StreamWrap::Writev);
+  env->SetProtoMethod(t, "sendFile", StreamWrap::SendFile);
 
   env->SetProtoMethod(t, "open", Open);
   env->SetProtoMethod(t, "bind", Bind);
@@ -281,12 +282,13 @@ void TCPWrap::Bind(const FunctionCallbackInfo<Value>& args) {
   TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
   node::Utf8Value ip_address(args[0]);
   int port = args[1]->Int32Value();
+  unsigned int flags = args[2]->Uint32Value();
   sockaddr_in addr;
   int err = uv_ip4_addr(*ip_address, port, &addr);
   if (err == 0) {
     err = uv_tcp_bind(&wrap->handle_,
                       reinterpret_cast<const sockaddr*>(&addr),
-                      0);
+                      flags);
   }
   args.GetReturnValue().Set(err);
 }
@@ -296,12 +298,13 @@ void TCPWrap::Bind6(const FunctionCallbackInfo<Value>& args) {
   TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
   node::Utf8Value ip6_address(args[0]);
   int port = args[1]->Int32Value();
+  unsigned int flags = args[2]->Uint32Value();
   sockaddr_in6 addr;
   int err = uv_ip6_addr(*ip6_address, port, &addr);
   if (err == 0) {
     err = uv_tcp_bind(&wrap->handle_,
                       reinterpret_cast<const sockaddr*>(&addr),
-                      0);
+                      flags);
   }
   args.GetReturnValue().Set(err);
 }
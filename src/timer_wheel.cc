@@ -0,0 +1,257 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "timer_wheel.h"
+#include "util.h"
+
+namespace node {
+
+static inline unsigned CountTrailingZeros(uint64_t bits) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(bits);
+#else
+  unsigned n = 0;
+  while ((bits & 1) == 0) {
+    bits >>= 1;
+    n += 1;
+  }
+  return n;
+#endif
+}
+
+
+TimerWheel::TimerWheel(uint64_t now) : now_(now), count_(0) {
+  for (unsigned i = 0; i < kSlots; i += 1) {
+    head_[i] = kNil;
+    tail_[i] = kNil;
+  }
+  for (unsigned i = 0; i < kSlots / 64; i += 1)
+    occupied_[i] = 0;
+}
+
+
+void TimerWheel::Schedule(uint32_t id, uint64_t expiry) {
+  if (id >= entries_.size()) {
+    Entry entry = { 0, kNil, kNil, kNoSlot };
+    entries_.resize(id + 1, entry);
+  }
+
+  if (entries_[id].slot != kNoSlot)
+    Unlink(id);
+  else
+    count_ += 1;
+
+  entries_[id].expiry = expiry;
+  Link(id);
+}
+
+
+void TimerWheel::Cancel(uint32_t id) {
+  if (!IsScheduled(id))
+    return;
+  Unlink(id);
+  entries_[id].slot = kNoSlot;
+  count_ -= 1;
+}
+
+
+void TimerWheel::Advance(uint64_t now, std::vector<uint32_t>* expired) {
+  while (now_ <= now) {
+    unsigned index = now_ & (kRootSlots - 1);
+    uint32_t id = head_[index];
+
+    if (id != kNil) {
+      head_[index] = kNil;
+      tail_[index] = kNil;
+      occupied_[index / 64] &= ~(static_cast<uint64_t>(1) << (index % 64));
+      while (id != kNil) {
+        Entry* entry = &entries_[id];
+        expired->push_back(id);
+        entry->slot = kNoSlot;
+        count_ -= 1;
+        id = entry->next;
+      }
+    }
+
+    // Skip the empty slots, but stop at the end of the root level; that's
+    // where the next batch of timers cascades down.
+    int next = FindSlot(0, index + 1);
+    uint64_t step = (next == -1 ? kRootSlots : next) - index;
+    if (step > now - now_ + 1)
+      step = now - now_ + 1;
+    now_ += step;
+
+    if ((now_ & (kRootSlots - 1)) == 0)
+      Cascade();
+  }
+}
+
+
+uint64_t TimerWheel::NextExpiry() const {
+  if (count_ == 0)
+    return kNever;
+
+  // |t| is the first tick whose slot in |level| hasn't been processed yet.
+  // For the upper levels, that's the tick at which the slot cascades down.
+  uint64_t best = kNever;
+  uint64_t t = now_;
+
+  for (unsigned level = 0; level < kLevels; level += 1) {
+    const unsigned shift = Shift(level);
+    const unsigned bits = Bits(level);
+    const unsigned index = (t >> shift) & ((1 << bits) - 1);
+
+    int slot = FindSlot(level, index);
+    if (slot != -1) {
+      uint64_t when = t + (static_cast<uint64_t>(slot - index) << shift);
+      if (when < best)
+        best = when;
+    }
+
+    // At the start of a lap, the level above cascades at |t| as well.
+    if (level > 0 && index == 0)
+      continue;
+
+    // Otherwise the level above won't do anything before this level wraps.
+    if (slot != -1)
+      break;
+
+    // Slots before |index| come around again after the wrap.
+    const uint64_t wrap = ((t >> (shift + bits)) + 1) << (shift + bits);
+    slot = FindSlot(level, 0);
+    if (slot != -1) {
+      uint64_t when = wrap + (static_cast<uint64_t>(slot) << shift);
+      if (when < best)
+        best = when;
+    }
+
+    t = wrap;
+  }
+
+  return best;
+}
+
+
+void TimerWheel::Reset(uint64_t now) {
+  CHECK(empty());
+  now_ = now;
+}
+
+
+void TimerWheel::Link(uint32_t id) {
+  Entry* entry = &entries_[id];
+  uint64_t expiry = entry->expiry < now_ ? now_ : entry->expiry;
+  uint64_t delta = expiry - now_;
+  unsigned slot;
+
+  if (delta < kRootSlots) {
+    slot = expiry & (kRootSlots - 1);
+  } else {
+    const uint64_t max = (static_cast<uint64_t>(1) << Shift(kLevels)) - 1;
+    if (delta > max) {
+      // Parked in the top level, it cascades back up until it's due.
+      expiry = now_ + max;
+      delta = max;
+    }
+    unsigned level = 1;
+    while (level < kLevels - 1 &&
+           delta >= (static_cast<uint64_t>(1) << Shift(level + 1))) {
+      level += 1;
+    }
+    slot = Base(level) + ((expiry >> Shift(level)) & (kLevelSlots - 1));
+  }
+
+  entry->slot = slot;
+  entry->next = kNil;
+  entry->prev = tail_[slot];
+  if (tail_[slot] == kNil)
+    head_[slot] = id;
+  else
+    entries_[tail_[slot]].next = id;
+  tail_[slot] = id;
+  occupied_[slot / 64] |= static_cast<uint64_t>(1) << (slot % 64);
+}
+
+
+void TimerWheel::Unlink(uint32_t id) {
+  Entry* entry = &entries_[id];
+  const unsigned slot = entry->slot;
+
+  if (entry->prev == kNil)
+    head_[slot] = entry->next;
+  else
+    entries_[entry->prev].next = entry->next;
+
+  if (entry->next == kNil)
+    tail_[slot] = entry->prev;
+  else
+    entries_[entry->next].prev = entry->prev;
+
+  if (head_[slot] == kNil)
+    occupied_[slot / 64] &= ~(static_cast<uint64_t>(1) << (slot % 64));
+}
+
+
+// Called when the root level wraps around. Moves the timers in the current
+// slot of the next level down, which in turn may wrap around, and so on.
+void TimerWheel::Cascade() {
+  for (unsigned level = 1; level < kLevels; level += 1) {
+    const unsigned index = (now_ >> Shift(level)) & (kLevelSlots - 1);
+    const unsigned slot = Base(level) + index;
+    uint32_t id = head_[slot];
+
+    head_[slot] = kNil;
+    tail_[slot] = kNil;
+    occupied_[slot / 64] &= ~(static_cast<uint64_t>(1) << (slot % 64));
+
+    while (id != kNil) {
+      uint32_t next = entries_[id].next;
+      Link(id);
+      id = next;
+    }
+
+    if (index != 0)
+      break;
+  }
+}
+
+
+int TimerWheel::FindSlot(unsigned level, unsigned from) const {
+  const unsigned nslots = 1 << Bits(level);
+  if (from >= nslots)
+    return -1;
+
+  const unsigned base = Base(level);
+  const unsigned end = (base + nslots) / 64;
+  unsigned word = (base + from) / 64;
+  uint64_t bits = occupied_[word] & (~static_cast<uint64_t>(0) << (from % 64));
+
+  for (;;) {
+    if (bits != 0)
+      return word * 64 + CountTrailingZeros(bits) - base;
+    word += 1;
+    if (word == end)
+      return -1;
+    bits = occupied_[word];
+  }
+}
+
+}  // namespace node
@@ -0,0 +1,123 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_TIMER_WHEEL_H_
+#define SRC_TIMER_WHEEL_H_
+
+#include "util.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace node {
+
+// Hierarchical timing wheel with millisecond ticks. Timers are identified by
+// small integers that the caller allocates; scheduling, rescheduling and
+// canceling a timer are O(1) no matter how many timers exist or how their
+// timeouts are spread out.
+//
+// The first level has a slot for each of the next 256 ticks. The four levels
+// above it have 64 slots each, every slot covering 64 times the span of a
+// slot one level down. Timers in the upper levels are moved down (cascaded)
+// when the wheel reaches the start of their slot, so a timer is touched at
+// most four more times before it expires.
+class TimerWheel {
+ public:
+  static const uint64_t kNever = static_cast<uint64_t>(-1);
+
+  explicit TimerWheel(uint64_t now);
+
+  // Arms timer |id| to expire at |expiry|. Rearms it if it is already
+  // scheduled. Timers with an expiry in the past expire on the next Advance().
+  void Schedule(uint32_t id, uint64_t expiry);
+  void Cancel(uint32_t id);
+
+  // Moves the clock forward to |now| and appends the timers that expired to
+  // |expired|, ordered by expiry. Expired timers are no longer scheduled.
+  void Advance(uint64_t now, std::vector<uint32_t>* expired);
+
+  // The time at which Advance() has work to do: the expiry of the earliest
+  // timer or an earlier cascade point. kNever if the wheel is empty.
+  uint64_t NextExpiry() const;
+
+  // Resets the clock of an empty wheel, it won't have to catch up later.
+  void Reset(uint64_t now);
+
+  inline bool IsScheduled(uint32_t id) const {
+    return id < entries_.size() && entries_[id].slot != kNoSlot;
+  }
+
+  inline uint64_t expiry(uint32_t id) const {
+    return entries_[id].expiry;
+  }
+
+  inline bool empty() const { return count_ == 0; }
+  inline size_t size() const { return count_; }
+
+ private:
+  static const unsigned kLevels = 5;
+  static const unsigned kRootBits = 8;
+  static const unsigned kLevelBits = 6;
+  static const unsigned kRootSlots = 1 << kRootBits;
+  static const unsigned kLevelSlots = 1 << kLevelBits;
+  static const unsigned kSlots = kRootSlots + (kLevels - 1) * kLevelSlots;
+  static const uint32_t kNil = static_cast<uint32_t>(-1);
+  static const uint16_t kNoSlot = static_cast<uint16_t>(-1);
+
+  struct Entry {
+    uint64_t expiry;
+    uint32_t prev;
+    uint32_t next;
+    uint16_t slot;
+  };
+
+  static inline unsigned Shift(unsigned level) {
+    return level == 0 ? 0 : kRootBits + (level - 1) * kLevelBits;
+  }
+
+  static inline unsigned Bits(unsigned level) {
+    return level == 0 ? kRootBits : kLevelBits;
+  }
+
+  static inline unsigned Base(unsigned level) {
+    return level == 0 ? 0 : kRootSlots + (level - 1) * kLevelSlots;
+  }
+
+  void Link(uint32_t id);
+  void Unlink(uint32_t id);
+  void Cascade();
+  // First occupied slot >= |from| in |level|, or -1.
+  int FindSlot(unsigned level, unsigned from) const;
+
+  std::vector<Entry> entries_;
+  uint32_t head_[kSlots];
+  uint32_t tail_[kSlots];
+  uint64_t occupied_[kSlots / 64];
+  uint64_t now_;  // Every tick before |now_| has been processed.
+  size_t count_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+}  // namespace node
+
+#endif  // SRC_TIMER_WHEEL_H_
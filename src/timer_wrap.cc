@@ -19,6 +19,8 @@
 // OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
 // USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+#include "timer_wheel.h"
+
 #include "async-wrap.h"
 #include "async-wrap-inl.h"
 #include "env.h"
@@ -28,9 +30,11 @@
 #include "util-inl.h"
 
 #include <stdint.h>
+#include <vector>
 
 namespace node {
 
+using v8::Array;
 using v8::Context;
 using v8::Function;
 using v8::FunctionCallbackInfo;
@@ -154,6 +158,159 @@ class TimerWrap : public HandleWrap {
 };
 
 
+// Runs any number of timeouts off a single uv_timer_t. lib/timers.js numbers
+// the timeouts itself and gets back the numbers of those that expired, in
+// expiry order, with one callback per expiry run.
+class TimerWheelWrap : public HandleWrap {
+ public:
+  static void Initialize(Environment* env, Handle<Object> target) {
+    Local<FunctionTemplate> constructor = env->NewFunctionTemplate(New);
+    constructor->InstanceTemplate()->SetInternalFieldCount(1);
+    constructor->SetClassName(
+        FIXED_ONE_BYTE_STRING(env->isolate(), "TimerWheel"));
+    constructor->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnTimeout"),
+                     Integer::New(env->isolate(), kOnTimeout));
+
+    env->SetProtoMethod(constructor, "close", HandleWrap::Close);
+    env->SetProtoMethod(constructor, "ref", HandleWrap::Ref);
+    env->SetProtoMethod(constructor, "unref", HandleWrap::Unref);
+
+    env->SetProtoMethod(constructor, "start", Start);
+    env->SetProtoMethod(constructor, "stop", Stop);
+
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "TimerWheel"),
+                constructor->GetFunction());
+  }
+
+ private:
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.IsConstructCall());
+    Environment* env = Environment::GetCurrent(args);
+    new TimerWheelWrap(env, args.This());
+  }
+
+  TimerWheelWrap(Environment* env, Handle<Object> object)
+      : HandleWrap(env,
+                   object,
+                   reinterpret_cast<uv_handle_t*>(&handle_),
+                   AsyncWrap::PROVIDER_TIMERWRAP),
+        wheel_(uv_now(env->event_loop())),
+        due_(TimerWheel::kNever) {
+    int r = uv_timer_init(env->event_loop(), &handle_);
+    CHECK_EQ(r, 0);
+  }
+
+  // start(id, msecs, slack[, start]) arms or rearms timeout |id|. Returns
+  // the start time, the same value Timer.now() would have returned, or
+  // |start| when it is given: a timeout that moves to another wheel keeps
+  // the start time and the expiry it had.
+  //
+  // A non-zero |slack| lets the timeout fire up to |slack| - 1 milliseconds
+  // late: the expiry is rounded up to a multiple of |slack|, so timeouts with
+  // the same slack expire together, with one wakeup and one callback. It also
+  // makes most rearms no-ops, the expiry doesn't change until the clock
+  // moves into the next bucket.
+  static void Start(const FunctionCallbackInfo<Value>& args) {
+    TimerWheelWrap* wrap = Unwrap<TimerWheelWrap>(args.Holder());
+    uv_loop_t* loop = wrap->env()->event_loop();
+
+    uint32_t id = args[0]->Uint32Value();
+    int64_t timeout = args[1]->IntegerValue();
+    int64_t slack = args[2]->IntegerValue();
+    if (timeout < 0)
+      timeout = 0;
+
+    uv_update_time(loop);
+    uint64_t now = uv_now(loop);
+    uint64_t start = now;
+    if (args[3]->IsNumber() && args[3]->IntegerValue() >= 0)
+      start = args[3]->IntegerValue();
+    uint64_t expiry = start + timeout;
+
+    if (slack > 1) {
+      expiry += slack - 1;
+      expiry -= expiry % slack;
+    }
+
+    if (wrap->wheel_.empty())
+      wrap->wheel_.Reset(now);
+
+    if (!wrap->wheel_.IsScheduled(id) || wrap->wheel_.expiry(id) != expiry) {
+      wrap->wheel_.Schedule(id, expiry);
+      // Leave the uv_timer_t alone unless this timeout is due before it.
+      if (expiry < wrap->due_)
+        wrap->Arm(wrap->wheel_.NextExpiry(), now);
+    }
+
+    // A double is exact up to 2^53 ms and V8 stores small integral values
+    // as Smis anyway, no need for a separate uint32_t case.
+    args.GetReturnValue().Set(static_cast<double>(start));
+  }
+
+  static void Stop(const FunctionCallbackInfo<Value>& args) {
+    TimerWheelWrap* wrap = Unwrap<TimerWheelWrap>(args.Holder());
+
+    wrap->wheel_.Cancel(args[0]->Uint32Value());
+    // An early wakeup is harmless but an empty wheel must not keep
+    // the event loop alive.
+    if (wrap->wheel_.empty())
+      wrap->Disarm();
+  }
+
+  void Arm(uint64_t due, uint64_t now) {
+    due_ = due;
+    uv_timer_start(&handle_, OnTimeout, due > now ? due - now : 0, 0);
+  }
+
+  void Disarm() {
+    due_ = TimerWheel::kNever;
+    uv_timer_stop(&handle_);
+  }
+
+  static void OnTimeout(uv_timer_t* handle) {
+    TimerWheelWrap* wrap = static_cast<TimerWheelWrap*>(handle->data);
+    Environment* env = wrap->env();
+    std::vector<uint32_t>* expired = &wrap->expired_;
+
+    wrap->due_ = TimerWheel::kNever;
+    expired->clear();
+    wrap->wheel_.Advance(uv_now(env->event_loop()), expired);
+
+    if (!expired->empty()) {
+      HandleScope handle_scope(env->isolate());
+      Context::Scope context_scope(env->context());
+      Local<Array> ids = Array::New(env->isolate(), expired->size());
+      for (size_t i = 0; i < expired->size(); i += 1)
+        ids->Set(i, Integer::NewFromUnsigned(env->isolate(), (*expired)[i]));
+      Local<Value> argv[] = { ids };
+      wrap->MakeCallback(kOnTimeout, ARRAY_SIZE(argv), argv);
+    }
+
+    // The callback may have armed the timer for a new timeout already but
+    // that doesn't account for the timeouts that are still pending.
+    uint64_t next = wrap->wheel_.NextExpiry();
+    if (next == TimerWheel::kNever)
+      wrap->Disarm();
+    else if (next != wrap->due_)
+      wrap->Arm(next, uv_now(env->event_loop()));
+  }
+
+  uv_timer_t handle_;
+  TimerWheel wheel_;
+  uint64_t due_;
+  std::vector<uint32_t> expired_;
+};
+
+
+static void Initialize(Handle<Object> target,
+                       Handle<Value> unused,
+                       Handle<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  TimerWrap::Initialize(target, unused, context);
+  TimerWheelWrap::Initialize(env, target);
+}
+
+
 }  // namespace node
 
-NODE_MODULE_CONTEXT_AWARE_BUILTIN(timer_wrap, node::TimerWrap::Initialize)
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(timer_wrap, node::Initialize)
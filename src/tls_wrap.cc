@@ -33,6 +33,33 @@
 #include "util.h"
 #include "util-inl.h"
 
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/tls.h>)
+#include <linux/tls.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <errno.h>
+// TLS_RX and record types need Linux 4.17 headers. The key derivation
+// relies on OpenSSL internals that only the bundled 1.0.1 is known to have,
+// see GetPRFDigest().
+#if defined(TLS_RX) && defined(TLS_GET_RECORD_TYPE) && \
+    !defined(NODE_SHARED_OPENSSL) && \
+    (OPENSSL_VERSION_NUMBER >> 12) == 0x10001
+#define NODE_HAVE_KERNEL_TLS 1
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#endif  // defined(TLS_RX) && defined(TLS_GET_RECORD_TYPE) && ...
+#endif  // __has_include(<linux/tls.h>)
+#endif  // defined(__linux__) && defined(__has_include)
+
 namespace node {
 
 using crypto::SSLWrap;
@@ -41,6 +68,7 @@ using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::Exception;
+using v8::False;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -50,8 +78,74 @@ using v8::Integer;
 using v8::Local;
 using v8::Null;
 using v8::Object;
+using v8::Persistent;
 using v8::String;
+using v8::True;
 using v8::Value;
+using v8::WeakCallbackData;
+
+
+// SSL_get_ex_data() index of the HandshakeWork, see OffloadHandshake().
+static int handshake_work_index = -1;
+
+
+class TLSCallbacks::HandshakeWork {
+ public:
+  explicit HandshakeWork(TLSCallbacks* callbacks)
+      : callbacks_(callbacks),
+        stream_(callbacks->env()->isolate(), callbacks->wrap()->object()),
+        ssl_(callbacks->ssl_),
+        owns_ssl_(false),
+        info_(0),
+#ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+        sni_context_(nullptr),
+#endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+        error_(nullptr) {
+    req_.data = this;
+    stream_.SetWeak(this, OnStreamGone);
+  }
+
+  ~HandshakeWork() {
+    stream_.Reset();
+    if (owns_ssl_)
+      SSL_free(ssl_);
+#ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+    if (sni_context_ != nullptr)
+      SSL_CTX_free(sni_context_);
+#endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+    delete[] error_;
+  }
+
+  static void OnStreamGone(
+      const WeakCallbackData<Object, HandshakeWork>& data) {
+    data.GetParameter()->stream_.Reset();
+  }
+
+  static HandshakeWork* FromSSL(SSL* ssl) {
+    void* work = SSL_get_ex_data(ssl, handshake_work_index);
+    CHECK_NE(work, nullptr);
+    return static_cast<HandshakeWork*>(work);
+  }
+
+  uv_work_t req_;
+  TLSCallbacks* callbacks_;  // nullptr when the callbacks are gone.
+  // The callbacks outlive the socket, tells if the socket is still there.
+  // Weak, it mustn't keep the socket and with it the callbacks alive.
+  Persistent<Object> stream_;
+  SSL* const ssl_;
+  // Set when the callbacks went away while the work was running, the SSL
+  // object is freed with the work then.
+  bool owns_ssl_;
+  // SSLInfoCallback() events seen on the threadpool, replayed afterwards.
+  int info_;
+#ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+  // The context SelectSNIContextCallback() switches to, holds a reference.
+  SSL_CTX* sni_context_;
+#endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+  // The text of the OpenSSL error queue if the handshake failed, the queue is
+  // per thread so it has to be read on the threadpool.
+  char* error_;
+};
 
 
 TLSCallbacks::TLSCallbacks(Environment* env,
@@ -74,7 +168,19 @@ TLSCallbacks::TLSCallbacks(Environment* env,
       shutdown_(false),
       error_(nullptr),
       cycle_depth_(0),
-      eof_(false) {
+      eof_(false),
+      record_size_(kLargeRecordSize),
+      burst_size_(0),
+      last_write_(0),
+      handshake_offload_(false),
+      handshake_work_(nullptr),
+      offload_in_(nullptr),
+      offload_nread_(0),
+      kernel_tls_(false),
+      kernel_rx_(false),
+      kernel_tx_(false),
+      pending_shutdown_(nullptr),
+      pending_shutdown_cb_(nullptr) {
   node::Wrap(object(), this);
   MakeWeak(this);
 
@@ -91,10 +197,25 @@ TLSCallbacks::TLSCallbacks(Environment* env,
 
 
 TLSCallbacks::~TLSCallbacks() {
+  // AfterHandshakeWork() cleans up the work. If the work hasn't started it
+  // never will and ~SSLWrap() frees the SSL object, otherwise the work is
+  // still using it and frees it. Nothing on the threadpool touches |this|.
+  if (handshake_work_ != nullptr) {
+    uv_req_t* req = reinterpret_cast<uv_req_t*>(&handshake_work_->req_);
+    if (uv_cancel(req) != 0) {
+      handshake_work_->owns_ssl_ = true;
+      ssl_ = nullptr;
+    }
+    handshake_work_->callbacks_ = nullptr;
+    handshake_work_ = nullptr;
+  }
+
   enc_in_ = nullptr;
   enc_out_ = nullptr;
   delete clear_in_;
   clear_in_ = nullptr;
+  delete offload_in_;
+  offload_in_ = nullptr;
 
   sc_ = nullptr;
   sc_handle_.Reset();
@@ -157,6 +278,22 @@ bool TLSCallbacks::InvokeQueued(int status) {
 }
 
 
+void TLSCallbacks::DoPendingShutdown() {
+  if (pending_shutdown_ == nullptr)
+    return;
+
+  ShutdownWrap* req_wrap = pending_shutdown_;
+  uv_shutdown_cb cb = pending_shutdown_cb_;
+  pending_shutdown_ = nullptr;
+  pending_shutdown_cb_ = nullptr;
+  int err = DoShutdown(req_wrap, cb);
+  if (err) {
+    req_wrap->req_.handle = wrap()->stream();
+    cb(&req_wrap->req_, err);
+  }
+}
+
+
 void TLSCallbacks::NewSessionDoneCb() {
   Cycle();
 }
@@ -166,6 +303,8 @@ void TLSCallbacks::InitSSL() {
   // Initialize SSL
   enc_in_ = NodeBIO::New();
   enc_out_ = NodeBIO::New();
+  NodeBIO::FromBIO(enc_in_)->set_pool(env()->tls_buffer_pool());
+  NodeBIO::FromBIO(enc_out_)->set_pool(env()->tls_buffer_pool());
 
   SSL_set_bio(ssl_, enc_in_, enc_out_);
 
@@ -201,6 +340,7 @@ void TLSCallbacks::InitSSL() {
 
   // Initialize ring for queud clear data
   clear_in_ = new NodeBIO();
+  clear_in_->set_pool(env()->tls_buffer_pool());
 }
 
 
@@ -285,23 +425,35 @@ void TLSCallbacks::SSLInfoCallback(const SSL* ssl_, int where, int ret) {
   // a non-const SSL* in OpenSSL <= 0.9.7e.
   SSL* ssl = const_cast<SSL*>(ssl_);
   TLSCallbacks* c = static_cast<TLSCallbacks*>(SSL_get_app_data(ssl));
-  Environment* env = c->env();
+
+  // On the threadpool, AfterHandshakeWork() delivers the events.
+  if (c == nullptr) {
+    HandshakeWork::FromSSL(ssl)->info_ |= where;
+    return;
+  }
+
+  c->OnHandshakeInfo(where);
+}
+
+
+void TLSCallbacks::OnHandshakeInfo(int where) {
+  Environment* env = this->env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
-  Local<Object> object = c->object();
+  Local<Object> object = this->object();
 
   if (where & SSL_CB_HANDSHAKE_START) {
     Local<Value> callback = object->Get(env->onhandshakestart_string());
     if (callback->IsFunction()) {
-      c->MakeCallback(callback.As<Function>(), 0, nullptr);
+      MakeCallback(callback.As<Function>(), 0, nullptr);
     }
   }
 
   if (where & SSL_CB_HANDSHAKE_DONE) {
-    c->established_ = true;
+    established_ = true;
     Local<Value> callback = object->Get(env->onhandshakedone_string());
     if (callback->IsFunction()) {
-      c->MakeCallback(callback.As<Function>(), 0, nullptr);
+      MakeCallback(callback.As<Function>(), 0, nullptr);
     }
   }
 }
@@ -312,6 +464,14 @@ void TLSCallbacks::EncOut() {
   if (!hello_parser_.IsEnded())
     return;
 
+  // The handshake is writing to enc_out_ on the threadpool
+  if (handshake_work_ != nullptr)
+    return;
+
+  // The kernel does the writing
+  if (kernel_tx_)
+    return;
+
   // Write in progress
   if (write_size_ != 0)
     return;
@@ -374,6 +534,7 @@ void TLSCallbacks::EncOutCb(uv_write_t* req, int status) {
   // Try writing more data
   callbacks->write_size_ = 0;
   callbacks->EncOut();
+  callbacks->MaybeEnableKernelTLS();
 }
 
 
@@ -419,6 +580,166 @@ Local<Value> TLSCallbacks::GetSSLError(int status, int* err, const char** msg) {
 }
 
 
+// OpenSSL 1.0.1 can't suspend a handshake halfway through a private key
+// operation, so servers that opt in run the whole SSL_do_handshake() step on
+// the threadpool instead. That step does the RSA or ECDSA signature for the
+// server's first flight and the RSA decryption of the client's key exchange,
+// expensive enough to stall every other connection when a lot of clients
+// connect at once.
+//
+// While the work runs the SSL object and enc_in_/enc_out_ belong to the
+// threadpool: socket data goes to offload_in_, writes queue up in clear_in_
+// and OpenSSL callbacks that would call into JS are either resolved up front
+// (SNI context) or replayed afterwards (SSLInfoCallback). Connections with JS
+// in the handshake itself - session and OCSP events, NPN - don't offload.
+//
+// The SSL object has no app data while the work runs, the callbacks find the
+// HandshakeWork instead. That way the callbacks can be destroyed without
+// waiting for the work, see ~TLSCallbacks().
+bool TLSCallbacks::OffloadHandshake() {
+  if (handshake_work_ != nullptr)
+    return true;
+
+  if (!handshake_offload_ || established_ || session_callbacks_)
+    return false;
+
+#ifdef OPENSSL_NPN_NEGOTIATED
+  if (!npn_protos_.IsEmpty())
+    return false;
+#endif  // OPENSSL_NPN_NEGOTIATED
+
+#ifdef NODE__HAVE_TLSEXT_STATUS_CB
+  if (!ocsp_response_.IsEmpty())
+    return false;
+#endif  // NODE__HAVE_TLSEXT_STATUS_CB
+
+  // Nothing to do, or enc_out_ is still being written to the socket.
+  if (BIO_pending(enc_in_) == 0 || write_size_ != 0)
+    return false;
+
+  HandleScope handle_scope(env()->isolate());
+
+#ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+  SecureContext* sni_context = nullptr;
+  Local<Value> ctx = object()->Get(env()->sni_context_string());
+  if (ctx->IsObject()) {
+    // Let SelectSNIContextCallback() report it.
+    if (!env()->secure_context_constructor_template()->HasInstance(ctx))
+      return false;
+    sni_context_.Reset(env()->isolate(), ctx);
+    sni_context = Unwrap<SecureContext>(ctx.As<Object>());
+    InitNPN(sni_context);
+  }
+#endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+
+  if (offload_in_ == nullptr) {
+    offload_in_ = new NodeBIO();
+    offload_in_->set_pool(env()->tls_buffer_pool());
+  }
+
+  handshake_work_ = new HandshakeWork(this);
+#ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+  if (sni_context != nullptr) {
+    CRYPTO_add(&sni_context->ctx_->references, 1, CRYPTO_LOCK_SSL_CTX);
+    handshake_work_->sni_context_ = sni_context->ctx_;
+  }
+#endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+  SSL_set_app_data(ssl_, nullptr);
+  SSL_set_ex_data(ssl_, handshake_work_index, handshake_work_);
+  int err = uv_queue_work_ex(env()->event_loop(),
+                             &handshake_work_->req_,
+                             UV_WORK_CPU,
+                             DoHandshakeWork,
+                             AfterHandshakeWork);
+  CHECK_EQ(err, 0);
+
+  return true;
+}
+
+
+void TLSCallbacks::DoHandshakeWork(uv_work_t* req) {
+  HandshakeWork* work = static_cast<HandshakeWork*>(req->data);
+
+  int status = SSL_do_handshake(work->ssl_);
+  int err = SSL_get_error(work->ssl_, status);
+  if (err == SSL_ERROR_SSL || err == SSL_ERROR_SYSCALL) {
+    BIO* bio = BIO_new(BIO_s_mem());
+    ERR_print_errors(bio);
+
+    BUF_MEM* mem;
+    BIO_get_mem_ptr(bio, &mem);
+
+    work->error_ = new char[mem->length + 1];
+    memcpy(work->error_, mem->data, mem->length);
+    work->error_[mem->length] = '\0';
+    BIO_free_all(bio);
+  }
+  ERR_clear_error();
+}
+
+
+void TLSCallbacks::AfterHandshakeWork(uv_work_t* req, int status) {
+  HandshakeWork* work = static_cast<HandshakeWork*>(req->data);
+  TLSCallbacks* c = work->callbacks_;
+
+  if (c == nullptr) {
+    delete work;
+    return;
+  }
+
+  CHECK_EQ(c->handshake_work_, work);
+  c->handshake_work_ = nullptr;
+  SSL_set_ex_data(c->ssl_, handshake_work_index, nullptr);
+  SSL_set_app_data(c->ssl_, c);
+
+  Environment* env = c->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  // The socket was closed while the work ran, c->wrap() is gone.
+  if (work->stream_.IsEmpty() ||
+      !HandleWrap::IsAlive(Unwrap<HandleWrap>(
+          PersistentToLocal(env->isolate(), work->stream_)))) {
+    delete work;
+    return;
+  }
+
+  // Give OpenSSL what came in while the work ran.
+  NodeBIO* enc_in = NodeBIO::FromBIO(c->enc_in_);
+  while (c->offload_in_->Length() > 0) {
+    size_t avail = 0;
+    char* data = c->offload_in_->Peek(&avail);
+    enc_in->Write(data, avail);
+    c->offload_in_->Read(nullptr, avail);
+  }
+
+  if (work->info_ != 0)
+    c->OnHandshakeInfo(work->info_);
+
+  Local<Value> error;
+  if (work->error_ != nullptr)
+    error = Exception::Error(OneByteString(env->isolate(), work->error_));
+  delete work;
+
+  if (!error.IsEmpty()) {
+    // Flush the alert before the socket is destroyed, like ClearOut() does.
+    c->EncOut();
+    c->MakeCallback(env->onerror_string(), 1, &error);
+  }
+
+  c->DoPendingShutdown();
+
+  if (error.IsEmpty())
+    c->Cycle();
+
+  if (c->offload_nread_ != 0) {
+    ssize_t nread = c->offload_nread_;
+    c->offload_nread_ = 0;
+    c->DoRead(c->wrap()->stream(), nread, nullptr, UV_UNKNOWN_HANDLE);
+  }
+}
+
+
 void TLSCallbacks::ClearOut() {
   // Ignore cycling data if ClientHello wasn't yet parsed
   if (!hello_parser_.IsEnded())
@@ -428,6 +749,13 @@ void TLSCallbacks::ClearOut() {
   if (eof_)
     return;
 
+  // The kernel does the reading
+  if (kernel_rx_)
+    return;
+
+  if (OffloadHandshake())
+    return;
+
   HandleScope handle_scope(env()->isolate());
   Context::Scope context_scope(env()->context());
 
@@ -478,15 +806,19 @@ bool TLSCallbacks::ClearIn() {
   if (!hello_parser_.IsEnded())
     return false;
 
+  // Keep it queued until the handshake is back from the threadpool
+  if (handshake_work_ != nullptr)
+    return false;
+
   int written = 0;
   while (clear_in_->Length() > 0) {
     size_t avail = 0;
     char* data = clear_in_->Peek(&avail);
-    written = SSL_write(ssl_, data, avail);
-    CHECK(written == -1 || written == static_cast<int>(avail));
+    written = SSLWrite(data, avail);
+    CHECK(written == -1 || written > 0);
     if (written == -1)
       break;
-    clear_in_->Read(nullptr, avail);
+    clear_in_->Read(nullptr, written);
   }
 
   // All written
@@ -512,6 +844,35 @@ bool TLSCallbacks::ClearIn() {
 }
 
 
+int TLSCallbacks::SSLWrite(const char* data, size_t len) {
+#ifdef SSL_set_max_send_fragment
+  // Leave the record size alone once the application has picked one.
+  if (!max_send_fragment_set_) {
+    uint64_t now = uv_now(env()->event_loop());
+    if (now - last_write_ > kRecordBurstTimeout)
+      burst_size_ = 0;
+    last_write_ = now;
+
+    unsigned int record_size = kLargeRecordSize;
+    if (burst_size_ < kSmallRecordBurst) {
+      record_size = kSmallRecordSize;
+      if (len > kSmallRecordBurst - burst_size_)
+        len = kSmallRecordBurst - burst_size_;
+    }
+    if (record_size != record_size_) {
+      SSL_set_max_send_fragment(ssl_, record_size);
+      record_size_ = record_size;
+    }
+  }
+#endif  // SSL_set_max_send_fragment
+
+  int written = SSL_write(ssl_, data, len);
+  if (written > 0)
+    burst_size_ += written;
+  return written;
+}
+
+
 const char* TLSCallbacks::Error() const {
   return error_;
 }
@@ -524,6 +885,9 @@ void TLSCallbacks::ClearError() {
 
 
 int TLSCallbacks::TryWrite(uv_buf_t** bufs, size_t* count) {
+  if (kernel_tx_)
+    return StreamWrapCallbacks::TryWrite(bufs, count);
+
   // TODO(indutny): Support it
   return 0;
 }
@@ -536,6 +900,19 @@ int TLSCallbacks::DoWrite(WriteWrap* w,
                           uv_write_cb cb) {
   CHECK_EQ(send_handle, nullptr);
 
+  if (kernel_tx_)
+    return StreamWrapCallbacks::DoWrite(w, bufs, count, send_handle, cb);
+
+  // Leave the SSL object alone while the handshake runs on the threadpool,
+  // queue everything. AfterHandshakeWork() cycles it through.
+  if (handshake_work_ != nullptr) {
+    WriteItem* wi = new WriteItem(w, cb);
+    QUEUE_INSERT_TAIL(&write_item_queue_, &wi->member_);
+    for (size_t i = 0; i < count; i++)
+      clear_in_->Write(bufs[i].base, bufs[i].len);
+    return 0;
+  }
+
   bool empty = true;
 
   // Empty writes should not go through encryption process
@@ -572,9 +949,14 @@ int TLSCallbacks::DoWrite(WriteWrap* w,
   }
 
   int written = 0;
+  size_t offset = 0;
   for (i = 0; i < count; i++) {
-    written = SSL_write(ssl_, bufs[i].base, bufs[i].len);
-    CHECK(written == -1 || written == static_cast<int>(bufs[i].len));
+    for (offset = 0; offset < bufs[i].len; offset += written) {
+      written = SSLWrite(bufs[i].base + offset, bufs[i].len - offset);
+      CHECK(written == -1 || written > 0);
+      if (written == -1)
+        break;
+    }
     if (written == -1)
       break;
   }
@@ -588,7 +970,8 @@ int TLSCallbacks::DoWrite(WriteWrap* w,
       return UV_EPROTO;
 
     // No errors, queue rest
-    for (; i < count; i++)
+    clear_in_->Write(bufs[i].base + offset, bufs[i].len - offset);
+    for (i++; i < count; i++)
       clear_in_->Write(bufs[i].base, bufs[i].len);
   }
 
@@ -600,15 +983,26 @@ int TLSCallbacks::DoWrite(WriteWrap* w,
 
 
 void TLSCallbacks::AfterWrite(WriteWrap* w) {
-  // Intentionally empty
+  if (!kernel_tx_)
+    return;
+
+  StreamWrapCallbacks::AfterWrite(w);
+  if (wrap()->stream()->write_queue_size == 0)
+    DoPendingShutdown();
 }
 
 
 void TLSCallbacks::DoAlloc(uv_handle_t* handle,
                            size_t suggested_size,
                            uv_buf_t* buf) {
+  if (kernel_rx_)
+    return StreamWrapCallbacks::DoAlloc(handle, suggested_size, buf);
+
   size_t size = 0;
-  buf->base = NodeBIO::FromBIO(enc_in_)->PeekWritable(&size);
+  if (handshake_work_ != nullptr)
+    buf->base = offload_in_->PeekWritable(&size);
+  else
+    buf->base = NodeBIO::FromBIO(enc_in_)->PeekWritable(&size);
   buf->len = size;
 }
 
@@ -617,10 +1011,36 @@ void TLSCallbacks::DoRead(uv_stream_t* handle,
                           ssize_t nread,
                           const uv_buf_t* buf,
                           uv_handle_type pending) {
+  if (kernel_rx_) {
+    uv_buf_t empty = uv_buf_init(nullptr, 0);
+    if (nread == UV_EIO) {
+      // Not application data, release |buf| and see what it is.
+      StreamWrapCallbacks::DoRead(handle, 0, buf, pending);
+      buf = &empty;
+      nread = ReadKernelTLSRecord();
+      if (nread == UV_EOF)
+        uv_read_stop(handle);
+    }
+    if (nread == UV_EOF) {
+      if (eof_) {
+        StreamWrapCallbacks::DoRead(handle, 0, buf, pending);
+        return;
+      }
+      eof_ = true;
+    }
+    return StreamWrapCallbacks::DoRead(handle, nread, buf, pending);
+  }
+
   if (nread < 0)  {
     // Error should be emitted only after all data was read
     ClearOut();
 
+    // Including the data that waits for the handshake on the threadpool
+    if (handshake_work_ != nullptr) {
+      offload_nread_ = nread;
+      return;
+    }
+
     // Ignore EOF if received close_notify
     if (nread == UV_EOF) {
       if (eof_)
@@ -638,6 +1058,12 @@ void TLSCallbacks::DoRead(uv_stream_t* handle,
   // Only client connections can receive data
   CHECK_NE(ssl_, nullptr);
 
+  // Hold on to it until the handshake is back from the threadpool
+  if (handshake_work_ != nullptr) {
+    offload_in_->Commit(nread);
+    return;
+  }
+
   // Commit read data
   NodeBIO* enc_in = NodeBIO::FromBIO(enc_in_);
   enc_in->Commit(nread);
@@ -656,6 +1082,22 @@ void TLSCallbacks::DoRead(uv_stream_t* handle,
 
 
 int TLSCallbacks::DoShutdown(ShutdownWrap* req_wrap, uv_shutdown_cb cb) {
+  bool wait = handshake_work_ != nullptr;
+  if (kernel_tx_)
+    wait = wrap()->stream()->write_queue_size != 0;
+  if (wait) {
+    CHECK_EQ(pending_shutdown_, nullptr);
+    pending_shutdown_ = req_wrap;
+    pending_shutdown_cb_ = cb;
+    return 0;
+  }
+
+  if (kernel_tx_) {
+    SendKernelTLSCloseNotify();
+    shutdown_ = true;
+    return StreamWrapCallbacks::DoShutdown(req_wrap, cb);
+  }
+
   if (SSL_shutdown(ssl_) == 0)
     SSL_shutdown(ssl_);
   shutdown_ = true;
@@ -664,6 +1106,338 @@ int TLSCallbacks::DoShutdown(ShutdownWrap* req_wrap, uv_shutdown_cb cb) {
 }
 
 
+#ifdef NODE_HAVE_KERNEL_TLS
+// Room for the control message that carries a record type.
+static const size_t kRecordTypeControlSize = CMSG_SPACE(sizeof(unsigned char));
+
+
+template <typename CryptoInfo>
+static int SetKernelTLSCryptoInfo(int fd,
+                                  int direction,
+                                  uint16_t cipher_type,
+                                  const unsigned char* key,
+                                  const unsigned char* salt,
+                                  const unsigned char* seq) {
+  CryptoInfo info;
+  memset(&info, 0, sizeof(info));
+  info.info.version = TLS_1_2_VERSION;
+  info.info.cipher_type = cipher_type;
+  memcpy(info.key, key, sizeof(info.key));
+  memcpy(info.salt, salt, sizeof(info.salt));
+  // The explicit part of the nonce only has to be unique for the key,
+  // starting it at the sequence number makes sure of that.
+  memcpy(info.iv, seq, sizeof(info.iv));
+  memcpy(info.rec_seq, seq, sizeof(info.rec_seq));
+  int r = setsockopt(fd, SOL_TLS, direction, &info, sizeof(info));
+  OPENSSL_cleanse(&info, sizeof(info));
+  return r;
+}
+
+
+static int SetKernelTLSKey(int fd,
+                           int direction,
+                           size_t key_len,
+                           const unsigned char* key,
+                           const unsigned char* salt,
+                           const unsigned char* seq) {
+#ifdef TLS_CIPHER_AES_GCM_256
+  if (key_len == TLS_CIPHER_AES_GCM_256_KEY_SIZE) {
+    return SetKernelTLSCryptoInfo<tls12_crypto_info_aes_gcm_256>(
+        fd, direction, TLS_CIPHER_AES_GCM_256, key, salt, seq);
+  }
+#endif  // TLS_CIPHER_AES_GCM_256
+  CHECK_EQ(key_len, TLS_CIPHER_AES_GCM_128_KEY_SIZE);
+  return SetKernelTLSCryptoInfo<tls12_crypto_info_aes_gcm_128>(
+      fd, direction, TLS_CIPHER_AES_GCM_128, key, salt, seq);
+}
+
+
+// From the bundled OpenSSL's ssl/ssl_locl.h, which is not installed. Neither
+// the functions nor the constants are part of the API, a shared OpenSSL may
+// not export the former and a different release may change the latter,
+// hence NODE_HAVE_KERNEL_TLS is only defined for the bundled 1.0.1.
+extern "C" {
+long ssl_get_algorithm2(SSL* s);  // NOLINT(runtime/int)
+int ssl_get_handshake_digest(int idx,
+                             long* mask,  // NOLINT(runtime/int)
+                             const EVP_MD** md);
+}
+static const int kPRFDigestShift = 10;  // TLS1_PRF_DGST_SHIFT
+static const int kMaxDigests = 6;  // SSL_MAX_DIGEST
+
+
+// The digest the PRF of the negotiated cipher suite uses, picked the way
+// tls1_PRF() picks it. TLS 1.2 cipher suites have exactly one, returns
+// nullptr if that isn't so.
+static const EVP_MD* GetPRFDigest(SSL* ssl) {
+  long algorithm2 = ssl_get_algorithm2(ssl);  // NOLINT(runtime/int)
+  const EVP_MD* prf = nullptr;
+  for (int i = 0; i < kMaxDigests; i++) {
+    long mask;  // NOLINT(runtime/int)
+    const EVP_MD* md;
+    if (!ssl_get_handshake_digest(i, &mask, &md))
+      break;
+    if (((mask << kPRFDigestShift) & algorithm2) == 0)
+      continue;
+    if (prf != nullptr || md == nullptr)
+      return nullptr;
+    prf = md;
+  }
+  return prf;
+}
+#endif  // NODE_HAVE_KERNEL_TLS
+
+
+// With the `kernelTLS` option the kernel takes over the record layer of
+// established TLS 1.2 AES-GCM connections, plain reads, writes and
+// sendfile() on the socket carry application data from then on. OpenSSL
+// 1.0.1 knows nothing about it, so the keys are derived from the master
+// secret the way OpenSSL derives its own key block and the sequence numbers
+// continue where OpenSSL left off. That is only correct while OpenSSL holds
+// no data of its own in either direction, which is why this is retried
+// after every Cycle() and every completed write until it gets a chance.
+//
+// The receive side goes first: if the kernel has no "tls" ULP or refuses
+// the keys nothing has changed and the connection stays in userspace. If
+// only the transmit side fails, OpenSSL keeps encrypting what goes out.
+void TLSCallbacks::MaybeEnableKernelTLS() {
+#ifdef NODE_HAVE_KERNEL_TLS
+  if (!kernel_tls_ || kernel_rx_ || !established_ || !wrap()->is_tcp())
+    return;
+
+  if (handshake_work_ != nullptr ||
+      is_waiting_new_session() ||
+      !SSL_is_init_finished(ssl_) ||
+      SSL_renegotiate_pending(ssl_) ||
+      shutdown_ ||
+      eof_) {
+    return;
+  }
+
+  // Anything OpenSSL has yet to write or has read but not handed out,
+  // including a record it has only read part of.
+  if (write_size_ != 0 ||
+      BIO_pending(enc_out_) != 0 ||
+      BIO_pending(enc_in_) != 0 ||
+      clear_in_->Length() != 0 ||
+      !QUEUE_EMPTY(&write_item_queue_) ||
+      !QUEUE_EMPTY(&pending_write_items_) ||
+      wrap()->stream()->write_queue_size != 0 ||
+      SSL_pending(ssl_) != 0 ||
+      ssl_->s3->rbuf.left != 0 ||
+      ssl_->rstate != SSL_ST_READ_HEADER ||
+      ssl_->packet_length != 0) {
+    return;
+  }
+
+  // Settled for good from here on, whatever happens below.
+  kernel_tls_ = false;
+
+  if (SSL_version(ssl_) != TLS1_2_VERSION ||
+      SSL_get_current_compression(ssl_) != nullptr ||
+      ssl_->enc_write_ctx == nullptr) {
+    return;
+  }
+
+  size_t key_len;
+  switch (EVP_CIPHER_CTX_nid(ssl_->enc_write_ctx)) {
+    case NID_aes_128_gcm:
+      key_len = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+      break;
+#ifdef TLS_CIPHER_AES_GCM_256
+    case NID_aes_256_gcm:
+      key_len = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+      break;
+#endif  // TLS_CIPHER_AES_GCM_256
+    default:
+      return;
+  }
+
+  // The key block comes from the PRF of the cipher suite, not the cipher.
+  const EVP_MD* md = GetPRFDigest(ssl_);
+  if (md == nullptr)
+    return;
+
+  int fd;
+  uv_handle_t* handle = reinterpret_cast<uv_handle_t*>(wrap()->stream());
+  if (uv_fileno(handle, &fd) != 0)
+    return;
+
+  // client_write_key, server_write_key, client_write_IV, server_write_IV,
+  // the IVs are the 4 byte implicit part of the GCM nonce.
+  unsigned char key_block[kKernelTLSKeyBlockSize];
+  const size_t salt_len = TLS_CIPHER_AES_GCM_128_SALT_SIZE;
+  if (!KernelTLSKeyBlock(md, key_block, 2 * key_len + 2 * salt_len))
+    return;
+
+  const unsigned char* client_key = key_block;
+  const unsigned char* server_key = client_key + key_len;
+  const unsigned char* client_salt = server_key + key_len;
+  const unsigned char* server_salt = client_salt + salt_len;
+  const unsigned char* rx_key = is_server() ? client_key : server_key;
+  const unsigned char* rx_salt = is_server() ? client_salt : server_salt;
+  const unsigned char* tx_key = is_server() ? server_key : client_key;
+  const unsigned char* tx_salt = is_server() ? server_salt : client_salt;
+
+  if (setsockopt(fd, IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls")) == 0 &&
+      SetKernelTLSKey(fd,
+                      TLS_RX,
+                      key_len,
+                      rx_key,
+                      rx_salt,
+                      ssl_->s3->read_sequence) == 0) {
+    kernel_rx_ = true;
+    kernel_tx_ = SetKernelTLSKey(fd,
+                                 TLS_TX,
+                                 key_len,
+                                 tx_key,
+                                 tx_salt,
+                                 ssl_->s3->write_sequence) == 0;
+  }
+
+  OPENSSL_cleanse(key_block, sizeof(key_block));
+#endif  // NODE_HAVE_KERNEL_TLS
+}
+
+
+// TLS 1.2 PRF, P_hash() from RFC 5246 section 5, with the "key expansion"
+// label. OpenSSL throws its copy of the key block away after the handshake.
+bool TLSCallbacks::KernelTLSKeyBlock(const EVP_MD* md,
+                                     unsigned char* out,
+                                     size_t len) {
+  static const char label[] = "key expansion";
+  const size_t label_len = sizeof(label) - 1;
+  unsigned char seed[label_len + 2 * SSL3_RANDOM_SIZE];
+  memcpy(seed, label, label_len);
+  memcpy(seed + label_len, ssl_->s3->server_random, SSL3_RANDOM_SIZE);
+  memcpy(seed + label_len + SSL3_RANDOM_SIZE,
+         ssl_->s3->client_random,
+         SSL3_RANDOM_SIZE);
+
+  const unsigned char* secret = ssl_->session->master_key;
+  int secret_len = ssl_->session->master_key_length;
+
+  unsigned char a[EVP_MAX_MD_SIZE];
+  unsigned char chunk[EVP_MAX_MD_SIZE];
+  unsigned int a_len;
+  unsigned int chunk_len;
+  bool ok = HMAC(md, secret, secret_len, seed, sizeof(seed), a, &a_len) !=
+            nullptr;
+  while (ok && len > 0) {
+    HMAC_CTX ctx;
+    HMAC_CTX_init(&ctx);
+    ok = HMAC_Init_ex(&ctx, secret, secret_len, md, nullptr) &&
+         HMAC_Update(&ctx, a, a_len) &&
+         HMAC_Update(&ctx, seed, sizeof(seed)) &&
+         HMAC_Final(&ctx, chunk, &chunk_len);
+    HMAC_CTX_cleanup(&ctx);
+    if (!ok)
+      break;
+
+    size_t n = chunk_len < len ? chunk_len : len;
+    memcpy(out, chunk, n);
+    out += n;
+    len -= n;
+
+    if (len > 0)
+      ok = HMAC(md, secret, secret_len, a, a_len, a, &a_len) != nullptr;
+  }
+
+  OPENSSL_cleanse(a, sizeof(a));
+  OPENSSL_cleanse(chunk, sizeof(chunk));
+  return ok;
+}
+
+
+ssize_t TLSCallbacks::ReadKernelTLSRecord() {
+#ifdef NODE_HAVE_KERNEL_TLS
+  int fd;
+  uv_handle_t* handle = reinterpret_cast<uv_handle_t*>(wrap()->stream());
+  if (uv_fileno(handle, &fd) != 0)
+    return UV_EBADF;
+
+  // An alert is two bytes, anything longer is an error either way.
+  unsigned char data[2];
+  char control[kRecordTypeControlSize];
+  struct iovec iov;
+  iov.iov_base = data;
+  iov.iov_len = sizeof(data);
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t r;
+  do {
+    r = recvmsg(fd, &msg, 0);
+  } while (r == -1 && errno == EINTR);
+  if (r == -1)
+    return -errno;
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg == nullptr ||
+      cmsg->cmsg_level != SOL_TLS ||
+      cmsg->cmsg_type != TLS_GET_RECORD_TYPE ||
+      *CMSG_DATA(cmsg) != SSL3_RT_ALERT ||
+      r != sizeof(data) ||
+      data[1] != SSL3_AD_CLOSE_NOTIFY) {
+    return UV_EPROTO;
+  }
+
+  // So that SSL_free() keeps the session in the cache.
+  SSL_set_shutdown(ssl_, SSL_get_shutdown(ssl_) | SSL_RECEIVED_SHUTDOWN);
+  return UV_EOF;
+#else
+  return UV_EIO;
+#endif  // NODE_HAVE_KERNEL_TLS
+}
+
+
+void TLSCallbacks::SendKernelTLSCloseNotify() {
+#ifdef NODE_HAVE_KERNEL_TLS
+  int fd;
+  uv_handle_t* handle = reinterpret_cast<uv_handle_t*>(wrap()->stream());
+  if (uv_fileno(handle, &fd) != 0)
+    return;
+
+  unsigned char alert[] = { SSL3_AL_WARNING, SSL3_AD_CLOSE_NOTIFY };
+  char control[kRecordTypeControlSize];
+  struct iovec iov;
+  iov.iov_base = alert;
+  iov.iov_len = sizeof(alert);
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(unsigned char));
+  *CMSG_DATA(cmsg) = SSL3_RT_ALERT;
+  msg.msg_controllen = cmsg->cmsg_len;
+
+  // Ignore errors, like EncOut() does. The write queue is empty so this
+  // doesn't block unless the socket is gone already.
+  ssize_t r;
+  do {
+    r = sendmsg(fd, &msg, 0);
+  } while (r == -1 && errno == EINTR);
+
+  SSL_set_shutdown(ssl_, SSL_get_shutdown(ssl_) | SSL_SENT_SHUTDOWN);
+#endif  // NODE_HAVE_KERNEL_TLS
+}
+
+
+bool TLSCallbacks::CanSendFile() const {
+  return kernel_tx_;
+}
+
+
 void TLSCallbacks::SetVerifyMode(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -711,6 +1485,27 @@ void TLSCallbacks::EnableHelloParser(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void TLSCallbacks::EnableHandshakeOffload(
+    const FunctionCallbackInfo<Value>& args) {
+  TLSCallbacks* wrap = Unwrap<TLSCallbacks>(args.Holder());
+  if (wrap->is_server())
+    wrap->handshake_offload_ = true;
+}
+
+
+void TLSCallbacks::EnableKernelTLS(const FunctionCallbackInfo<Value>& args) {
+  TLSCallbacks* wrap = Unwrap<TLSCallbacks>(args.Holder());
+  wrap->kernel_tls_ = true;
+  wrap->MaybeEnableKernelTLS();
+}
+
+
+void TLSCallbacks::IsKernelTLS(const FunctionCallbackInfo<Value>& args) {
+  TLSCallbacks* wrap = Unwrap<TLSCallbacks>(args.Holder());
+  args.GetReturnValue().Set(wrap->kernel_rx_);
+}
+
+
 void TLSCallbacks::OnClientHelloParseEnd(void* arg) {
   TLSCallbacks* c = static_cast<TLSCallbacks*>(arg);
   c->Cycle();
@@ -756,13 +1551,23 @@ void TLSCallbacks::SetServername(const FunctionCallbackInfo<Value>& args) {
 
 int TLSCallbacks::SelectSNIContextCallback(SSL* s, int* ad, void* arg) {
   TLSCallbacks* p = static_cast<TLSCallbacks*>(SSL_get_app_data(s));
-  Environment* env = p->env();
 
   const char* servername = SSL_get_servername(s, TLSEXT_NAMETYPE_host_name);
 
   if (servername == nullptr)
     return SSL_TLSEXT_ERR_OK;
 
+  // On the threadpool, use the context that OffloadHandshake() looked up.
+  if (p == nullptr) {
+    HandshakeWork* work = HandshakeWork::FromSSL(s);
+    if (work->sni_context_ == nullptr)
+      return SSL_TLSEXT_ERR_NOACK;
+    SSL_set_SSL_CTX(s, work->sni_context_);
+    return SSL_TLSEXT_ERR_OK;
+  }
+
+  Environment* env = p->env();
+
   HandleScope scope(env->isolate());
   // Call the SNI callback and use its return value as context
   Local<Object> object = p->object();
@@ -796,8 +1601,23 @@ void TLSCallbacks::Initialize(Handle<Object> target,
                               Handle<Context> context) {
   Environment* env = Environment::GetCurrent(context);
 
+  // SSL_set_app_data() uses index 0 without allocating it.
+  while (handshake_work_index <= 0) {
+    handshake_work_index =
+        SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    CHECK_NE(handshake_work_index, -1);
+  }
+
   env->SetMethod(target, "wrap", TLSCallbacks::Wrap);
 
+#ifdef NODE_HAVE_KERNEL_TLS
+  Local<Boolean> have_kernel_tls = True(env->isolate());
+#else
+  Local<Boolean> have_kernel_tls = False(env->isolate());
+#endif  // NODE_HAVE_KERNEL_TLS
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "haveKernelTLS"),
+              have_kernel_tls);
+
   Local<FunctionTemplate> t = FunctionTemplate::New(env->isolate());
   t->InstanceTemplate()->SetInternalFieldCount(1);
   t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "TLSWrap"));
@@ -807,6 +1627,9 @@ void TLSCallbacks::Initialize(Handle<Object> target,
   env->SetProtoMethod(t, "setVerifyMode", SetVerifyMode);
   env->SetProtoMethod(t, "enableSessionCallbacks", EnableSessionCallbacks);
   env->SetProtoMethod(t, "enableHelloParser", EnableHelloParser);
+  env->SetProtoMethod(t, "enableHandshakeOffload", EnableHandshakeOffload);
+  env->SetProtoMethod(t, "enableKernelTLS", EnableKernelTLS);
+  env->SetProtoMethod(t, "isKernelTLS", IsKernelTLS);
 
   SSLWrap<TLSCallbacks>::AddMethods(env, t);
 
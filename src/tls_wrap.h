@@ -69,6 +69,7 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
               const uv_buf_t* buf,
               uv_handle_type pending) override;
   int DoShutdown(ShutdownWrap* req_wrap, uv_shutdown_cb cb) override;
+  bool CanSendFile() const override;
 
   void NewSessionDoneCb();
 
@@ -84,6 +85,20 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
   // Maximum number of buffers passed to uv_write()
   static const int kSimultaneousBufferCount = 10;
 
+  // Dynamic record sizing, see SSLWrite(). Small records fit in one TCP
+  // segment (1448 bytes with timestamps) even with the largest per-record
+  // overhead, a CBC cipher with SHA384. A burst starts with them, after
+  // roughly an initial congestion window's worth of data the records grow to
+  // the maximum size. One second without writes starts a new burst.
+  static const unsigned int kSmallRecordSize = 1360;
+  static const unsigned int kLargeRecordSize = 16384;
+  static const size_t kSmallRecordBurst = 16 * 1024;
+  static const uint64_t kRecordBurstTimeout = 1000;
+
+  // Largest key block MaybeEnableKernelTLS() derives, AES-256-GCM: two keys
+  // and two 4 byte implicit nonces.
+  static const size_t kKernelTLSKeyBlockSize = 2 * 32 + 2 * 4;
+
   // Write callback queue's item
   class WriteItem {
    public:
@@ -104,14 +119,22 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
                v8::Handle<v8::Object> sc,
                StreamWrapCallbacks* old);
 
+  // Runs one step of the server side of the handshake on the threadpool.
+  class HandshakeWork;
+
   static void SSLInfoCallback(const SSL* ssl_, int where, int ret);
+  void OnHandshakeInfo(int where);
   void InitSSL();
   void EncOut();
   static void EncOutCb(uv_write_t* req, int status);
   bool ClearIn();
   void ClearOut();
+  // Like SSL_write() but may write less than |len| bytes when the record
+  // size changes, the caller writes the rest.
+  int SSLWrite(const char* data, size_t len);
   void MakePending();
   bool InvokeQueued(int status);
+  void DoPendingShutdown();
 
   inline void Cycle() {
     // Prevent recursion
@@ -123,11 +146,28 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
       ClearOut();
       EncOut();
     }
+
+    MaybeEnableKernelTLS();
   }
 
   // If |msg| is not nullptr, caller is responsible for calling `delete[] *msg`.
   v8::Local<v8::Value> GetSSLError(int status, int* err, const char** msg);
 
+  // Returns true if the handshake is (still) running on the threadpool, the
+  // SSL object and its BIOs are off limits until AfterHandshakeWork().
+  bool OffloadHandshake();
+  static void DoHandshakeWork(uv_work_t* req);
+  static void AfterHandshakeWork(uv_work_t* req, int status);
+
+  // Hands the record layer over to the kernel once the handshake is done
+  // and OpenSSL has no buffered data in either direction.
+  void MaybeEnableKernelTLS();
+  bool KernelTLSKeyBlock(const EVP_MD* md, unsigned char* out, size_t len);
+  // Reads the non-data record the kernel stopped at, returns UV_EOF for
+  // close_notify and an error for anything else.
+  ssize_t ReadKernelTLSRecord();
+  void SendKernelTLSCloseNotify();
+
   static void OnClientHelloParseEnd(void* arg);
   static void Wrap(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Receive(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -137,6 +177,10 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableHelloParser(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableHandshakeOffload(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableKernelTLS(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void IsKernelTLS(const v8::FunctionCallbackInfo<v8::Value>& args);
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   static void GetServername(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -164,6 +208,31 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
   // after the `UV_EOF` on socket.
   bool eof_;
 
+  // Record size that SSLWrite() set last.
+  unsigned int record_size_;
+  size_t burst_size_;
+  uint64_t last_write_;
+
+  // Handshake offloading, see OffloadHandshake().
+  bool handshake_offload_;
+  HandshakeWork* handshake_work_;
+  // Data that arrives from the socket while |handshake_work_| runs.
+  NodeBIO* offload_in_;
+  // Socket EOF or error that arrived while |handshake_work_| ran.
+  ssize_t offload_nread_;
+
+  // Kernel TLS, see MaybeEnableKernelTLS(). Once |kernel_rx_| is set the
+  // kernel decrypts what comes in, once |kernel_tx_| is set it encrypts
+  // what goes out and OpenSSL is out of the picture for that direction.
+  bool kernel_tls_;
+  bool kernel_rx_;
+  bool kernel_tx_;
+
+  // DoShutdown() that waits for the handshake work or, with |kernel_tx_|,
+  // for the write queue to drain.
+  ShutdownWrap* pending_shutdown_;
+  uv_shutdown_cb pending_shutdown_cb_;
+
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   v8::Persistent<v8::Value> sni_context_;
 #endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
@@ -29,10 +29,13 @@
 #include "util-inl.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 
 namespace node {
 
+using v8::Array;
+using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::External;
@@ -80,16 +83,89 @@ static void NewSendWrap(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// A single request for a batch of datagrams. What doesn't fit in the socket
+// buffer right away is queued with a uv_udp_send_t per datagram, the request
+// completes when the last of those does.
+class SendBatchWrap : public ReqWrap<uv_udp_send_t> {
+ public:
+  SendBatchWrap(Environment* env, Local<Object> req_wrap_obj, size_t count);
+  ~SendBatchWrap();
+
+  uv_buf_t* const bufs;
+  sockaddr_in6* const addrs;
+  const sockaddr** const addr_ptrs;
+  uv_udp_send_t* const reqs;
+  size_t pending;
+  int status;
+};
+
+
+SendBatchWrap::SendBatchWrap(Environment* env,
+                             Local<Object> req_wrap_obj,
+                             size_t count)
+    : ReqWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_UDPWRAP),
+      bufs(new uv_buf_t[count]),
+      addrs(new sockaddr_in6[count]),
+      addr_ptrs(new const sockaddr*[count]),
+      reqs(new uv_udp_send_t[count]),
+      pending(0),
+      status(0) {
+  Wrap(req_wrap_obj, this);
+}
+
+
+SendBatchWrap::~SendBatchWrap() {
+  delete[] bufs;
+  delete[] addrs;
+  delete[] addr_ptrs;
+  delete[] reqs;
+}
+
+
+// Datagrams from a recvmmsg() batch. They point into |base| until FlushBatch()
+// copies them into a single buffer and hands them to JS in one go.
+struct UDPWrap::Batch {
+  static const size_t kMaxDatagrams = 64;
+
+  struct Datagram {
+    const char* data;
+    size_t length;
+    bool has_address;
+    struct sockaddr_storage address;
+  };
+
+  Batch() : base(nullptr), size(0), count(0), bytes(0) {
+  }
+
+  ~Batch() {
+    free(base);
+  }
+
+  char* base;  // Receive buffer, reused from one batch to the next.
+  size_t size;
+  size_t count;
+  size_t bytes;
+  Datagram datagrams[kMaxDatagrams];
+};
+
+
 UDPWrap::UDPWrap(Environment* env, Handle<Object> object, AsyncWrap* parent)
     : HandleWrap(env,
                  object,
                  reinterpret_cast<uv_handle_t*>(&handle_),
-                 AsyncWrap::PROVIDER_UDPWRAP) {
+                 AsyncWrap::PROVIDER_UDPWRAP),
+      batch_(nullptr) {
   int r = uv_udp_init(env->event_loop(), &handle_);
   CHECK_EQ(r, 0);  // can't fail anyway
 }
 
 
+UDPWrap::~UDPWrap() {
+  delete batch_;
+  batch_ = nullptr;
+}
+
+
 void UDPWrap::Initialize(Handle<Object> target,
                          Handle<Value> unused,
                          Handle<Context> context) {
@@ -112,6 +188,8 @@ void UDPWrap::Initialize(Handle<Object> target,
   env->SetProtoMethod(t, "send", Send);
   env->SetProtoMethod(t, "bind6", Bind6);
   env->SetProtoMethod(t, "send6", Send6);
+  env->SetProtoMethod(t, "sendBatch", SendBatch);
+  env->SetProtoMethod(t, "sendBatch6", SendBatch6);
   env->SetProtoMethod(t, "close", Close);
   env->SetProtoMethod(t, "recvStart", RecvStart);
   env->SetProtoMethod(t, "recvStop", RecvStop);
@@ -122,6 +200,7 @@ void UDPWrap::Initialize(Handle<Object> target,
   env->SetProtoMethod(t, "setMulticastLoopback", SetMulticastLoopback);
   env->SetProtoMethod(t, "setBroadcast", SetBroadcast);
   env->SetProtoMethod(t, "setTTL", SetTTL);
+  env->SetProtoMethod(t, "setRecvmmsg", SetRecvmmsg);
 
   env->SetProtoMethod(t, "ref", HandleWrap::Ref);
   env->SetProtoMethod(t, "unref", HandleWrap::Unref);
@@ -327,6 +406,111 @@ void UDPWrap::Send6(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void UDPWrap::DoSendBatch(const FunctionCallbackInfo<Value>& args,
+                          int family) {
+  Environment* env = Environment::GetCurrent(args);
+
+  UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
+
+  // sendBatch(req, buffers, ports, addresses)
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsArray());
+  CHECK(args[2]->IsArray());
+  CHECK(args[3]->IsArray());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  Local<Array> buffers = args[1].As<Array>();
+  Local<Array> ports = args[2].As<Array>();
+  Local<Array> addresses = args[3].As<Array>();
+  const size_t count = buffers->Length();
+
+  CHECK_GT(count, 0);
+  CHECK_EQ(ports->Length(), count);
+  CHECK_EQ(addresses->Length(), count);
+
+  SendBatchWrap* req_wrap = new SendBatchWrap(env, req_wrap_obj, count);
+  int err = 0;
+
+  for (size_t i = 0; i < count && err == 0; i += 1) {
+    Local<Value> buffer_obj = buffers->Get(i);
+    CHECK(Buffer::HasInstance(buffer_obj));
+    req_wrap->bufs[i] = uv_buf_init(Buffer::Data(buffer_obj),
+                                    Buffer::Length(buffer_obj));
+
+    const unsigned short port = ports->Get(i)->Uint32Value();
+    node::Utf8Value address(addresses->Get(i));
+    sockaddr_in6* addr = &req_wrap->addrs[i];
+
+    switch (family) {
+    case AF_INET:
+      err = uv_ip4_addr(*address, port, reinterpret_cast<sockaddr_in*>(addr));
+      break;
+    case AF_INET6:
+      err = uv_ip6_addr(*address, port, addr);
+      break;
+    default:
+      CHECK(0 && "unexpected address family");
+      abort();
+    }
+
+    req_wrap->addr_ptrs[i] = reinterpret_cast<const sockaddr*>(addr);
+  }
+
+  // Send as much as possible right now, with sendmmsg() where available.
+  size_t sent = 0;
+  if (err == 0) {
+    err = uv_udp_try_send_multi(&wrap->handle_,
+                                req_wrap->bufs,
+                                req_wrap->addr_ptrs,
+                                count);
+    if (err > 0)
+      sent = err;
+    if (err > 0 || err == UV_EAGAIN || err == UV_ENOSYS)
+      err = 0;
+  }
+
+  // Queue up the remainder.
+  for (size_t i = sent; i < count && err == 0; i += 1) {
+    uv_udp_send_t* req = &req_wrap->reqs[req_wrap->pending];
+    req->data = req_wrap;
+    err = uv_udp_send(req,
+                      &wrap->handle_,
+                      &req_wrap->bufs[i],
+                      1,
+                      req_wrap->addr_ptrs[i],
+                      OnSendBatch);
+    if (err == 0)
+      req_wrap->pending += 1;
+  }
+
+  req_wrap->Dispatched();
+
+  // Sends that are in flight can't be taken back, report the error when
+  // they complete.
+  if (err != 0 && req_wrap->pending > 0) {
+    req_wrap->status = err;
+    err = 0;
+  }
+
+  const bool async = req_wrap->pending > 0;
+  req_wrap_obj->Set(env->async(), Boolean::New(env->isolate(), async));
+  if (!async)
+    delete req_wrap;
+
+  args.GetReturnValue().Set(err);
+}
+
+
+void UDPWrap::SendBatch(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET);
+}
+
+
+void UDPWrap::SendBatch6(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET6);
+}
+
+
 void UDPWrap::RecvStart(const FunctionCallbackInfo<Value>& args) {
   UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
   int err = uv_udp_recv_start(&wrap->handle_, OnAlloc, OnRecv);
@@ -337,6 +521,17 @@ void UDPWrap::RecvStart(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void UDPWrap::SetRecvmmsg(const FunctionCallbackInfo<Value>& args) {
+  UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
+  const bool on = args[0]->IsTrue();
+  int err = uv_udp_set_recvmmsg(&wrap->handle_, on);
+  // The batch buffer outlives recvmmsg mode, datagrams may still point into it.
+  if (err == 0 && on && wrap->batch_ == nullptr)
+    wrap->batch_ = new Batch();
+  args.GetReturnValue().Set(err);
+}
+
+
 void UDPWrap::RecvStop(const FunctionCallbackInfo<Value>& args) {
   UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
   int r = uv_udp_recv_stop(&wrap->handle_);
@@ -381,9 +576,43 @@ void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
 }
 
 
+void UDPWrap::OnSendBatch(uv_udp_send_t* req, int status) {
+  SendBatchWrap* req_wrap = static_cast<SendBatchWrap*>(req->data);
+  if (status != 0 && req_wrap->status == 0)
+    req_wrap->status = status;
+  if (--req_wrap->pending > 0)
+    return;
+  Environment* env = req_wrap->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  Local<Value> arg = Integer::New(env->isolate(), req_wrap->status);
+  req_wrap->MakeCallback(env->oncomplete_string(), 1, &arg);
+  delete req_wrap;
+}
+
+
 void UDPWrap::OnAlloc(uv_handle_t* handle,
                       size_t suggested_size,
                       uv_buf_t* buf) {
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  Batch* batch = wrap->batch_;
+
+  if (batch != nullptr) {
+    CHECK_EQ(batch->count, 0);
+    if (batch->size < suggested_size) {
+      char* base = static_cast<char*>(realloc(batch->base, suggested_size));
+      if (base == nullptr) {
+        FatalError("node::UDPWrap::OnAlloc(uv_handle_t*, size_t, uv_buf_t*)",
+                   "Out Of Memory");
+      }
+      batch->base = base;
+      batch->size = suggested_size;
+    }
+    buf->base = batch->base;
+    buf->len = batch->size;
+    return;
+  }
+
   buf->base = static_cast<char*>(malloc(suggested_size));
   buf->len = suggested_size;
 
@@ -399,13 +628,23 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags) {
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+
+  if (flags & UV_UDP_MMSG_CHUNK)
+    return wrap->QueueDatagram(nread, buf, addr);
+
+  if (flags & UV_UDP_MMSG_FREE)
+    return wrap->FlushBatch();
+
+  // The batch buffer is reused, anything else is ours to free.
+  const bool owned = wrap->batch_ == nullptr;
+
   if (nread == 0 && addr == nullptr) {
-    if (buf->base != nullptr)
+    if (owned && buf->base != nullptr)
       free(buf->base);
     return;
   }
 
-  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
   Environment* env = wrap->env();
 
   HandleScope handle_scope(env->isolate());
@@ -420,19 +659,104 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
   };
 
   if (nread < 0) {
-    if (buf->base != nullptr)
+    if (owned && buf->base != nullptr)
       free(buf->base);
     wrap->MakeCallback(env->onmessage_string(), ARRAY_SIZE(argv), argv);
     return;
   }
 
-  char* base = static_cast<char*>(realloc(buf->base, nread));
+  char* base;
+  if (owned) {
+    base = static_cast<char*>(realloc(buf->base, nread));
+  } else {
+    base = static_cast<char*>(malloc(nread));
+    if (base == nullptr && nread > 0) {
+      FatalError("node::UDPWrap::OnRecv(uv_udp_t*, ssize_t, ...)",
+                 "Out Of Memory");
+    }
+    memcpy(base, buf->base, nread);
+  }
   argv[2] = Buffer::Use(env, base, nread);
   argv[3] = AddressToJS(env, addr);
   wrap->MakeCallback(env->onmessage_string(), ARRAY_SIZE(argv), argv);
 }
 
 
+void UDPWrap::QueueDatagram(ssize_t nread,
+                            const uv_buf_t* buf,
+                            const struct sockaddr* addr) {
+  Batch* batch = batch_;
+  CHECK_NE(batch, nullptr);
+  CHECK_GE(nread, 0);
+
+  // The receive buffer stays put, it's safe to deliver what we have so far.
+  if (batch->count == Batch::kMaxDatagrams)
+    FlushBatch();
+
+  Batch::Datagram* datagram = &batch->datagrams[batch->count];
+  datagram->data = buf->base;
+  datagram->length = nread;
+  datagram->has_address = addr != nullptr;
+  if (addr != nullptr) {
+    size_t addrlen = addr->sa_family == AF_INET6 ? sizeof(sockaddr_in6)
+                                                 : sizeof(sockaddr_in);
+    memcpy(&datagram->address, addr, addrlen);
+  }
+  batch->count += 1;
+  batch->bytes += nread;
+}
+
+
+void UDPWrap::FlushBatch() {
+  Batch* batch = batch_;
+  CHECK_NE(batch, nullptr);
+
+  const size_t count = batch->count;
+  const size_t bytes = batch->bytes;
+  batch->count = 0;
+  batch->bytes = 0;
+
+  if (count == 0 || !IsAlive(this))
+    return;
+
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  char* data = static_cast<char*>(malloc(bytes));
+  if (data == nullptr && bytes > 0)
+    FatalError("node::UDPWrap::FlushBatch()", "Out Of Memory");
+
+  // Flat list of offset/length pairs into the buffer, one pair per datagram.
+  Local<Array> ranges = Array::New(env->isolate(), 2 * count);
+  Local<Array> addresses = Array::New(env->isolate(), count);
+  size_t offset = 0;
+
+  for (size_t i = 0; i < count; i += 1) {
+    const Batch::Datagram* datagram = &batch->datagrams[i];
+    memcpy(data + offset, datagram->data, datagram->length);
+    ranges->Set(2 * i, Integer::NewFromUnsigned(env->isolate(), offset));
+    ranges->Set(2 * i + 1,
+                Integer::NewFromUnsigned(env->isolate(), datagram->length));
+    if (datagram->has_address) {
+      const sockaddr* addr =
+          reinterpret_cast<const sockaddr*>(&datagram->address);
+      addresses->Set(i, AddressToJS(env, addr));
+    }
+    offset += datagram->length;
+  }
+
+  Local<Value> argv[] = {
+    Integer::New(env->isolate(), count),
+    object(),
+    Buffer::Use(env, data, bytes),
+    ranges,
+    addresses
+  };
+  MakeCallback(env->onmessages_string(), ARRAY_SIZE(argv), argv);
+}
+
+
 Local<Object> UDPWrap::Instantiate(Environment* env, AsyncWrap* parent) {
   // If this assert fires then Initialize hasn't been called yet.
   CHECK_EQ(env->udp_constructor_function().IsEmpty(), false);
@@ -43,6 +43,8 @@ class UDPWrap: public HandleWrap {
   static void Send(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Send6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStart(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStop(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetSockName(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -53,17 +55,23 @@ class UDPWrap: public HandleWrap {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetBroadcast(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetTTL(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetRecvmmsg(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static v8::Local<v8::Object> Instantiate(Environment* env, AsyncWrap* parent);
   uv_udp_t* UVHandle();
 
  private:
+  struct Batch;
+
   UDPWrap(Environment* env, v8::Handle<v8::Object> object, AsyncWrap* parent);
+  ~UDPWrap();
 
   static void DoBind(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
   static void DoSend(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
+  static void DoSendBatch(const v8::FunctionCallbackInfo<v8::Value>& args,
+                          int family);
   static void SetMembership(const v8::FunctionCallbackInfo<v8::Value>& args,
                             uv_membership membership);
 
@@ -71,13 +79,20 @@ class UDPWrap: public HandleWrap {
                       size_t suggested_size,
                       uv_buf_t* buf);
   static void OnSend(uv_udp_send_t* req, int status);
+  static void OnSendBatch(uv_udp_send_t* req, int status);
   static void OnRecv(uv_udp_t* handle,
                      ssize_t nread,
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags);
 
+  void QueueDatagram(ssize_t nread,
+                     const uv_buf_t* buf,
+                     const struct sockaddr* addr);
+  void FlushBatch();
+
   uv_udp_t handle_;
+  Batch* batch_;  // Only allocated in recvmmsg mode.
 };
 
 }  // namespace node
@@ -27,11 +27,15 @@
 namespace node {
 namespace uv {
 
+using v8::Array;
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Handle;
 using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
 using v8::Object;
 using v8::String;
 using v8::Value;
@@ -47,12 +51,86 @@ void ErrName(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+static Local<Array> HistogramToJS(Isolate* isolate, const uint64_t* counts) {
+  Local<Array> histogram = Array::New(isolate, UV_THREADPOOL_HISTOGRAM_SIZE);
+  for (size_t i = 0; i < UV_THREADPOOL_HISTOGRAM_SIZE; i += 1)
+    histogram->Set(i, Number::New(isolate, static_cast<double>(counts[i])));
+  return histogram;
+}
+
+
+// getThreadpoolStats(kind, out)
+void GetThreadpoolStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  CHECK(args[0]->IsUint32());
+  CHECK(args[1]->IsObject());
+
+  uv_work_class kind = static_cast<uv_work_class>(args[0]->Uint32Value());
+  Local<Object> out = args[1].As<Object>();
+
+  uv_threadpool_stats_t stats;
+  int err = uv_threadpool_stats(kind, &stats);
+
+  if (err == 0) {
+    out->Set(env->threads_string(),
+             Integer::NewFromUnsigned(isolate, stats.threads));
+    out->Set(env->queued_string(),
+             Integer::NewFromUnsigned(isolate, stats.queued));
+    out->Set(env->submitted_string(),
+             Number::New(isolate, static_cast<double>(stats.submitted)));
+    out->Set(env->completed_string(),
+             Number::New(isolate, static_cast<double>(stats.completed)));
+    out->Set(env->wait_time_string(),
+             Number::New(isolate, static_cast<double>(stats.wait_time)));
+    out->Set(env->run_time_string(),
+             Number::New(isolate, static_cast<double>(stats.run_time)));
+    out->Set(env->wait_histogram_string(),
+             HistogramToJS(isolate, stats.wait_histogram));
+    out->Set(env->run_histogram_string(),
+             HistogramToJS(isolate, stats.run_histogram));
+  }
+
+  args.GetReturnValue().Set(err);
+}
+
+
+// getLoopMetrics(out) fills `out` with the loop iteration count, the number
+// of events, the time spent in each uv_metrics_phase and the number of
+// watcher updates, in that order.
+void GetLoopMetrics(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  CHECK(args[0]->IsArray());
+  Local<Array> out = args[0].As<Array>();
+
+  uv_metrics_t metrics;
+  uv_metrics_info(env->event_loop(), &metrics);
+
+  out->Set(0, Number::New(isolate, static_cast<double>(metrics.loop_count)));
+  out->Set(1, Number::New(isolate, static_cast<double>(metrics.events)));
+  for (size_t i = 0; i < UV_METRICS_PHASE_MAX; i += 1) {
+    double t = static_cast<double>(metrics.phase_time[i]);
+    out->Set(2 + i, Number::New(isolate, t));
+  }
+  double updates = static_cast<double>(metrics.watcher_updates);
+  out->Set(2 + UV_METRICS_PHASE_MAX, Number::New(isolate, updates));
+}
+
+
 void Initialize(Handle<Object> target,
                 Handle<Value> unused,
                 Handle<Context> context) {
   Environment* env = Environment::GetCurrent(context);
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "errname"),
               env->NewFunctionTemplate(ErrName)->GetFunction());
+  env->SetMethod(target, "getThreadpoolStats", GetThreadpoolStats);
+  env->SetMethod(target, "getLoopMetrics", GetLoopMetrics);
+  NODE_DEFINE_CONSTANT(target, UV_WORK_FAST_IO);
+  NODE_DEFINE_CONSTANT(target, UV_WORK_SLOW_IO);
+  NODE_DEFINE_CONSTANT(target, UV_WORK_CPU);
 #define V(name, _)                                                            \
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "UV_" # name),            \
               Integer::New(env->isolate(), UV_ ## name));
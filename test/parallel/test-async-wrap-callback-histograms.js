@@ -0,0 +1,76 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+
+var asyncWrap = process.binding('async_wrap');
+var Providers = asyncWrap.Providers;
+
+// Nothing is recorded until recording is turned on.
+assert.equal(asyncWrap.getCallbackHistogram(Providers.FSREQWRAP, {}), false);
+
+asyncWrap.setCallbackHistograms(true);
+
+var before = {};
+assert.equal(asyncWrap.getCallbackHistogram(Providers.FSREQWRAP, before), true);
+assert.equal(before.count, 0);
+assert.equal(before.total, 0);
+assert.equal(before.min, 0);
+assert.equal(before.max, 0);
+
+var pending = 3;
+for (var i = 0; i < pending; i += 1)
+  fs.stat(__filename, onstat);
+
+function onstat(err) {
+  assert.ifError(err);
+  // Busy-wait so the callback takes a measurable amount of time.
+  var start = Date.now();
+  while (Date.now() - start < 5);
+  if (--pending === 0)
+    setImmediate(check);
+}
+
+function check() {
+  var stats = {};
+  asyncWrap.getCallbackHistogram(Providers.FSREQWRAP, stats);
+  assert.equal(stats.count, 3);
+  assert(stats.min >= 4e6, 'min ' + stats.min);
+  assert(stats.max >= stats.min);
+  assert(stats.total >= 3 * stats.min);
+  assert(stats.total <= 3 * stats.max);
+  assert.deepEqual(Object.keys(stats.percentiles), ['50', '90', '99', '99.9']);
+  assert(stats.percentiles['50'] >= stats.min);
+  assert(stats.percentiles['99.9'] <= stats.max);
+
+  var tcp = {};
+  asyncWrap.getCallbackHistogram(Providers.TCPWRAP, tcp);
+  assert.equal(tcp.count, 0);
+
+  // Turning recording off from inside a callback must not crash.
+  fs.stat(__filename, function() {
+    asyncWrap.setCallbackHistograms(false);
+    assert.equal(asyncWrap.getCallbackHistogram(Providers.FSREQWRAP, {}),
+                 false);
+  });
+}
@@ -0,0 +1,71 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var cluster = require('cluster');
+var net = require('net');
+
+// Platforms without SO_REUSEPORT fall back to sharing the master's listen
+// socket, the test should pass either way.
+cluster.schedulingPolicy = cluster.SCHED_REUSEPORT;
+
+if (cluster.isMaster) {
+  var ports = [];
+  var exited = 0;
+
+  var onmessage = function(msg) {
+    if (msg === 'accepted') {
+      // Connection got delivered, shut down.
+      for (var id in cluster.workers)
+        cluster.workers[id].disconnect();
+      return;
+    }
+    ports.push(msg);
+    if (ports.length < 2) return;
+    // Both workers listen on the same port even though they asked for 0.
+    assert.equal(ports[0], ports[1]);
+    net.connect(ports[0], '127.0.0.1', function() {
+      this.end();
+    });
+  };
+
+  var onexit = function(code) {
+    assert.equal(code, 0);
+    exited += 1;
+  };
+
+  for (var i = 0; i < 2; i += 1)
+    cluster.fork().on('message', onmessage).on('exit', onexit);
+
+  process.on('exit', function() {
+    assert.equal(ports.length, 2);
+    assert.equal(exited, 2);
+  });
+} else {
+  var server = net.createServer(function(conn) {
+    conn.resume();
+    process.send('accepted');
+  });
+  server.listen(0, '127.0.0.1', function() {
+    process.send(server.address().port);
+  });
+}
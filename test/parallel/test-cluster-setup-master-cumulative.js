@@ -35,6 +35,7 @@ assert.deepEqual(cluster.settings, {
   exec: process.argv[1],
   execArgv: process.execArgv,
   silent: false,
+  tlsSessionCacheSize: 0,
 });
 console.log('ok sets defaults');
 
@@ -58,5 +59,6 @@ assert.deepEqual(cluster.settings, {
   exec: 'overridden',
   execArgv: ['baz', 'bang'],
   silent: false,
+  tlsSessionCacheSize: 0,
 });
 console.log('ok preserves current settings');
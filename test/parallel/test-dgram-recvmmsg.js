@@ -0,0 +1,57 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var dgram = require('dgram');
+
+var N = 100;
+var received = [];
+
+var server = dgram.createSocket({ type: 'udp4', recvmmsg: true });
+var client = dgram.createSocket('udp4');
+
+server.on('message', function(msg, rinfo) {
+  assert.equal(rinfo.address, '127.0.0.1');
+  assert.equal(rinfo.port, client.address().port);
+  assert.equal(rinfo.size, msg.length);
+  received.push(msg.toString());
+  if (received.length === N) {
+    server.close();
+    client.close();
+  }
+});
+
+server.bind(0, '127.0.0.1', function() {
+  client.bind(0, '127.0.0.1', function() {
+    // Empty datagrams are delivered too, mix them in.
+    for (var i = 0; i < N; i += 1) {
+      var msg = new Buffer(i % 10 === 0 ? '' : 'message ' + i);
+      client.send(msg, 0, msg.length, server.address().port, '127.0.0.1');
+    }
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(received.length, N);
+  for (var i = 0; i < N; i += 1)
+    assert.equal(received[i], i % 10 === 0 ? '' : 'message ' + i);
+});
@@ -0,0 +1,78 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var dgram = require('dgram');
+
+var N = 50;
+var received = {};
+var receivedCount = 0;
+var callbacks = 0;
+
+var server = dgram.createSocket('udp4');
+var client = dgram.createSocket('udp4');
+
+server.on('message', function(msg, rinfo) {
+  received[msg.toString()] = true;
+  if (++receivedCount === 2 * N) {
+    server.close();
+    client.close();
+  }
+});
+
+server.bind(0, '127.0.0.1', function() {
+  var port = server.address().port;
+  var first = [];
+  var second = [];
+
+  for (var i = 0; i < N; i++) {
+    first.push({ buf: 'a' + i, port: port, address: '127.0.0.1' });
+    second.push({ buf: new Buffer('b' + i), port: port, address: 'localhost' });
+  }
+
+  // Both batches are flushed together but each gets its own callback.
+  client.sendBatch(first, function(err) {
+    assert.equal(err, null);
+    callbacks++;
+  });
+  client.sendBatch(second, function(err) {
+    assert.equal(err, null);
+    callbacks++;
+  });
+});
+
+assert.throws(function() {
+  client.sendBatch({});
+}, TypeError);
+
+assert.throws(function() {
+  client.sendBatch([{ buf: 'x', port: 0, address: '127.0.0.1' }]);
+}, RangeError);
+
+process.on('exit', function() {
+  assert.equal(callbacks, 2);
+  assert.equal(receivedCount, 2 * N);
+  for (var i = 0; i < N; i++) {
+    assert(received['a' + i]);
+    assert(received['b' + i]);
+  }
+});
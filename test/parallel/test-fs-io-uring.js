@@ -0,0 +1,87 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var path = require('path');
+var spawn = require('child_process').spawn;
+
+// Asynchronous fs operations with UV_USE_IO_URING=1 must behave exactly
+// like the thread pool implementation, whether or not the kernel supports
+// io_uring.
+if (process.argv[2] === 'child') {
+  var file = path.join(common.tmpDir, 'io-uring.txt');
+  var data = new Buffer('hello io_uring');
+
+  try { fs.unlinkSync(file); } catch (e) {}
+
+  fs.open(file, 'w+', function(err, fd) {
+    assert.ifError(err);
+    fs.write(fd, data, 0, data.length, null, function(err, written) {
+      assert.ifError(err);
+      assert.equal(written, data.length);
+      fs.fsync(fd, function(err) {
+        assert.ifError(err);
+        fs.fstat(fd, function(err, st) {
+          assert.ifError(err);
+          assert.deepEqual(st, fs.fstatSync(fd));
+          var buf = new Buffer(data.length);
+          fs.read(fd, buf, 0, buf.length, 0, function(err, bytesRead) {
+            assert.ifError(err);
+            assert.equal(bytesRead, data.length);
+            assert.equal(buf.toString(), data.toString());
+            fs.close(fd, function(err) {
+              assert.ifError(err);
+              fs.stat(file, function(err, st) {
+                assert.ifError(err);
+                assert.deepEqual(st, fs.statSync(file));
+                fs.stat(file + '.missing', function(err) {
+                  assert.equal(err.code, 'ENOENT');
+                  fs.unlinkSync(file);
+                  // Counted in the thread pool statistics either way.
+                  var usage = process.threadpoolUsage().fastIO;
+                  assert.equal(usage.submitted, 8);
+                  assert.equal(usage.completed, 8);
+                  assert.equal(usage.queued, 0);
+                });
+              });
+            });
+          });
+        });
+      });
+    });
+  });
+  return;
+}
+
+var env = {};
+for (var key in process.env) env[key] = process.env[key];
+env.UV_USE_IO_URING = '1';
+
+var child = spawn(process.execPath, [__filename, 'child'], {
+  env: env,
+  stdio: 'inherit'
+});
+
+child.on('exit', common.mustCall(function(code, signal) {
+  assert.equal(code, 0);
+  assert.equal(signal, null);
+}));
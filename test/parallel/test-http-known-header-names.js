@@ -0,0 +1,71 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var net = require('net');
+
+var HTTPParser = process.binding('http_parser').HTTPParser;
+var headerNames = HTTPParser.headerNames;
+assert.equal(headerNames.length % 2, 0);
+for (var i = 0; i < headerNames.length; i += 2)
+  assert.equal(headerNames[i], headerNames[i + 1].toLowerCase());
+assert.notEqual(headerNames.indexOf('Content-Length'), -1);
+
+// The parser doesn't use the exported array, writes don't affect it.
+headerNames[headerNames.indexOf('host')] = 'bogus';
+headerNames[headerNames.indexOf('Host')] = 'Bogus';
+
+var server = http.createServer(function(req, res) {
+  assert.deepEqual(req.rawHeaders, [
+    'Host', 'localhost',
+    'user-agent', 'test',
+    'ACCEPT', 'text/plain',
+    'Accept', 'text/html',
+    'Content-length', '0',
+    'X-Custom', 'a',
+    'x-custom', 'b'
+  ]);
+  assert.deepEqual(req.headers, {
+    host: 'localhost',
+    'user-agent': 'test',
+    accept: 'text/plain, text/html',
+    'content-length': '0',
+    'x-custom': 'a, b'
+  });
+  res.end();
+  server.close();
+});
+
+server.listen(common.PORT, function() {
+  var conn = net.connect(common.PORT);
+  conn.end('GET / HTTP/1.1\r\n' +
+           'Host: localhost\r\n' +
+           'user-agent: test\r\n' +
+           'ACCEPT: text/plain\r\n' +
+           'Accept: text/html\r\n' +
+           'Content-length: 0\r\n' +
+           'X-Custom: a\r\n' +
+           'x-custom: b\r\n' +
+           '\r\n');
+  conn.resume();
+});
@@ -42,6 +42,7 @@ var expected = maxAndExpected[requests][1];
 
 var server = http.createServer(function(req, res) {
   assert.equal(Object.keys(req.headers).length, expected);
+  assert.equal(req.rawHeaders.length, 2 * expected);
   if (++requests < maxAndExpected.length) {
     max = maxAndExpected[requests][0];
     expected = maxAndExpected[requests][1];
@@ -68,6 +69,7 @@ server.listen(common.PORT, function() {
       headers: headers
     }, function(res) {
       assert.equal(Object.keys(res.headers).length, expected);
+      assert.equal(res.rawHeaders.length, 2 * expected);
       res.on('end', function() {
         if (++responses < maxAndExpected.length) {
           doRequest();
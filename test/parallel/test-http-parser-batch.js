@@ -0,0 +1,142 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var net = require('net');
+
+var HTTPParser = process.binding('http_parser').HTTPParser;
+var kOnHeaders = HTTPParser.kOnHeaders | 0;
+var kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
+var kOnBody = HTTPParser.kOnBody | 0;
+var kOnMessageComplete = HTTPParser.kOnMessageComplete | 0;
+var kOnMessages = HTTPParser.kOnMessages | 0;
+
+var requests =
+    'GET /a HTTP/1.1\r\nHost: x\r\n\r\n' +
+    'POST /b HTTP/1.1\r\nHost: x\r\nContent-Length: 5\r\n\r\nhello' +
+    'POST /c HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n' +
+    '3\r\nabc\r\n0\r\nX-Trailer: yes\r\n\r\n' +
+    'GET /d HTTP/1.1\r\nHost: x\r\n\r\n';
+
+// Returns the callbacks that |parser| made while parsing |buf|, in order.
+function parse(parser, buf) {
+  var events = [];
+  var executes = 0;
+  parser[kOnHeaders] = function(headers, url) {
+    events.push(['headers', headers]);
+  };
+  parser[kOnHeadersComplete] = function(info) {
+    events.push(['headersComplete', info.url, info.headers]);
+  };
+  parser[kOnBody] = function(b, start, len) {
+    events.push(['body', b.toString('binary', start, start + len)]);
+  };
+  parser[kOnMessageComplete] = function() {
+    events.push(['messageComplete']);
+  };
+  parser[kOnMessages] = function(list, b) {
+    assert.equal(list.length % 3, 0);
+    assert.strictEqual(b, buf);
+    executes += 1;
+    for (var i = 0; i < list.length; i += 3) {
+      if (list[i] === kOnHeaders)
+        parser[kOnHeaders](list[i + 1], list[i + 2]);
+      else if (list[i] === kOnHeadersComplete)
+        parser[kOnHeadersComplete](list[i + 1]);
+      else if (list[i] === kOnBody)
+        parser[kOnBody](b, list[i + 1], list[i + 2]);
+      else if (list[i] === kOnMessageComplete)
+        parser[kOnMessageComplete]();
+      else
+        assert(false, 'unexpected callback ' + list[i]);
+    }
+  };
+  assert.equal(parser.execute(buf), buf.length);
+  return { events: events, executes: executes };
+}
+
+var buf = new Buffer(requests, 'binary');
+
+var expected = parse(new HTTPParser(HTTPParser.REQUEST), buf);
+assert.equal(expected.executes, 0);
+assert.equal(expected.events.filter(function(e) {
+  return e[0] === 'messageComplete';
+}).length, 4);
+
+var parser = new HTTPParser(HTTPParser.REQUEST);
+parser.setBatchMode(true);
+var actual = parse(parser, buf);
+assert.equal(actual.executes, 1);
+assert.deepEqual(actual.events, expected.events);
+
+// reinitialize() switches batch mode off.
+parser.reinitialize(HTTPParser.REQUEST);
+assert.equal(parse(parser, buf).executes, 0);
+
+// Response parsers don't batch, onHeadersComplete decides whether to skip
+// the body.
+parser = new HTTPParser(HTTPParser.RESPONSE);
+parser.setBatchMode(true);
+buf = new Buffer('HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok', 'binary');
+assert.equal(parse(parser, buf).executes, 0);
+
+// Pipelined requests through the server, sent in one write.
+var urls = [];
+var bodies = [];
+var response = '';
+var server = http.createServer(function(req, res) {
+  urls.push(req.url);
+  var body = '';
+  req.setEncoding('binary');
+  req.on('data', function(chunk) {
+    body += chunk;
+  });
+  req.on('end', function() {
+    bodies.push(body);
+    res.setHeader('Content-Length', req.url.length);
+    res.end(req.url);
+  });
+});
+
+server.listen(common.PORT, function() {
+  var socket = net.connect(common.PORT);
+  socket.setEncoding('binary');
+  socket.on('data', function(chunk) {
+    response += chunk;
+    if (/\/d$/.test(response))
+      socket.end();
+  });
+  socket.on('end', function() {
+    server.close();
+  });
+  socket.write(requests);
+});
+
+process.on('exit', function() {
+  assert.deepEqual(urls, ['/a', '/b', '/c', '/d']);
+  assert.deepEqual(bodies, ['', 'hello', 'abc', '']);
+  var order = response.match(/\r\n\r\n\/[abcd]/g).map(function(s) {
+    return s.slice(4);
+  });
+  assert.deepEqual(order, ['/a', '/b', '/c', '/d']);
+});
@@ -0,0 +1,112 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var IncomingMessage = require('_http_incoming').IncomingMessage;
+
+var HTTPParser = process.binding('http_parser').HTTPParser;
+var kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
+
+// Parses |request| and returns the info object passed to onHeadersComplete.
+function parse(request, maxHeaderPairs) {
+  var parser = new HTTPParser(HTTPParser.REQUEST);
+  var info = null;
+  parser[kOnHeadersComplete] = function(info_) {
+    info = info_;
+  };
+  if (maxHeaderPairs !== undefined)
+    parser.setHeadersObject(maxHeaderPairs);
+  var buf = new Buffer(request, 'binary');
+  assert.equal(parser.execute(buf, 0, buf.length), buf.length);
+  assert(info);
+  return info;
+}
+
+// The headers object built by the parser must match what
+// IncomingMessage#_addHeaderLines() builds from the flat list.
+function check(headerLines, maxHeaderPairs) {
+  var request = 'GET / HTTP/1.1\r\n' + headerLines.join('\r\n') + '\r\n\r\n';
+  var limit = maxHeaderPairs || 0;
+
+  var flat = parse(request);
+  assert(Array.isArray(flat.headers));
+  assert.equal(flat.rawHeaders, undefined);
+  var message = new IncomingMessage(null);
+  var n = flat.headers.length;
+  if (limit > 0)
+    n = Math.min(n, limit);
+  message._addHeaderLines(flat.headers, n);
+
+  var info = parse(request, limit);
+  assert(!Array.isArray(info.headers));
+  assert.deepEqual(info.rawHeaders, message.rawHeaders);
+  assert.deepEqual(info.headers, message.headers);
+  assert.deepEqual(Object.keys(info.headers), Object.keys(message.headers));
+  return info;
+}
+
+var info = check([
+  'Host: example.com',
+  'HOST: example.org',
+  'User-Agent: test',
+  'accept: text/html',
+  'Accept: text/plain',
+  'aCCept: */*',
+  'Set-Cookie: a=1',
+  'set-cookie: b=2',
+  'Content-Length: 0',
+  'X-Custom: 1',
+  'x-custom: 2',
+  'X-CUSTOM: 3',
+  'x-lower: yes',
+  'Empty:'
+]);
+assert.deepEqual(info.headers, {
+  host: 'example.com',
+  'user-agent': 'test',
+  accept: 'text/html, text/plain, */*',
+  'set-cookie': ['a=1', 'b=2'],
+  'content-length': '0',
+  'x-custom': '1, 2, 3',
+  'x-lower': 'yes',
+  empty: ''
+});
+
+check([]);
+check(['Connection: keep-alive']);
+
+// The limit counts names and values. It applies to rawHeaders too, like
+// it does when _addHeaderLines() builds them.
+info = check(['A: 1', 'B: 2', 'C: 3', 'D: 4'], 4);
+assert.deepEqual(info.headers, { a: '1', b: '2' });
+assert.deepEqual(info.rawHeaders, ['A', '1', 'B', '2']);
+check(['A: 1', 'B: 2', 'C: 3', 'D: 4'], 3);
+
+// Switched off again.
+var parser = new HTTPParser(HTTPParser.REQUEST);
+parser.setHeadersObject(0);
+parser.setHeadersObject(false);
+parser[kOnHeadersComplete] = function(info) {
+  assert.deepEqual(info.headers, ['Host', 'x']);
+};
+var buf = new Buffer('GET / HTTP/1.1\r\nHost: x\r\n\r\n');
+parser.execute(buf, 0, buf.length);
@@ -0,0 +1,132 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var ServerResponse = require('http').ServerResponse;
+
+// The response head that is built in C++ must be the same as the one
+// OutgoingMessage#_storeHeader() builds.
+function jsStoreResponseHead(statusCode, reason, headers) {
+  var statusLine = 'HTTP/1.1 ' + statusCode.toString() + ' ' + reason + '\r\n';
+  this._storeHeader(statusLine, headers);
+}
+
+function respond(test, js) {
+  var req = {
+    method: test.method || 'GET',
+    httpVersionMajor: 1,
+    httpVersionMinor: test.minor === undefined ? 1 : test.minor,
+    headers: test.requestHeaders || {}
+  };
+  var res = new ServerResponse(req);
+  if (js)
+    res._storeResponseHead = jsStoreResponseHead;
+  if (test.shouldKeepAlive === false)
+    res.shouldKeepAlive = false;
+  if (test.sendDate === false)
+    res.sendDate = false;
+  if (test.chunkedByDefault === false)
+    res.useChunkedEncodingByDefault = false;
+  if (test.agent)
+    res.agent = test.agent;
+  (test.set || []).forEach(function(pair) {
+    res.setHeader(pair[0], pair[1]);
+  });
+  (test.remove || []).forEach(function(name) {
+    res.removeHeader(name);
+  });
+  if (test.reason)
+    res.writeHead(test.statusCode || 200, test.reason, test.headers);
+  else
+    res.writeHead(test.statusCode || 200, test.headers);
+  return res;
+}
+
+function check(test) {
+  var expected = respond(test, true);
+  var actual = respond(test, false);
+  assert.equal(typeof actual._header, 'string');
+  assert.equal(actual._header, expected._header);
+  assert.equal(actual._last, expected._last);
+  assert.equal(actual.shouldKeepAlive, expected.shouldKeepAlive);
+  assert.equal(actual.chunkedEncoding, expected.chunkedEncoding);
+  assert.equal(actual._hasBody, expected._hasBody);
+}
+
+[
+  {},
+  { statusCode: 404 },
+  { statusCode: 299 },
+  { statusCode: 99 },
+  { statusCode: 0 },
+  { reason: 'Very OK' },
+  { headers: { 'Content-Type': 'application/json', 'Content-Length': 2 } },
+  { headers: { 'content-length': '0', 'Connection': 'close' } },
+  { headers: { 'Connection': 'Keep-Alive' } },
+  { headers: { 'Connection': 'keep-alive, Close' } },
+  { headers: { 'Proxy-Connection': 'close' } },
+  { headers: { 'Transfer-Encoding': 'chunked' } },
+  { headers: { 'Transfer-Encoding': 'gzip' } },
+  { headers: { 'Date': 'Thu, 01 Jan 1970 00:00:00 GMT' } },
+  { headers: { 'Last-Modified-Date': 'yesterday' } },
+  { headers: { 'Expect': '100-continue' } },
+  { headers: { 'Set-Cookie': ['a=1', 'b=2'], 'X-Number': 42 } },
+  { headers: [['X-A', '1'], ['X-A', '2'], ['Set-Cookie', ['c=3', 'd=4']]] },
+  { headers: { 'X-Split': 'a\r\n  b\n\tc\r\rd' } },
+  { headers: { 'X-Latin1': 'café' } },
+  { headers: { 'X-Snowman': '☃' } },
+  { headers: { 'X-Long': new Array(10000).join('x') } },
+  { statusCode: 204 },
+  { statusCode: 204, headers: { 'Transfer-Encoding': 'chunked' } },
+  { statusCode: 304, headers: { 'Transfer-Encoding': 'chunked' } },
+  { statusCode: 101, headers: { 'Upgrade': 'websocket' } },
+  { method: 'HEAD' },
+  { minor: 0 },
+  { minor: 0, requestHeaders: { te: 'chunked' } },
+  { minor: 0, headers: { 'Content-Length': 5 } },
+  { shouldKeepAlive: false },
+  { shouldKeepAlive: false, headers: { 'Connection': 'keep-alive' } },
+  { sendDate: false },
+  // Only useChunkedEncodingByDefault decides about Transfer-Encoding, an
+  // agent just allows keep-alive.
+  { chunkedByDefault: false },
+  { chunkedByDefault: false, agent: {} },
+  { agent: {} },
+  { set: [['X-Set', 'yes'], ['Content-Length', 3]], headers: { 'X-B': 'b' } },
+  { remove: ['Date'] },
+  { remove: ['Connection'] },
+  { remove: ['Transfer-Encoding'] },
+  { remove: ['Connection', 'Transfer-Encoding'], headers: { 'X-C': 'c' } },
+  // Not objects, _storeHeader() takes them as they come.
+  { reason: 'OK', headers: 'bogus' },
+  { reason: 'OK', headers: 5 },
+  { reason: 'OK', headers: true },
+  { headers: [['X-A', '1'], 'bogus'] },
+].forEach(check);
+
+// Status codes that aren't numbers still take the JS path.
+assert.throws(function() {
+  new ServerResponse({ headers: {} }).writeHead(undefined);
+}, TypeError);
+var res = new ServerResponse({ httpVersionMajor: 1, httpVersionMinor: 1 });
+res.writeHead('200');
+assert(/^HTTP\/1\.1 200 OK\r\n/.test(res._header));
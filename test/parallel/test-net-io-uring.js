@@ -0,0 +1,70 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+var spawn = require('child_process').spawn;
+
+// Many connections opening, closing and toggling between reading and
+// writing in the same loop iteration, with watcher changes going through
+// io_uring where supported. Falls back to epoll_ctl(2) everywhere else.
+var N = 300;
+
+if (process.argv[2] === 'child') {
+  var server = net.createServer(function(conn) {
+    conn.pipe(conn);
+  });
+
+  server.listen(common.PORT, function() {
+    var done = 0;
+    for (var i = 0; i < N; i++) {
+      net.connect(common.PORT, function() {
+        var conn = this;
+        var data = '';
+        conn.setEncoding('utf8');
+        conn.on('data', function(chunk) {
+          data += chunk;
+          if (data.length === 5) conn.end();
+        });
+        conn.on('end', function() {
+          assert.equal(data, 'hello');
+          if (++done === N) server.close();
+        });
+        conn.write('hello');
+      });
+    }
+  });
+  return;
+}
+
+var env = {};
+for (var key in process.env) env[key] = process.env[key];
+env.UV_USE_IO_URING = '1';
+
+var child = spawn(process.execPath, [__filename, 'child'], {
+  env: env,
+  stdio: 'inherit'
+});
+
+child.on('exit', common.mustCall(function(code, signal) {
+  assert.equal(code, 0);
+  assert.equal(signal, null);
+}));
@@ -0,0 +1,82 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Small reads are copied out of the read slab so that retaining one of them
+// doesn't keep the whole slab alive, larger reads reference the slab.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+var stream_wrap = process.binding('stream_wrap');
+
+var kMaxCopySize = 4 * 1024;
+var chunks = 0;
+var small = 0;
+
+function count(chunk) {
+  chunks++;
+  if (chunk.length <= kMaxCopySize)
+    small++;
+}
+
+var stats = stream_wrap.getReadSlabStats();
+
+var server = net.createServer(function(socket) {
+  socket.on('data', function(chunk) {
+    count(chunk);
+    socket.write(chunk);
+  });
+});
+
+server.listen(common.PORT, function() {
+  var client = net.connect(common.PORT);
+  var expected = 0;
+  var received = 0;
+  var rounds = [new Buffer('ping'), new Buffer(64 * 1024)];
+
+  function next() {
+    var data = rounds.shift();
+    if (!data) return client.end();
+    expected += data.length;
+    client.write(data);
+  }
+
+  client.on('data', function(chunk) {
+    count(chunk);
+    received += chunk.length;
+    if (received === expected)
+      next();
+  });
+
+  client.on('close', function() {
+    server.close();
+  });
+
+  next();
+});
+
+process.on('exit', function() {
+  var now = stream_wrap.getReadSlabStats();
+  assert(small > 0);
+  assert(small < chunks);
+  assert.equal(now.buffers - stats.buffers, chunks);
+  assert.equal(now.copies - stats.copies, small);
+});
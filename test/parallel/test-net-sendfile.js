@@ -0,0 +1,87 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var net = require('net');
+var path = require('path');
+
+// Big enough to fill up the socket buffer so the transfer has to wait for
+// the peer at least once.
+var size = 4 * 1024 * 1024;
+var filename = path.join(common.tmpDir, 'sendfile.bin');
+var data = new Buffer(size);
+for (var i = 0; i < size; i++)
+  data[i] = i % 251;
+
+try { fs.unlinkSync(filename); } catch (e) {}
+fs.writeFileSync(filename, data);
+
+var fd = fs.openSync(filename, 'r');
+var offset = 1234;
+var length = size - 2 * offset;
+var callbacks = 0;
+
+var server = net.createServer(function(socket) {
+  socket.write('head');
+  socket.sendFile(fd, offset, length, function(err) {
+    assert.ifError(err);
+    callbacks++;
+  });
+  // Past the end of the file, should stop at EOF.
+  socket.sendFile(fd, size - 3, 100);
+  socket.end('tail');
+});
+
+server.listen(common.PORT, function() {
+  var chunks = [];
+  var conn = net.connect(common.PORT);
+
+  // Don't read anything for a while so the sender hits EAGAIN.
+  conn.pause();
+  setTimeout(function() {
+    conn.resume();
+  }, 100);
+
+  conn.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+
+  conn.on('end', function() {
+    var received = Buffer.concat(chunks);
+    var expected = Buffer.concat([
+      new Buffer('head'),
+      data.slice(offset, offset + length),
+      data.slice(size - 3),
+      new Buffer('tail')
+    ]);
+    assert.equal(received.length, expected.length);
+    assert.ok(received.toString('hex') === expected.toString('hex'));
+    server.close();
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(callbacks, 1);
+  fs.closeSync(fd);
+  fs.unlinkSync(filename);
+});
@@ -0,0 +1,77 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Large strings that Buffer#toString() returns are external strings that
+// get written to the socket without being copied first. Check that what
+// arrives on the other end is the same as with a copy.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+var encodings = ['ascii', 'binary', 'ucs2', 'utf8'];
+var pending = encodings.length;
+
+var source = new Buffer(2 * 1024 * 1024);
+for (var i = 0; i < source.length; i++)
+  source[i] = i % 251;
+
+encodings.forEach(function(encoding, index) {
+  var string = source.toString(encoding);
+  var small = 'small ' + encoding + ' chunk';
+
+  var expected = Buffer.concat([
+    new Buffer(string, encoding),
+    new Buffer(string, encoding),
+    new Buffer(small, encoding),
+    new Buffer(string, encoding)
+  ]);
+
+  var server = net.createServer(function(socket) {
+    // A plain write, then a writev that mixes external and heap strings.
+    socket.write(string, encoding);
+    socket.cork();
+    socket.write(string, encoding);
+    socket.write(small, encoding);
+    socket.write(string, encoding);
+    socket.uncork();
+    socket.end();
+  });
+
+  server.listen(common.PORT + index, function() {
+    var chunks = [];
+    var client = net.connect(common.PORT + index);
+    client.on('data', function(chunk) {
+      chunks.push(chunk);
+    });
+    client.on('end', function() {
+      var actual = Buffer.concat(chunks);
+      assert.equal(actual.length, expected.length, encoding);
+      assert.ok(actual.toString('hex') === expected.toString('hex'), encoding);
+      server.close();
+      pending--;
+    });
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(pending, 0);
+});
@@ -0,0 +1,65 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+var phases = ['timers', 'pending', 'idlePrepare', 'pollWait', 'pollIO',
+              'check', 'closing'];
+
+function sum(usage) {
+  return phases.reduce(function(total, name) {
+    return total + usage.phases[name];
+  }, 0);
+}
+
+var before = process.eventLoopUsage();
+assert.deepEqual(Object.keys(before.phases), phases);
+assert.equal(before.idle, before.phases.pollWait);
+assert.equal(before.active + before.idle, sum(before));
+
+setTimeout(function() {
+  var afterTimer = process.eventLoopUsage();
+  assert(afterTimer.iterations > before.iterations);
+  // Not strictly greater: on a loaded machine startup can take longer than
+  // the timeout and then the timer fires before the loop ever blocks.
+  assert(afterTimer.phases.pollWait >= before.phases.pollWait);
+
+  var server = net.createServer(function(conn) {
+    conn.end();
+    server.close();
+  });
+  server.listen(common.PORT, function() {
+    net.connect(common.PORT).on('end', function() {
+      setImmediate(function() {
+        var after = process.eventLoopUsage();
+        assert(after.events > afterTimer.events);
+        assert(after.phases.check >= afterTimer.phases.check);
+        assert.equal(after.idle, after.phases.pollWait);
+        assert.equal(after.active + after.idle, sum(after));
+        phases.forEach(function(name) {
+          assert(after.phases[name] >= before.phases[name], name);
+        });
+      });
+    }).resume();
+  });
+}, 20);
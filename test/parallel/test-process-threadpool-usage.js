@@ -0,0 +1,46 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+
+function sum(histogram) {
+  return histogram.reduce(function(a, b) { return a + b; }, 0);
+}
+
+var before = process.threadpoolUsage();
+assert.deepEqual(Object.keys(before), ['fastIO', 'slowIO', 'cpu']);
+
+fs.stat(__filename, function(err) {
+  assert.ifError(err);
+
+  var after = process.threadpoolUsage().fastIO;
+  assert(after.threads > 0);
+  assert.equal(after.queued, 0);
+  assert.equal(after.submitted, before.fastIO.submitted + 1);
+  assert.equal(after.completed, before.fastIO.completed + 1);
+  assert(after.waitTime >= before.fastIO.waitTime);
+  assert(after.runTime >= before.fastIO.runTime);
+  assert.equal(after.waitHistogram.length, after.runHistogram.length);
+  assert.equal(sum(after.waitHistogram), after.completed);
+  assert.equal(sum(after.runHistogram), after.completed);
+});
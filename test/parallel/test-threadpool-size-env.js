@@ -0,0 +1,75 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var spawn = require('child_process').spawn;
+
+try {
+  require('crypto');
+} catch (e) {
+  console.log('Not compiled with OPENSSL support.');
+  process.exit();
+}
+
+if (process.argv[2] === 'child') {
+  require('crypto').pbkdf2('password', 'salt', 1, 16, function(err) {
+    assert.ifError(err);
+    console.log(JSON.stringify(process.threadpoolUsage().cpu.threads));
+  });
+  return;
+}
+
+// UV_THREADPOOL_SIZE sized the one pool that all work used to share. It
+// still sizes the CPU class unless UV_THREADPOOL_CPU_SIZE says otherwise.
+var tests = [
+  { env: {}, threads: 2 },
+  { env: { UV_THREADPOOL_SIZE: '8' }, threads: 8 },
+  { env: { UV_THREADPOOL_SIZE: '8', UV_THREADPOOL_CPU_SIZE: '3' }, threads: 3 }
+];
+var done = 0;
+
+tests.forEach(function(test) {
+  var env = {};
+  for (var key in process.env) {
+    if (!/^UV_THREADPOOL_/.test(key))
+      env[key] = process.env[key];
+  }
+  for (var key in test.env)
+    env[key] = test.env[key];
+
+  var child = spawn(process.execPath, [__filename, 'child'], { env: env });
+  var out = '';
+  child.stdout.setEncoding('utf8');
+  child.stdout.on('data', function(data) {
+    out += data;
+  });
+  child.on('close', function(code) {
+    assert.equal(code, 0);
+    assert.equal(+out, test.threads, JSON.stringify(test.env));
+    done++;
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(done, tests.length);
+});
@@ -0,0 +1,76 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+var timers = require('timers');
+var Timer = process.binding('timer_wrap').Timer;
+
+// Timeouts with slack never fire early and the ones that fall into the same
+// bucket fire together.
+
+var N = 50;
+var SLACK = 100;
+var fired = 0;
+var batches = 0;
+var inBatch = false;
+
+function onTimeout() {
+  var now = Timer.now();
+  var expiry = this._idleStart + this._idleTimeout;
+  assert.ok(now >= expiry, 'fired early: ' + now + ' < ' + expiry);
+  fired += 1;
+
+  if (!inBatch) {
+    inBatch = true;
+    batches += 1;
+    process.nextTick(function() {
+      inBatch = false;
+    });
+  }
+}
+
+for (var i = 0; i < N; i += 1) {
+  var item = { _onTimeout: onTimeout };
+  timers.enroll(item, 20 + i, SLACK);
+  timers.active(item);
+}
+
+// The same with sockets.
+var server = net.createServer(function(conn) {
+  conn.setTimeoutSlack(SLACK);
+  conn.setTimeout(10, common.mustCall(function() {
+    conn.destroy();
+    server.close();
+  }));
+});
+
+server.listen(common.PORT, function() {
+  net.connect(common.PORT);
+});
+
+process.on('exit', function() {
+  assert.equal(fired, N);
+  // The expiry times span less than SLACK milliseconds, so at most two
+  // buckets.
+  assert.ok(batches <= 2, batches + ' batches');
+});
@@ -0,0 +1,81 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var timers = require('timers');
+
+// unref() and ref() move a Timeout between the timing wheels without
+// giving it a handle of its own or changing when it expires.
+
+var rearmed = false;
+var intervalRuns = 0;
+var start;
+
+var timeout = setTimeout(function() {
+  rearmed = true;
+}, 100);
+start = timeout._idleStart;
+timeout.unref();
+assert.strictEqual(timeout._handle, undefined);
+assert.strictEqual(timeout._idleStart, start);
+timeout.ref();
+assert.strictEqual(timeout._idleStart, start);
+
+// An unref'd interval must stay unref'd after it fired, otherwise the
+// process never exits.
+var interval = setInterval(function() {
+  intervalRuns += 1;
+}, 10);
+interval.unref();
+assert.strictEqual(interval._handle, undefined);
+
+// A timeout with slack that moves back and forth stays in the bucket it was
+// armed in and expires together with the others in it.
+var bucket = [];
+var bucketRuns = 0;
+function onBucketTimeout() {
+  if (bucket.length === 0)
+    setImmediate(function() { bucket = null; });
+  assert.notStrictEqual(bucket, null, 'moved timeout left its bucket');
+  bucket.push(this);
+  bucketRuns += 1;
+}
+var slacker = setTimeout(function() {}, 1000);
+var other = { _onTimeout: onBucketTimeout };
+timers.enroll(slacker, 250, 100);
+timers.enroll(other, 250, 100);
+slacker._onTimeout = onBucketTimeout;
+timers.active(slacker);
+timers.active(other);
+start = slacker._idleStart;
+// Let the clock move on before the timeout moves.
+var busy = Date.now();
+while (Date.now() - busy < 5) {}
+slacker.unref();
+slacker.ref();
+assert.strictEqual(slacker._idleStart, start);
+
+process.on('exit', function() {
+  assert.equal(bucketRuns, 2);
+  assert.ok(rearmed, 'ref()\'d timeout should keep the loop alive and fire');
+  assert.ok(intervalRuns > 1, 'unref()\'d interval should still fire');
+});
@@ -0,0 +1,90 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var timers = require('timers');
+var Timer = process.binding('timer_wrap').Timer;
+
+// Idle timeouts with many different durations, some of them long enough to
+// be cascaded down the timing wheel, must fire in expiry order and never
+// before they are due. Timeouts that are rearmed or cleared must not fire
+// at their old expiry.
+
+var N = 200;
+var items = [];
+var fired = 0;
+var expected = 0;
+var lastExpiry = [0, 0];
+
+function onTimeout() {
+  var now = Timer.now();
+  var expiry = this._idleStart + this._idleTimeout;
+  assert.ok(!this.cleared, 'cleared timeout fired');
+  assert.ok(!this.rearm, 'fired at its old expiry');
+  assert.ok(now >= expiry, 'fired early: ' + now + ' < ' + expiry);
+  // Only the timeouts in the same wheel are ordered with respect to
+  // each other.
+  assert.ok(expiry >= lastExpiry[this.unref], 'out of order: ' + expiry);
+  lastExpiry[this.unref] = expiry;
+  fired += 1;
+}
+
+function arm(item) {
+  if (item.unref)
+    timers._unrefActive(item);
+  else
+    timers.active(item);
+}
+
+for (var i = 0; i < N; i += 1) {
+  var item = {
+    unref: i % 2,
+    cleared: i % 10 === 0,
+    rearm: i % 10 === 5,
+    _onTimeout: onTimeout
+  };
+  // Spread over the first level of the wheel and well into the second.
+  timers.enroll(item, item.rearm ? 300 + i : (i * 37) % 700 + 1);
+  arm(item);
+  items.push(item);
+
+  if (item.cleared)
+    timers.unenroll(item);
+  else
+    expected += 1;
+}
+
+setTimeout(function() {
+  items.forEach(function(item) {
+    if (item.rearm) {
+      item.rearm = false;
+      arm(item);
+    }
+  });
+}, 50);
+
+// Keeps the event loop alive for the unref'd timeouts.
+setTimeout(function() {}, 1200);
+
+process.on('exit', function() {
+  assert.equal(fired, expected);
+});
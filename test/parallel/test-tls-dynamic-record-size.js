@@ -0,0 +1,149 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var net = require('net');
+var tls = require('tls');
+
+var options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+};
+
+var message = new Buffer(64 * 1024);
+message.fill('x');
+
+// Lengths of the application data records that the server sends.
+var records = [];
+
+var server = tls.createServer(options, function(socket) {
+  socket.once('data', function(data) {
+    if (data.toString() === 'fixed')
+      assert(socket.setMaxSendFragment(4096));
+    if (data.toString() === 'small') {
+      // Picked while small records are being sent already.
+      socket.write('x');
+      assert(socket.setMaxSendFragment(1360));
+    }
+    socket.write(message);
+    // Idle long enough for the next write to start a new burst.
+    setTimeout(function() {
+      socket.end(message);
+    }, 1200);
+  });
+});
+
+// Sits between client and server and parses the record headers.
+var proxy = net.createServer(function(client) {
+  var socket = net.connect(common.PORT, function() {
+    client.pipe(socket);
+  });
+  var pending = new Buffer(0);
+  socket.on('data', function(data) {
+    client.write(data);
+    pending = Buffer.concat([pending, data]);
+    while (pending.length >= 5) {
+      var length = pending.readUInt16BE(3);
+      if (pending.length < 5 + length)
+        break;
+      if (pending[0] === 23)  // application_data
+        records.push(length);
+      pending = pending.slice(5 + length);
+    }
+  });
+  socket.on('end', function() {
+    client.end();
+  });
+});
+
+function test(mode, cb) {
+  records = [];
+  var client = tls.connect({
+    port: common.PORT + 1,
+    rejectUnauthorized: false
+  }, function() {
+    client.write(mode);
+  });
+  var received = 0;
+  client.on('data', function(data) {
+    received += data.length;
+  });
+  client.on('end', function() {
+    assert.equal(received, 2 * message.length + (mode === 'small' ? 1 : 0));
+    cb();
+  });
+}
+
+// Small records for the first 16 kB of each burst, full size records after.
+function checkDynamic() {
+  var bursts = 0;
+  var small = 0;
+  records.forEach(function(length, i) {
+    assert(length < 1448 || length > 16384, 'record length ' + length);
+    if (length < 1448) {
+      if (i === 0 || records[i - 1] > 16384)
+        bursts++;
+      small++;
+    }
+  });
+  assert.equal(bursts, 2);
+  assert(small >= 2 * Math.ceil(16384 / 1360));
+  assert(records[records.length - 1] > 16384);
+}
+
+// setMaxSendFragment() turns it off.
+function checkFixed() {
+  records.forEach(function(length) {
+    assert(length > 4096 && length < 4096 + 100, 'record length ' + length);
+  });
+}
+
+// Even if it's the size that is in use at the time.
+function checkSmall() {
+  records.forEach(function(length) {
+    assert(length < 1448, 'record length ' + length);
+  });
+  assert(records.length > 2 * Math.ceil(message.length / 1360));
+}
+
+server.listen(common.PORT, function() {
+  proxy.listen(common.PORT + 1, function() {
+    test('dynamic', function() {
+      checkDynamic();
+      test('fixed', function() {
+        checkFixed();
+        test('small', function() {
+          checkSmall();
+          proxy.close();
+          server.close();
+        });
+      });
+    });
+  });
+});
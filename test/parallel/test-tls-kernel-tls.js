@@ -0,0 +1,146 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var path = require('path');
+var tls = require('tls');
+
+// The kernel may or may not be able to take over, either way the data has
+// to arrive intact. Only check that it did take over when we know it can:
+// node has to be built with kernel TLS support and the kernel needs the
+// "tls" ULP. Without both, only the userspace fallback is tested and the
+// kernel path is not covered at all.
+var ulp = '';
+try {
+  ulp = fs.readFileSync('/proc/sys/net/ipv4/tcp_available_ulp', 'utf8');
+} catch (e) {}
+var haveKernelTLS = false;
+if (!process.binding('tls_wrap').haveKernelTLS)
+  console.error('Built without kernel TLS support, only testing the ' +
+                'userspace fallback.');
+else if (!/\btls\b/.test(ulp))
+  console.error('No "tls" ULP in the kernel, only testing the userspace ' +
+                'fallback.');
+else
+  haveKernelTLS = true;
+
+var size = 1024 * 1024;
+var filename = path.join(common.tmpDir, 'kernel-tls.bin');
+var data = new Buffer(size);
+for (var i = 0; i < size; i++)
+  data[i] = i % 251;
+
+try { fs.unlinkSync(filename); } catch (e) {}
+fs.writeFileSync(filename, data);
+var fd = fs.openSync(filename, 'r');
+
+var payload = new Buffer(256 * 1024);
+payload.fill('p');
+
+var tests = [
+  { ciphers: 'AES128-GCM-SHA256', kernel: haveKernelTLS },
+  { ciphers: 'AES256-GCM-SHA384', kernel: haveKernelTLS },
+  { ciphers: 'AES128-SHA', kernel: false }
+];
+var done = 0;
+
+function test(conf, cb) {
+  var options = {
+    key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+    cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem'),
+    ciphers: conf.ciphers,
+    kernelTLS: true
+  };
+
+  var server = tls.createServer(options, function(socket) {
+    var received = 0;
+    socket.on('data', function(chunk) {
+      received += chunk.length;
+      // The pause after the handshake lets the kernel take over.
+      if (received === 4)
+        return socket.write('pong');
+      if (received < 4 + payload.length)
+        return;
+      assert.equal(received, 4 + payload.length);
+      assert.equal(socket.isKernelTLS(), conf.kernel);
+      socket.sendFile(fd, 0, size);
+      socket.end('tail');
+    });
+  });
+
+  server.listen(common.PORT, function() {
+    var client = tls.connect({
+      port: common.PORT,
+      rejectUnauthorized: false,
+      kernelTLS: true
+    }, function() {
+      setTimeout(function() {
+        client.write('ping');
+      }, 50);
+    });
+
+    var chunks = [];
+    var length = 0;
+    client.on('data', function(chunk) {
+      chunks.push(chunk);
+      length += chunk.length;
+      if (length === 4)
+        client.write(payload);
+    });
+
+    client.on('end', function() {
+      var received = Buffer.concat(chunks);
+      var expected = Buffer.concat([new Buffer('pong'), data, new Buffer('tail')]);
+      assert.equal(received.length, expected.length);
+      assert.ok(received.toString('hex') === expected.toString('hex'));
+      assert.equal(client.isKernelTLS(), conf.kernel);
+
+      // OpenSSL can't renegotiate once the kernel has the keys.
+      if (conf.kernel)
+        assert.equal(client.renegotiate({}), false);
+
+      server.close(cb);
+    });
+  });
+}
+
+(function next() {
+  if (done === tests.length)
+    return;
+  test(tests[done], function() {
+    done++;
+    next();
+  });
+})();
+
+process.on('exit', function() {
+  assert.equal(done, tests.length);
+  fs.closeSync(fd);
+  fs.unlinkSync(filename);
+});
@@ -0,0 +1,123 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Flags: --expose-gc
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+// One thread, so that the handshakes queue up behind each other. Set before
+// anything uses the threadpool.
+process.env.UV_THREADPOOL_SIZE = '1';
+
+var common = require('../common');
+var assert = require('assert');
+var crypto = require('crypto');
+var fs = require('fs');
+var tls = require('tls');
+
+// Sockets whose handshake times out while it's queued or running on the
+// threadpool are collected without waiting for the handshake. Queued work
+// is cancelled, running work frees the SSL object when it's done.
+
+function loadPEM(n) {
+  return fs.readFileSync(common.fixturesDir + '/keys/' + n + '.pem');
+}
+
+var rounds = [queued, running];
+var timedOut = 0;
+var completed = 0;
+
+var server = tls.createServer({
+  key: loadPEM('agent1-key'),
+  cert: loadPEM('agent1-cert'),
+  offloadHandshake: true,
+  handshakeTimeout: 50
+}, function(socket) {
+  completed++;
+  socket.destroy();
+});
+
+server.on('clientError', function(err, socket) {
+  if (!/timeout/.test(err.message))
+    return;
+  timedOut++;
+  socket.destroy();
+  // Once the socket is closed.
+  setTimeout(function() {
+    gc();
+    gc();
+  }, 10);
+});
+
+function connect(count, cb) {
+  var closed = 0;
+  timedOut = 0;
+  completed = 0;
+  for (var i = 0; i < count; i++) {
+    var client = tls.connect({
+      host: '127.0.0.1',
+      port: common.PORT,
+      rejectUnauthorized: false
+    });
+    client.on('error', function() {});
+    client.on('close', function() {
+      if (++closed === count) {
+        assert.equal(timedOut + completed, count);
+        cb();
+      }
+    });
+  }
+}
+
+// The handshakes wait for the pbkdf2() until they time out.
+function queued(cb) {
+  var pending = 2;
+  crypto.pbkdf2('password', 'salt', 1000000, 16, function(err) {
+    assert.ifError(err);
+    if (--pending === 0)
+      cb();
+  });
+  connect(16, function() {
+    assert.equal(timedOut, 16);
+    if (--pending === 0)
+      cb();
+  });
+}
+
+// The handshakes take turns, some time out while another one runs.
+function running(cb) {
+  connect(64, cb);
+}
+
+server.listen(common.PORT, function next() {
+  var round = rounds.shift();
+  if (round)
+    round(next);
+  else
+    server.close();
+});
+
+process.on('exit', function() {
+  assert.equal(rounds.length, 0);
+});
@@ -0,0 +1,139 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+if (!process.features.tls_sni) {
+  console.error('Skipping because node compiled without OpenSSL or ' +
+                'with old OpenSSL version.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var net = require('net');
+var tls = require('tls');
+
+function loadPEM(n) {
+  return fs.readFileSync(common.fixturesDir + '/keys/' + n + '.pem');
+}
+
+var CONNECTIONS = 50;
+var message = new Buffer(64 * 1024);
+message.fill('x');
+
+var sniContext = tls.createSecureContext({
+  key: loadPEM('agent1-key'),
+  cert: loadPEM('agent1-cert')
+});
+
+var options = {
+  key: loadPEM('agent2-key'),
+  cert: loadPEM('agent2-cert'),
+  offloadHandshake: true,
+  SNICallback: function(servername, callback) {
+    if (servername === 'async.example.com')
+      setTimeout(callback, 10, null, sniContext);
+    else if (servername === 'sync.example.com')
+      callback(null, sniContext);
+    else
+      callback(null, null);
+  }
+};
+
+// The handshakes run in the CPU class of the thread pool, not in the one
+// that file system requests use.
+var threadpool = process.threadpoolUsage();
+
+var servernames = [undefined, 'sync.example.com', 'async.example.com'];
+var echoed = 0;
+var clientErrors = 0;
+var serverNames = {};
+
+var server = tls.createServer(options, function(socket) {
+  var name = socket.servername || 'none';
+  serverNames[name] = (serverNames[name] || 0) + 1;
+  socket.pipe(socket);
+});
+
+server.on('clientError', function(err) {
+  clientErrors++;
+});
+
+server.listen(common.PORT, function() {
+  var pending = CONNECTIONS;
+  for (var i = 0; i < CONNECTIONS; i++)
+    connect(servernames[i % servernames.length], function() {
+      if (--pending === 0)
+        garbage();
+    });
+});
+
+function connect(servername, cb) {
+  var client = tls.connect({
+    port: common.PORT,
+    servername: servername,
+    rejectUnauthorized: false
+  }, function() {
+    var expected = servername ? 'agent1' : 'agent2';
+    assert.equal(client.getPeerCertificate().subject.CN, expected);
+  });
+
+  // Written before the handshake completes, the data is flushed together
+  // with the client's Finished message.
+  client.write(message);
+
+  var received = 0;
+  client.on('data', function(data) {
+    received += data.length;
+    if (received === message.length)
+      client.end();
+  });
+  client.on('close', function() {
+    assert.equal(received, message.length);
+    echoed++;
+    cb();
+  });
+}
+
+// A peer that isn't speaking TLS must fail the handshake on the threadpool
+// and be reported as a clientError.
+function garbage() {
+  var socket = net.connect(common.PORT, function() {
+    socket.write(new Array(1024).join('not a client hello\n'));
+  });
+  socket.on('error', function() {});
+  socket.on('close', function() {
+    server.close();
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(echoed, CONNECTIONS);
+  assert.equal(clientErrors, 1);
+  assert.equal(serverNames['none'], 17);
+  assert.equal(serverNames['sync.example.com'], 17);
+  assert.equal(serverNames['async.example.com'], 16);
+
+  var usage = process.threadpoolUsage();
+  assert(usage.cpu.completed - threadpool.cpu.completed >= CONNECTIONS);
+  assert.equal(usage.fastIO.submitted, threadpool.fastIO.submitted);
+});
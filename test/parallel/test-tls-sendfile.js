@@ -0,0 +1,75 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var tls = require('tls');
+var path = require('path');
+
+// TLS can't use sendfile(2), socket.sendFile() should fall back to reading
+// the file and writing it out through the TLS layer. The offsets line up
+// with the three byte characters in the fixture, the client decodes UTF-8.
+var filename = path.join(common.fixturesDir, 'elipses.txt');
+var contents = fs.readFileSync(filename);
+var fd = fs.openSync(filename, 'r');
+var callbacks = 0;
+
+var options = {
+  key: fs.readFileSync(path.join(common.fixturesDir, 'keys/agent1-key.pem')),
+  cert: fs.readFileSync(path.join(common.fixturesDir, 'keys/agent1-cert.pem'))
+};
+
+var server = tls.createServer(options, function(socket) {
+  socket.write('head');
+  socket.sendFile(fd, 9, contents.length - 18, function(err) {
+    assert.ifError(err);
+    callbacks++;
+  });
+  socket.end('tail');
+});
+
+server.listen(common.PORT, function() {
+  var received = '';
+  var conn = tls.connect({
+    port: common.PORT,
+    rejectUnauthorized: false
+  });
+  conn.setEncoding('utf8');
+  conn.on('data', function(chunk) {
+    received += chunk;
+  });
+  conn.on('end', function() {
+    var slice = contents.slice(9, contents.length - 9).toString();
+    assert.equal(received, 'head' + slice + 'tail');
+    server.close();
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(callbacks, 1);
+  fs.closeSync(fd);
+});
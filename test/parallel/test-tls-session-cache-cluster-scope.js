@@ -0,0 +1,116 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+if (process.platform === 'win32') {
+  console.error('Skipping, no shared session cache on Windows.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var cluster = require('cluster');
+var constants = require('constants');
+var tls = require('tls');
+var fs = require('fs');
+var join = require('path').join;
+
+// All servers have the same default sessionIdContext. A session must still
+// only be resumed by a server with the same certificate and the same client
+// certificate settings.
+
+function loadPEM(n) {
+  return fs.readFileSync(join(common.fixturesDir, 'keys', n + '.pem'));
+}
+
+var servers = [
+  { key: loadPEM('agent1-key'), cert: loadPEM('agent1-cert') },
+  { key: loadPEM('agent2-key'), cert: loadPEM('agent2-cert') },
+  { key: loadPEM('agent1-key'), cert: loadPEM('agent1-cert'),
+    ca: [loadPEM('ca1-cert')], requestCert: true, rejectUnauthorized: false }
+];
+
+if (cluster.isMaster) {
+  cluster.setupMaster({ tlsSessionCacheSize: 64 });
+
+  var results = [];
+
+  function connect(i, session, cb) {
+    var c = tls.connect(common.PORT + i, {
+      session: session,
+      rejectUnauthorized: false
+    }, function() {
+      var session = c.getSession();
+      results.push([i, c.isSessionReused()]);
+      c.end();
+      c.on('close', function() {
+        cb(session);
+      });
+    });
+  }
+
+  var worker = cluster.fork();
+  worker.on('message', function(msg) {
+    assert.equal(msg, 'listening');
+    connect(0, null, function(session) {
+      connect(0, session, function() {
+        connect(1, session, function() {
+          connect(2, session, function() {
+            worker.send('die');
+          });
+        });
+      });
+    });
+  });
+
+  process.on('exit', function() {
+    assert.deepEqual(results, [
+      [0, false],
+      [0, true],
+      [1, false],
+      [2, false]
+    ]);
+  });
+  return;
+}
+
+var listening = 0;
+servers = servers.map(function(options, i) {
+  options.secureOptions = constants.SSL_OP_NO_TICKET;
+  var server = tls.createServer(options, function(c) {
+    c.end();
+  });
+  server.listen(common.PORT + i, function() {
+    if (++listening === servers.length)
+      process.send('listening');
+  });
+  return server;
+});
+
+process.on('message', function(msg) {
+  if (msg === 'die')
+    process.exit();
+});
@@ -0,0 +1,124 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+if (process.platform === 'win32') {
+  console.error('Skipping, no shared session cache on Windows.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var cluster = require('cluster');
+var constants = require('constants');
+var tls = require('tls');
+var fs = require('fs');
+var join = require('path').join;
+
+// Without tickets the session can only be resumed from the session cache,
+// and with round-robin scheduling the next connection goes to another worker.
+cluster.schedulingPolicy = cluster.SCHED_RR;
+
+var workerCount = 4;
+var expectedReqCount = 16;
+
+if (cluster.isMaster) {
+  cluster.setupMaster({ tlsSessionCacheSize: 64 });
+
+  var reusedCount = 0;
+  var resultCount = 0;
+  var reqCount = 0;
+  var lastSession = null;
+
+  function shoot() {
+    var c = tls.connect(common.PORT, {
+      session: lastSession,
+      rejectUnauthorized: false
+    }, function() {
+      lastSession = c.getSession();
+      c.end();
+    });
+
+    c.on('close', function() {
+      if (++reqCount < expectedReqCount)
+        shoot();
+      else
+        maybeDone();
+    });
+  }
+
+  function maybeDone() {
+    if (reqCount < expectedReqCount || resultCount < expectedReqCount)
+      return;
+    Object.keys(cluster.workers).forEach(function(id) {
+      cluster.workers[id].send('die');
+    });
+  }
+
+  var listening = 0;
+  for (var i = 0; i < workerCount; i++) {
+    cluster.fork().on('message', function(msg) {
+      if (msg === 'listening') {
+        if (++listening === workerCount)
+          shoot();
+        return;
+      }
+      if (msg === 'reused')
+        ++reusedCount;
+      ++resultCount;
+      maybeDone();
+    });
+  }
+
+  process.on('exit', function() {
+    assert.equal(reqCount, expectedReqCount);
+    assert.equal(reusedCount + 1, reqCount);
+  });
+  return;
+}
+
+var options = {
+  key: fs.readFileSync(join(common.fixturesDir, 'agent.key')),
+  cert: fs.readFileSync(join(common.fixturesDir, 'agent.crt')),
+  secureOptions: constants.SSL_OP_NO_TICKET
+};
+
+var server = tls.createServer(options, function(c) {
+  process.send(c.isSessionReused() ? 'reused' : 'not-reused');
+  c.end();
+});
+
+server.listen(common.PORT, function() {
+  process.send('listening');
+});
+
+process.on('message', function(msg) {
+  if (msg === 'die') {
+    server.close(function() {
+      process.exit();
+    });
+  }
+});
@@ -0,0 +1,47 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+if (process.platform === 'win32') {
+  console.error('Skipping, no shared session cache on Windows.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var binding = process.binding('crypto');
+
+// Only the first session cache that is opened is used, opening another one
+// or one that can't be mapped must not report success.
+
+assert.strictEqual(binding.openSessionCache(-1), false);
+
+var fd = binding.createSessionCache(64);
+assert(fd >= 0);
+assert.strictEqual(binding.openSessionCache(fd), true);
+
+fd = binding.createSessionCache(64);
+assert(fd >= 0);
+assert.strictEqual(binding.openSessionCache(fd), false);